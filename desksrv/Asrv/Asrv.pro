@@ -1,4 +1,4 @@
-greaterThan(QT_MAJOR_VERSION, 4): QT += core network websockets gui widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += core network websockets gui widgets concurrent
 
 include($$PWD/../mainconfig.pri)
 
@@ -27,7 +27,29 @@ SOURCES += main.cpp \
     Server.cpp \
     widget/NotifyPopup.cpp \
     ScreenServer.cpp \
-    x11tool.cpp
+    x11tool.cpp \
+    HttpParser.cpp \
+    HttpConnection.cpp \
+    MultipartUploadWriter.cpp \
+    FileSender.cpp \
+    StaticCache.cpp \
+    HtmlTemplate.cpp \
+    DirListing.cpp \
+    DirListStreamer.cpp \
+    IoThreadPool.cpp \
+    WorkerPool.cpp \
+    RouteTable.cpp \
+    RtcBroadcaster.cpp \
+    StreamCongestion.cpp \
+    TileDiff.cpp \
+    FrameHistory.cpp \
+    ScreenProtocol.cpp \
+    VideoEncoder.cpp \
+    InputInjector.cpp \
+    ScreenPipeline.cpp \
+    JpegEncoder.cpp \
+    CursorTracker.cpp \
+    TerminalSession.cpp
 
 HEADERS += \
     tool.h \
@@ -39,9 +61,48 @@ HEADERS += \
     widget/NotifyPopup.h \
     ScreenServer.h \
     x11tool.h \
-    ClientInfo.h
+    ClientInfo.h \
+    HttpParser.h \
+    HttpConnection.h \
+    MultipartUploadWriter.h \
+    FileSender.h \
+    StaticCache.h \
+    HtmlTemplate.h \
+    DirListing.h \
+    DirListStreamer.h \
+    IoThreadPool.h \
+    WorkerPool.h \
+    RouteTable.h \
+    RtcBroadcaster.h \
+    StreamCongestion.h \
+    TileDiff.h \
+    FrameHistory.h \
+    ScreenProtocol.h \
+    VideoEncoder.h \
+    InputInjector.h \
+    ScreenPipeline.h \
+    JpegEncoder.h \
+    CursorTracker.h \
+    TerminalSession.h
 
-LIBS += -lutil
+LIBS += -lutil -lz
+# 输入注入线程直接调用 XTest，光标叠加层使用 XFixes；无锁队列在仓库根目录的 lib/common 下
+LIBS += -lX11 -lXtst -lXfixes
+INCLUDEPATH += $$PWD/../../lib
+
+# brotli 可选：存在 libbrotlienc 时为www资源额外生成 br 压缩版本
+packagesExist(libbrotlienc) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libbrotlienc
+    DEFINES += HAVE_BROTLI
+}
+
+# libjpeg-turbo 可选：存在时屏幕推流和截图页面用 turbojpeg 编码，否则退回 QImage::save
+packagesExist(libturbojpeg) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libturbojpeg
+    DEFINES += HAVE_TURBOJPEG
+}
 
 DISTFILES += \
     www/css/style.css\
@@ -1,8 +1,11 @@
 #ifndef CLIENTINFO_H
 #define CLIENTINFO_H
 #include <QWebSocket>
-#include <QPixmap>
 #include <QRect>
+
+#include "def.h"
+#include "StreamCongestion.h"
+class VideoEncoder;
 // 客户端信息结构体
 
 struct ClientInfo
@@ -22,9 +25,17 @@ struct ClientInfo
     bool isMetaPressed  = false;
 
     // ========== 新增：每个客户端独立的差分状态 ==========
-    QPixmap prevPixmap;            // 该客户端的上一帧截图（独立存储）
+    quint64 frameSeq      = 0;     // 该客户端画面对应的帧序号（截屏历史由所有客户端共用，0 表示还没有画面）
     QRect   diffRect;              // 该客户端的差分区域
     bool    isFirstFrame  = true;  // 该客户端是否是第一帧
-    int     diffThreshold = 10;    // 该客户端的像素差异阈值（可按需单独调整）
+    int     diffThreshold = 3;     // 该客户端的单通道像素差异阈值（可按需单独调整）
+    // 流水线中有该客户端的帧时不再提交新的请求：差分的起始帧必须是客户端当前显示的帧，
+    // 否则 S→N 之后再发 S→N+1，N 中变化又在 N+1 恢复的区域会一直停留在 N 的画面
+    bool frameInFlight = false;
+
+    // 拥塞控制：按该客户端的网络状况调整帧率、JPG质量和缩放比例
+    StreamCongestion congestion{SCREEN_MIN_INTERVAL};
+    // 视频流模式（H.264）的编码器，为空时按差分JPG推送
+    VideoEncoder *videoEncoder = nullptr;
 };
 #endif  // CLIENTINFO_H
@@ -0,0 +1,135 @@
+#include "CursorTracker.h"
+#include <QDebug>
+#include <QImage>
+
+#include "def.h"
+#include "ScreenProtocol.h"
+#include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
+
+CursorTracker::CursorTracker(QObject *parent): QThread(parent)
+{
+}
+
+CursorTracker::~CursorTracker()
+{
+    stop();
+    wait();
+}
+
+void CursorTracker::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled ? 1 : 0);
+}
+
+void CursorTracker::stop()
+{
+    m_stop.store(1);
+}
+
+// XFixes 的像素是预乘 alpha 的 ARGB（每个像素占一个 unsigned long），转换为非预乘的 RGBA 字节（页面 ImageData 格式）
+static QImage cursorSprite(const XFixesCursorImage *cursor)
+{
+    QImage sprite(cursor->width, cursor->height, QImage::Format_RGBA8888);
+    for (int y = 0; y < cursor->height; ++y)
+    {
+        uchar *line = sprite.scanLine(y);
+        for (int x = 0; x < cursor->width; ++x)
+        {
+            quint32 argb = static_cast<quint32>(cursor->pixels[y * cursor->width + x]);
+            uint    a    = argb >> 24;
+            uint    r    = (argb >> 16) & 0xff;
+            uint    g    = (argb >> 8) & 0xff;
+            uint    b    = argb & 0xff;
+            if (a > 0 && a < 255)
+            {
+                r = qMin(255u, r * 255 / a);
+                g = qMin(255u, g * 255 / a);
+                b = qMin(255u, b * 255 / a);
+            }
+            line[x * 4]     = static_cast<uchar>(r);
+            line[x * 4 + 1] = static_cast<uchar>(g);
+            line[x * 4 + 2] = static_cast<uchar>(b);
+            line[x * 4 + 3] = static_cast<uchar>(a);
+        }
+    }
+    return sprite;
+}
+
+void CursorTracker::run()
+{
+    // Xlib 连接不能跨线程共用，使用自己的连接
+    Display *display = XOpenDisplay(nullptr);
+    if (!display)
+    {
+        qWarning() << "CursorTracker: failed to open X display, cursor overlay disabled";
+        return;
+    }
+    int eventBase = 0, errorBase = 0;
+    if (!XFixesQueryExtension(display, &eventBase, &errorBase))
+    {
+        qWarning() << "CursorTracker: XFixes extension not available, cursor overlay disabled";
+        XCloseDisplay(display);
+        return;
+    }
+    Window root = DefaultRootWindow(display);
+    XFixesSelectCursorInput(display, root, XFixesDisplayCursorNotifyMask);
+
+    bool needSprite = true;
+    int  lastX = -1, lastY = -1;
+    while (m_stop.load() == 0)
+    {
+        QThread::msleep(CURSOR_POLL_INTERVAL);
+        // 光标形状变化通知（暂停期间的通知也要取出，避免堆积）
+        while (XPending(display) > 0)
+        {
+            XEvent event;
+            XNextEvent(display, &event);
+            if (event.type == eventBase + XFixesCursorNotify)
+            {
+                needSprite = true;
+            }
+        }
+        if (m_enabled.load() == 0)
+        {
+            needSprite = true;
+            lastX = lastY = -1;
+            continue;
+        }
+
+        if (needSprite)
+        {
+            needSprite                = false;
+            XFixesCursorImage *cursor = XFixesGetCursorImage(display);
+            if (cursor)
+            {
+                CursorInfo info;
+                info.x      = cursor->x;
+                info.y      = cursor->y;
+                info.hotX   = cursor->xhot;
+                info.hotY   = cursor->yhot;
+                info.serial = static_cast<quint32>(cursor->cursor_serial);
+                emit spriteChanged(encodeCursorMessage(info, cursorSprite(cursor)));
+                lastX = cursor->x;
+                lastY = cursor->y;
+                XFree(cursor);
+                continue;
+            }
+        }
+
+        Window       rootReturn, childReturn;
+        int          rootX, rootY, winX, winY;
+        unsigned int mask;
+        if (XQueryPointer(display, root, &rootReturn, &childReturn, &rootX, &rootY, &winX, &winY, &mask) &&
+            (rootX != lastX || rootY != lastY))
+        {
+            lastX = rootX;
+            lastY = rootY;
+            CursorInfo info;
+            info.x = rootX;
+            info.y = rootY;
+            emit positionChanged(encodeCursorMessage(info, QImage()));
+        }
+    }
+    XCloseDisplay(display);
+}
@@ -0,0 +1,36 @@
+#ifndef CURSORTRACKER_H
+#define CURSORTRACKER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QThread>
+
+// 鼠标光标跟踪线程（XFixes）
+// 截屏不包含光标，光标作为单独的叠加层发送给页面：图标只在形状变化时（XFixesCursorNotify）
+// 通过 XFixesGetCursorImage 取一次，之后只发送位置；光标移动不会让屏幕分块失效，画面降帧时光标也保持流畅
+class CursorTracker : public QThread
+{
+    Q_OBJECT
+public:
+    explicit CursorTracker(QObject *parent = nullptr);
+    ~CursorTracker() override;
+
+    // 没有客户端时暂停轮询，恢复时重新获取图标
+    void setEnabled(bool enabled);
+    void stop();
+
+signals:
+    // 光标图标变化（消息已按 ScreenProtocol.h 的光标格式打包，带当前位置）
+    void spriteChanged(const QByteArray &message);
+    // 光标移动（只有位置的光标消息）
+    void positionChanged(const QByteArray &message);
+
+protected:
+    void run() override;
+
+private:
+    QAtomicInt m_enabled;
+    QAtomicInt m_stop;
+};
+
+#endif  // CURSORTRACKER_H
@@ -0,0 +1,104 @@
+#include "DirListStreamer.h"
+#include <QDebug>
+
+#include "def.h"
+#include "HttpConnection.h"
+#include "WorkerPool.h"
+
+void DirListStreamer::send(QTcpSocket             *socket,
+                           const QByteArray       &header,
+                           const QByteArray       &pageHead,
+                           const QByteArray       &pageTail,
+                           const DirIndexPtr      &index,
+                           const DirListRowWriter &writer)
+{
+    DirListStreamer *streamer = new DirListStreamer(socket, pageTail, index, writer);
+    qDebug() << "分批发送目录列表：" << writer.dirPath() << "，项数=" << index->entries.size();
+    socket->write(header);
+    streamer->writeChunk(pageHead);
+    streamer->pump();
+}
+
+DirListStreamer::DirListStreamer(QTcpSocket             *socket,
+                                 const QByteArray       &pageTail,
+                                 const DirIndexPtr      &index,
+                                 const DirListRowWriter &writer)
+    : QObject(socket), m_socket(socket), m_index(index), m_writer(writer), m_pageTail(pageTail)
+{
+    connect(m_socket, &QTcpSocket::bytesWritten, this, &DirListStreamer::onBytesWritten);
+}
+
+void DirListStreamer::onBytesWritten()
+{
+    pump();
+}
+
+void DirListStreamer::pump()
+{
+    if (m_rendering)
+    {
+        return;  // 上一批生成完成后会再次调用
+    }
+    const int total = m_index->entries.size();
+    if (m_next >= total)
+    {
+        finish();
+        return;
+    }
+    if (m_socket->bytesToWrite() >= DIR_LIST_STREAM_BUFFER)
+    {
+        return;  // 等 bytesWritten
+    }
+
+    int              begin  = m_next;
+    int              end    = qMin(m_next + DIR_LIST_STREAM_BATCH, total);
+    DirIndexPtr      index  = m_index;
+    DirListRowWriter writer = m_writer;
+    m_rendering             = true;
+    WorkerPool::run<QByteArray>(
+        this,
+        [index, writer, begin, end]() mutable {
+            QByteArray batch;
+            for (int i = begin; i < end; ++i)
+            {
+                writer.append(batch, index->entries.at(i));
+            }
+            return batch;
+        },
+        [this, end](const QByteArray &batch) {
+            m_rendering = false;
+            m_next      = end;
+            writeChunk(batch);
+            pump();
+        });
+}
+
+void DirListStreamer::writeChunk(const QByteArray &data)
+{
+    if (data.isEmpty())
+    {
+        return;  // 空块表示响应结束，不能用于普通数据
+    }
+    m_socket->write(QByteArray::number(data.size(), 16) + "\r\n");
+    m_socket->write(data);
+    m_socket->write("\r\n");
+}
+
+void DirListStreamer::finish()
+{
+    disconnect(m_socket, &QTcpSocket::bytesWritten, this, &DirListStreamer::onBytesWritten);
+    writeChunk(m_pageTail);
+    m_socket->write("0\r\n\r\n");
+    m_socket->flush();
+
+    QTcpSocket *socket = m_socket;
+    deleteLater();
+    if (HttpConnection *connection = HttpConnection::fromSocket(socket))
+    {
+        connection->finishResponse();
+    }
+    else
+    {
+        socket->disconnectFromHost();
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef DIRLISTSTREAMER_H
+#define DIRLISTSTREAMER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QTcpSocket>
+
+#include "DirListing.h"
+
+// 大目录列表页面发送器（挂在socket下，随socket一起释放）
+// 以 chunked 编码分批输出文件行：socket 写缓冲低于水位时才生成下一批，
+// 浏览器可以边收边渲染，服务端也不必一次生成整个页面
+// 每批文件行（逐项读取大小/修改时间）在工作线程生成，socket所在的I/O线程只负责写出
+class DirListStreamer : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief 异步发送目录列表页面，发送完成后结束当前响应
+     * @param header 已构建好的响应头（Transfer-Encoding: chunked）
+     * @param pageHead 页面中文件列表之前的部分
+     * @param pageTail 页面中文件列表之后的部分
+     * @param index 目录排序索引
+     * @param writer 目录行HTML生成器
+     */
+    static void send(QTcpSocket             *socket,
+                     const QByteArray       &header,
+                     const QByteArray       &pageHead,
+                     const QByteArray       &pageTail,
+                     const DirIndexPtr      &index,
+                     const DirListRowWriter &writer);
+
+private:
+    DirListStreamer(QTcpSocket             *socket,
+                    const QByteArray       &pageTail,
+                    const DirIndexPtr      &index,
+                    const DirListRowWriter &writer);
+    // 写缓冲低于水位时在工作线程生成下一批文件行，全部写完后结束响应
+    void pump();
+    void writeChunk(const QByteArray &data);
+    void finish();
+
+private slots:
+    void onBytesWritten();
+
+private:
+    QTcpSocket      *m_socket = nullptr;
+    DirIndexPtr      m_index;
+    DirListRowWriter m_writer;
+    QByteArray       m_pageTail;
+    int              m_next      = 0;      // 下一个待输出的目录项
+    bool             m_rendering = false;  // 工作线程正在生成一批文件行
+};
+
+#endif  // DIRLISTSTREAMER_H
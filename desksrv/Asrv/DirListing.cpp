@@ -0,0 +1,265 @@
+#include "DirListing.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "def.h"
+#include "HtmlTemplate.h"
+#include "unicode.h"
+
+// 文件行模板（只编译一次）
+static const HtmlTemplate &rowTemplate()
+{
+    static const HtmlTemplate tmpl(QByteArray(R"(
+                                <li class="file-item {{ITEM_CLASS}}" {{DATA_ATTR}}>
+                                <span class="{{ICON_CLASS}}-icon">{{ICON}}</span>
+                                <a href="{{URL}}">{{NAME}}</a>
+                                <span class="file-modify-time">{{MTIME}}</span>
+                                <span class="file-size">{{SIZE}}</span>
+                                {{DOWNLOAD}}
+                                </li>
+                                )"));
+    return tmpl;
+}
+
+// 修改时间格式：yyyy-MM-dd HH:mm:ss（直接格式化数字，避免每行 QDateTime::toString）
+static QByteArray formatModifyTime(const QDateTime &dateTime)
+{
+    QDate date = dateTime.date();
+    QTime time = dateTime.time();
+    char  buffer[32];
+    int   length = snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d", date.year(), date.month(),
+                            date.day(), time.hour(), time.minute(), time.second());
+    return QByteArray(buffer, length);
+}
+
+// ========== 目录索引 ==========
+
+// 排序规则与原 QDir::DirsFirst | QDir::Name | QDir::IgnoreCase 一致，忽略大小写相同时再按原文区分，保证游标唯一
+static bool dirEntryLess(bool aIsDir, const QString &aName, bool bIsDir, const QString &bName)
+{
+    if (aIsDir != bIsDir)
+    {
+        return aIsDir;
+    }
+    int result = QString::compare(aName, bName, Qt::CaseInsensitive);
+    if (result != 0)
+    {
+        return result < 0;
+    }
+    return aName < bName;
+}
+
+struct DirIndexCacheItem
+{
+    DirIndexPtr index;
+    quint64     lastUsed = 0;
+};
+
+static QMutex                            s_dirIndexMutex;
+static QHash<QString, DirIndexCacheItem> s_dirIndexCache;
+static quint64                           s_dirIndexTick = 0;
+
+static DirIndexPtr buildDirIndex(const QString &dirPath, qint64 dirMtime)
+{
+    QByteArray prefix = QFile::encodeName(dirPath);
+    DIR       *dir    = opendir(prefix.constData());
+    if (!dir)
+    {
+        return DirIndexPtr();
+    }
+    prefix += '/';
+
+    QSharedPointer<DirIndex> index(new DirIndex);
+    index->dirMtime = dirMtime;
+    while (struct dirent *item = readdir(dir))
+    {
+        const char *name = item->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+        {
+            continue;
+        }
+
+        DirEntry entry;
+        entry.name = QFile::decodeName(name);
+        // d_type 可直接判断类型；符号链接/未知类型才 stat（按链接目标判断，与 QFileInfo::isDir 一致）
+        if (item->d_type == DT_DIR)
+        {
+            entry.isDir = true;
+        }
+        else if (item->d_type == DT_UNKNOWN || item->d_type == DT_LNK)
+        {
+            struct stat st;
+            entry.isDir = (stat((prefix + name).constData(), &st) == 0 && S_ISDIR(st.st_mode));
+        }
+        index->entries.append(entry);
+    }
+    closedir(dir);
+
+    std::sort(index->entries.begin(), index->entries.end(), [](const DirEntry &a, const DirEntry &b) {
+        return dirEntryLess(a.isDir, a.name, b.isDir, b.name);
+    });
+    return index;
+}
+
+DirIndexPtr loadDirIndex(const QString &dirPath)
+{
+    QFileInfo dirInfo(dirPath);
+    if (!dirInfo.isDir())
+    {
+        return DirIndexPtr();
+    }
+    QString cacheKey = dirInfo.absoluteFilePath();
+    qint64  dirMtime = dirInfo.lastModified().toMSecsSinceEpoch();
+
+    {
+        QMutexLocker locker(&s_dirIndexMutex);
+        auto         it = s_dirIndexCache.find(cacheKey);
+        if (it != s_dirIndexCache.end() && it->index->dirMtime == dirMtime)
+        {
+            it->lastUsed = ++s_dirIndexTick;
+            return it->index;
+        }
+    }
+
+    // 读取目录时不持锁，大目录重建索引不阻塞其他目录的查询
+    DirIndexPtr index = buildDirIndex(cacheKey, dirMtime);
+    if (!index)
+    {
+        return index;
+    }
+
+    QMutexLocker locker(&s_dirIndexMutex);
+    if (!s_dirIndexCache.contains(cacheKey) && s_dirIndexCache.size() >= DIR_INDEX_CACHE_SIZE)
+    {
+        // 淘汰最久未使用的目录
+        auto oldest = s_dirIndexCache.begin();
+        for (auto it = s_dirIndexCache.begin(); it != s_dirIndexCache.end(); ++it)
+        {
+            if (it->lastUsed < oldest->lastUsed)
+            {
+                oldest = it;
+            }
+        }
+        s_dirIndexCache.erase(oldest);
+    }
+    DirIndexCacheItem &item = s_dirIndexCache[cacheKey];
+    item.index              = index;
+    item.lastUsed           = ++s_dirIndexTick;
+    return index;
+}
+
+int dirIndexUpperBound(const DirIndex &index, bool isDir, const QString &name)
+{
+    auto it = std::upper_bound(index.entries.begin(), index.entries.end(), 0, [&](int, const DirEntry &entry) {
+        return dirEntryLess(isDir, name, entry.isDir, entry.name);
+    });
+    return static_cast<int>(it - index.entries.begin());
+}
+
+QByteArray encodeDirCursor(const DirEntry &entry)
+{
+    QByteArray raw = (entry.isDir ? QByteArray("d:") : QByteArray("f:")) + entry.name.toUtf8();
+    return raw.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+}
+
+bool decodeDirCursor(const QByteArray &cursor, DirEntry &entry)
+{
+    QByteArray raw = QByteArray::fromBase64(cursor, QByteArray::Base64UrlEncoding);
+    if (raw.size() < 2 || raw.at(1) != ':' || (raw.at(0) != 'd' && raw.at(0) != 'f'))
+    {
+        return false;
+    }
+    entry.isDir = (raw.at(0) == 'd');
+    entry.name  = QString::fromUtf8(raw.mid(2));
+    return true;
+}
+
+// ========== 行HTML ==========
+
+DirListRowWriter::DirListRowWriter(const QString &dirPath, const QString &rootDir, const QString &requestPath)
+    : m_dirPath(dirPath), m_values(rowTemplate().variableCount())
+{
+    // 每行共用的部分只计算一次
+    m_urlPrefix = requestPath.toUtf8();
+    if (!m_urlPrefix.endsWith('/'))
+    {
+        m_urlPrefix += '/';
+    }
+    QString relativeDir = QDir(rootDir).relativeFilePath(QFileInfo(dirPath).absoluteFilePath());
+    m_filePathPrefix    = (relativeDir == "." || relativeDir.isEmpty()) ? QByteArray("/")
+                                                                         : "/" + relativeDir.toUtf8() + "/";
+}
+
+QByteArray DirListRowWriter::filePath(const QString &fileName) const
+{
+    return m_filePathPrefix + fileName.toUtf8();
+}
+
+void DirListRowWriter::append(QByteArray &out, const DirEntry &entry)
+{
+    QFileInfo fileInfo(m_dirPath + "/" + entry.name);
+    append(out, entry.name.toUtf8(), entry.isDir, fileInfo.size(), fileInfo.lastModified());
+}
+
+void DirListRowWriter::append(QByteArray       &out,
+                              const QByteArray &fileName,
+                              bool              isDir,
+                              qint64            size,
+                              const QDateTime  &modifyTime)
+{
+    static const HtmlTemplate &tmpl           = rowTemplate();
+    static const int           itemClassIndex = tmpl.variableIndex("ITEM_CLASS");
+    static const int           dataAttrIndex  = tmpl.variableIndex("DATA_ATTR");
+    static const int           iconClassIndex = tmpl.variableIndex("ICON_CLASS");
+    static const int           iconIndex      = tmpl.variableIndex("ICON");
+    static const int           urlIndex       = tmpl.variableIndex("URL");
+    static const int           nameIndex      = tmpl.variableIndex("NAME");
+    static const int           mtimeIndex     = tmpl.variableIndex("MTIME");
+    static const int           sizeIndex      = tmpl.variableIndex("SIZE");
+    static const int           downloadIndex  = tmpl.variableIndex("DOWNLOAD");
+
+    static const QByteArray dirItem("dir-item"), empty(""), dirClass("dir"), fileClass("file");
+    static const QByteArray dirIcon(DIR_ICON), fileIcon(FILE_ICON), dirSize("目录");
+
+    QByteArray filePath = m_filePathPrefix + fileName;
+
+    m_values[itemClassIndex] = isDir ? dirItem : empty;
+    m_values[dataAttrIndex]  = isDir ? empty : "data-file-path=\"" + filePath + "\"";
+    m_values[iconClassIndex] = isDir ? dirClass : fileClass;
+    m_values[iconIndex]      = isDir ? dirIcon : fileIcon;
+    m_values[urlIndex]       = m_urlPrefix + fileName;
+    m_values[nameIndex]      = fileName;
+    m_values[mtimeIndex]     = formatModifyTime(modifyTime);
+    m_values[sizeIndex]      = isDir ? dirSize : QByteArray::number(size / 1024) + " KB";
+    m_values[downloadIndex] =
+        isDir ? empty : R"(<button class="download-btn" data-file-path=")" + filePath + R"(">下载</button>)";
+    tmpl.renderTo(out, m_values);
+}
+
+QByteArray dirListParentRow(const QString &requestPath)
+{
+    QString parentRequestPath = requestPath.endsWith("/") ? requestPath.left(requestPath.length() - 1) : requestPath;
+    parentRequestPath =
+        parentRequestPath.lastIndexOf("/") > 0 ? parentRequestPath.left(parentRequestPath.lastIndexOf("/")) : "/";
+
+    QByteArray row = R"(
+                                <li class="file-item" >
+                                <span class="dir-icon">)";
+    row += DIR_ICON;
+    row += R"(</span>
+                                <a href=")";
+    row += parentRequestPath.toUtf8();
+    row += R"(">../ (上级目录)</a>
+                                </li>
+                                )";
+    return row;
+}
@@ -0,0 +1,74 @@
+#ifndef DIRLISTING_H
+#define DIRLISTING_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+// 目录索引中的一项（只保存排序需要的信息，大小/修改时间在输出时再读取）
+struct DirEntry
+{
+    QString name;
+    bool    isDir = false;
+};
+
+// 目录的排序索引（目录在前，按名称忽略大小写排序）
+// 按目录路径缓存，目录 mtime 变化（增删改名）时重建
+struct DirIndex
+{
+    qint64            dirMtime = 0;  // 建立索引时目录的修改时间（毫秒）
+    QVector<DirEntry> entries;
+};
+using DirIndexPtr = QSharedPointer<const DirIndex>;
+
+/**
+ * @brief 获取目录的排序索引（线程安全）
+ * 目录未变化时直接返回缓存；否则用 readdir 重新读取（不逐个 stat）并排序
+ * @return 目录不存在或无法读取时返回空指针
+ */
+DirIndexPtr loadDirIndex(const QString &dirPath);
+
+// 第一个排在 (isDir, name) 之后的索引位置（用于游标分页）
+int dirIndexUpperBound(const DirIndex &index, bool isDir, const QString &name);
+
+// 分页游标：编码/解码上一页最后一项
+QByteArray encodeDirCursor(const DirEntry &entry);
+bool       decodeDirCursor(const QByteArray &cursor, DirEntry &entry);
+
+// 目录列表行HTML生成器：行模板只编译一次，每行按字节追加，不经过 QString::arg
+class DirListRowWriter
+{
+public:
+    /**
+     * @param dirPath 目录的服务端路径
+     * @param rootDir 映射根目录
+     * @param requestPath HTTP请求路径
+     */
+    DirListRowWriter(const QString &dirPath, const QString &rootDir, const QString &requestPath);
+
+    // 索引项：输出时才读取大小和修改时间
+    void append(QByteArray &out, const DirEntry &entry);
+
+    // 文件相对映射根目录的路径（下载/预览使用）
+    QByteArray filePath(const QString &fileName) const;
+    const QString &dirPath() const
+    {
+        return m_dirPath;
+    }
+
+private:
+    void append(QByteArray &out, const QByteArray &fileName, bool isDir, qint64 size, const QDateTime &modifyTime);
+
+private:
+    QString             m_dirPath;
+    QByteArray          m_urlPrefix;       // 请求路径 + "/"
+    QByteArray          m_filePathPrefix;  // 相对映射根目录的路径 + "/"
+    QVector<QByteArray> m_values;          // 复用的变量值数组
+};
+
+// 上级目录行HTML
+QByteArray dirListParentRow(const QString &requestPath);
+
+#endif  // DIRLISTING_H
@@ -0,0 +1,245 @@
+#include "FileSender.h"
+#include <QDebug>
+#include <QTimer>
+#include <cerrno>
+#include <cstring>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "def.h"
+#include "HttpConnection.h"
+
+bool FileSender::send(QTcpSocket       *socket,
+                      const QByteArray &header,
+                      const QString    &filePath,
+                      qint64            offset,
+                      qint64            length)
+{
+    Segment segment;
+    segment.offset = offset;
+    segment.length = length;
+    return send(socket, header, filePath, QVector<Segment>() << segment);
+}
+
+bool FileSender::send(QTcpSocket             *socket,
+                      const QByteArray       &header,
+                      const QString          &filePath,
+                      const QVector<Segment> &segments)
+{
+    FileSender *sender = new FileSender(socket, header, segments);
+    sender->m_file.setFileName(filePath);
+    // 不使用 QFile 的缓冲，读取直接走文件描述符
+    if (!sender->m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+    {
+        qWarning() << "无法打开文件：" << filePath << "，错误：" << sender->m_file.errorString();
+        delete sender;
+        return false;
+    }
+    qDebug() << "开始发送文件：" << filePath << "，段数=" << segments.size();
+    sender->start();
+    return true;
+}
+
+FileSender::FileSender(QTcpSocket *socket, const QByteArray &header, const QVector<Segment> &segments)
+    : QObject(socket), m_socket(socket), m_pending(header), m_segments(segments)
+{
+}
+
+void FileSender::start()
+{
+    connect(m_socket, &QTcpSocket::bytesWritten, this, &FileSender::onBytesWritten);
+    // 之后的数据直接写文件描述符，必须等 QTcpSocket 自己的写缓冲全部写出，否则会乱序
+    if (m_socket->bytesToWrite() > 0)
+    {
+        m_socket->flush();
+        return;
+    }
+    pump();
+}
+
+void FileSender::onBytesWritten()
+{
+    // QTcpSocket 缓冲中的数据全部写出后才能继续直接写描述符
+    if (m_socket->bytesToWrite() > 0)
+    {
+        return;
+    }
+    pump();
+}
+
+void FileSender::pump()
+{
+    const int fd = static_cast<int>(m_socket->socketDescriptor());
+
+    for (int round = 0; round < FILE_SEND_CHUNKS_PER_ROUND; ++round)
+    {
+        // 1. 先写完用户态数据（响应头 / 回退模式下读出的文件块）
+        if (m_pendingPos < m_pending.size())
+        {
+            // 后面还有数据时带 MSG_MORE，让响应头和第一块文件内容合并成满包
+            bool    more  = m_remaining > 0 || m_segmentIndex < m_segments.size();
+            int     flags = MSG_NOSIGNAL | (more ? MSG_MORE : 0);
+            ssize_t n     = ::send(fd, m_pending.constData() + m_pendingPos, m_pending.size() - m_pendingPos, flags);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    waitWritable();
+                    return;
+                }
+                abort(QString("发送失败：%1").arg(strerror(errno)));
+                return;
+            }
+            m_pendingPos += static_cast<int>(n);
+            continue;
+        }
+
+        if (m_remaining == 0)
+        {
+            if (!nextSegment())
+            {
+                finish();
+                return;
+            }
+            continue;
+        }
+
+        // 2. sendfile：内核直接从页缓存发往socket，不经过用户态
+        if (m_useSendfile)
+        {
+            off_t   offset = static_cast<off_t>(m_offset);
+            ssize_t n      = ::sendfile(fd, m_file.handle(), &offset, qMin<qint64>(m_remaining, FILE_SEND_CHUNK_SIZE));
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    waitWritable();
+                    return;
+                }
+                if (errno == EINVAL || errno == ENOSYS)
+                {
+                    // 文件系统不支持 sendfile，改为块读写
+                    qDebug() << "sendfile不可用，改为块读写：" << m_file.fileName();
+                    m_useSendfile = false;
+                    continue;
+                }
+                abort(QString("sendfile失败：%1").arg(strerror(errno)));
+                return;
+            }
+            if (n == 0)
+            {
+                abort("文件在发送过程中被截断");
+                return;
+            }
+            m_offset += n;
+            m_remaining -= n;
+            continue;
+        }
+
+        // 3. 回退模式：读一块到复用的缓冲区，下一轮写出
+        if (!readChunk())
+        {
+            return;
+        }
+    }
+
+    // 达到本轮上限，让出事件循环给其他连接后继续
+    QTimer::singleShot(0, this, &FileSender::pump);
+}
+
+bool FileSender::readChunk()
+{
+    int size = static_cast<int>(qMin<qint64>(m_remaining, FILE_SEND_CHUNK_SIZE));
+    m_pending.resize(size);
+    ssize_t n = ::pread(m_file.handle(), m_pending.data(), size, static_cast<off_t>(m_offset));
+    while (n < 0 && errno == EINTR)
+    {
+        n = ::pread(m_file.handle(), m_pending.data(), size, static_cast<off_t>(m_offset));
+    }
+    if (n <= 0)
+    {
+        abort(n == 0 ? QString("文件在发送过程中被截断") : QString("读取文件失败：%1").arg(strerror(errno)));
+        return false;
+    }
+    m_pending.resize(static_cast<int>(n));
+    m_pendingPos = 0;
+    m_offset += n;
+    m_remaining -= n;
+    return true;
+}
+
+bool FileSender::nextSegment()
+{
+    if (m_segmentIndex >= m_segments.size())
+    {
+        return false;
+    }
+    const Segment &segment = m_segments.at(m_segmentIndex++);
+    m_pending              = segment.prefix;
+    m_pendingPos           = 0;
+    m_offset               = segment.offset;
+    m_remaining            = segment.length;
+    return true;
+}
+
+void FileSender::waitWritable()
+{
+    // 用户态数据（响应头/段前缀/回退模式的文件块）剩余部分整体交给 QTcpSocket
+    if (m_pendingPos < m_pending.size())
+    {
+        m_socket->write(m_pending.constData() + m_pendingPos, m_pending.size() - m_pendingPos);
+        m_pendingPos = m_pending.size();
+        return;
+    }
+    // sendfile 写满：读出少量文件内容交给 QTcpSocket，由它的可写通知唤醒
+    QByteArray piece(static_cast<int>(qMin<qint64>(m_remaining, FILE_SEND_WAKEUP_SIZE)), Qt::Uninitialized);
+    ssize_t    n = ::pread(m_file.handle(), piece.data(), piece.size(), static_cast<off_t>(m_offset));
+    while (n < 0 && errno == EINTR)
+    {
+        n = ::pread(m_file.handle(), piece.data(), piece.size(), static_cast<off_t>(m_offset));
+    }
+    if (n <= 0)
+    {
+        abort(n == 0 ? QString("文件在发送过程中被截断") : QString("读取文件失败：%1").arg(strerror(errno)));
+        return;
+    }
+    m_offset += n;
+    m_remaining -= n;
+    m_socket->write(piece.constData(), n);
+}
+
+void FileSender::finish()
+{
+    disconnect(m_socket, &QTcpSocket::bytesWritten, this, &FileSender::onBytesWritten);
+    m_file.close();
+
+    HttpConnection *connection = HttpConnection::fromSocket(m_socket);
+    if (connection)
+    {
+        connection->finishResponse();
+    }
+    else
+    {
+        m_socket->disconnectFromHost();
+    }
+    deleteLater();
+}
+
+void FileSender::abort(const QString &reason)
+{
+    // 响应体已发出一部分，无法再发送错误响应，只能断开连接
+    qWarning() << "文件发送中断：" << m_file.fileName() << reason;
+    disconnect(m_socket, &QTcpSocket::bytesWritten, this, &FileSender::onBytesWritten);
+    m_file.close();
+    m_socket->abort();
+    deleteLater();
+}
@@ -0,0 +1,74 @@
+#ifndef FILESENDER_H
+#define FILESENDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QObject>
+#include <QTcpSocket>
+#include <QVector>
+
+// 文件下载发送器（挂在socket下，随socket一起释放）
+// 响应头写完后，文件内容用 sendfile(2) 从文件描述符直接发到socket，不经过用户态缓冲；
+// 不支持 sendfile 时退化为固定大小的块读写。socket 写满时等待可写再继续，内存占用与文件大小无关
+// 可写通知复用 QTcpSocket 自己的：写满时把少量数据交给 QTcpSocket 发送，它发完（bytesWritten）后继续，
+// 不在同一个描述符上再创建 QSocketNotifier（Qt5 的 UNIX 事件分发器不支持同一 socket 多个同类通知）
+class FileSender : public QObject
+{
+    Q_OBJECT
+public:
+    // 响应体的一段：先发送 prefix，再发送文件 [offset, offset + length)
+    struct Segment
+    {
+        QByteArray prefix;
+        qint64     offset = 0;
+        qint64     length = 0;
+    };
+
+    /**
+     * @brief 异步发送文件响应，发送完成后结束当前响应
+     * @param header 已构建好的响应头
+     * @param offset 文件起始偏移
+     * @param length 发送字节数
+     * @return 文件打开失败返回 false（此时未写入任何数据，调用方可改发错误响应）
+     */
+    static bool send(QTcpSocket       *socket,
+                     const QByteArray &header,
+                     const QString    &filePath,
+                     qint64            offset,
+                     qint64            length);
+    // 多段发送（multipart/byteranges 等），各段按顺序写出
+    static bool send(QTcpSocket             *socket,
+                     const QByteArray       &header,
+                     const QString          &filePath,
+                     const QVector<Segment> &segments);
+
+private:
+    FileSender(QTcpSocket *socket, const QByteArray &header, const QVector<Segment> &segments);
+    void start();
+    // 尽量多地写出数据，直到写完、socket写满或达到本轮上限
+    void pump();
+    // 读取下一块文件内容到 m_pending（sendfile 不可用时）
+    bool readChunk();
+    // 切换到下一段，没有更多段时返回 false
+    bool nextSegment();
+    // socket 写满：把少量待发送数据交给 QTcpSocket，等它的 bytesWritten 再继续
+    void waitWritable();
+    void finish();
+    void abort(const QString &reason);
+
+private slots:
+    void onBytesWritten();
+
+private:
+    QTcpSocket      *m_socket       = nullptr;
+    QFile            m_file;
+    QByteArray       m_pending;                 // 待发送的用户态数据（响应头 / 段前缀 / 回退模式下的文件块）
+    int              m_pendingPos   = 0;
+    QVector<Segment> m_segments;
+    int              m_segmentIndex = 0;        // 下一个待开始的段
+    qint64           m_offset       = 0;        // 下一个待发送的文件偏移
+    qint64           m_remaining    = 0;        // 当前段剩余待发送的文件字节数
+    bool             m_useSendfile  = true;
+};
+
+#endif  // FILESENDER_H
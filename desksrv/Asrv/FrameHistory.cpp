@@ -0,0 +1,104 @@
+#include "FrameHistory.h"
+#include "def.h"
+#include "JpegEncoder.h"
+#include "TileDiff.h"
+
+quint64 FrameHistory::push(const QImage &frame)
+{
+    m_frames.insert(++m_latestSeq, frame);
+    // 客户端引用的帧过多时淘汰最早的帧（对应的客户端下次收到整帧，相关差分缓存在 retain 时清理）
+    while (m_frames.size() > SCREEN_FRAME_HISTORY)
+    {
+        m_frames.erase(m_frames.begin());
+    }
+    return m_latestSeq;
+}
+
+FramePatches FrameHistory::patches(quint64 fromSeq, quint64 toSeq, int tolerance, int quality, int scalePercent)
+{
+    FramePatches result;
+    auto         toIt = m_frames.constFind(toSeq);
+    if (toIt == m_frames.constEnd())
+    {
+        return result;
+    }
+    const QImage &curr = toIt.value();
+
+    // 1. 差分（同一对帧只计算一次）
+    auto    fromIt = m_frames.constFind(fromSeq);
+    bool    isFull = (fromIt == m_frames.constEnd() || fromIt.value().size() != curr.size());
+    DiffKey key{isFull ? 0 : fromSeq, toSeq, isFull ? 0 : tolerance};
+    auto    it     = m_diffs.find(key);
+    if (it == m_diffs.end())
+    {
+        DiffEntry entry;
+        entry.rects = isFull ? QVector<QRect>{curr.rect()}
+                             : diffTiles(fromIt.value(), curr, tolerance, SCREEN_MAX_PATCHES);
+        it          = m_diffs.insert(key, entry);
+    }
+    result.rects  = it->rects;
+    result.isFull = (result.rects.size() == 1 && result.rects.first() == curr.rect());
+    if (result.rects.isEmpty())
+    {
+        return result;
+    }
+
+    // 2. 编码（同一差分、质量和缩放只编码一次）
+    int  encodeKey = quality * 1000 + scalePercent;
+    auto encodedIt = it->encoded.find(encodeKey);
+    if (encodedIt == it->encoded.end())
+    {
+        QVector<QByteArray> jpegs;
+        JpegEncoder        *encoder = JpegEncoder::forCurrentThread();
+        for (const QRect &rect : result.rects)
+        {
+            if (scalePercent < 100)
+            {
+                QImage patchImage = curr.copy(rect).scaled(qMax(1, rect.width() * scalePercent / 100),
+                                                           qMax(1, rect.height() * scalePercent / 100),
+                                                           Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+                jpegs.append(encoder->encode(patchImage, quality));
+            }
+            else
+            {
+                // 原尺寸时直接压缩截屏中的矩形区域，不复制像素
+                jpegs.append(encoder->encode(curr, rect, quality));
+            }
+        }
+        encodedIt = it->encoded.insert(encodeKey, jpegs);
+    }
+    result.jpegs = encodedIt.value();
+    for (const QByteArray &jpegData : result.jpegs)
+    {
+        result.totalBytes += jpegData.size();
+    }
+    return result;
+}
+
+void FrameHistory::retain(const QSet<quint64> &inUse)
+{
+    for (auto it = m_frames.begin(); it != m_frames.end();)
+    {
+        if (it.key() != m_latestSeq && !inUse.contains(it.key()))
+        {
+            it = m_frames.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    // 差分缓存只保留两端帧都还在的（整帧的起始帧为0）
+    for (auto it = m_diffs.begin(); it != m_diffs.end();)
+    {
+        const DiffKey &key = it.key();
+        if (m_frames.contains(key.toSeq) && (key.fromSeq == 0 || m_frames.contains(key.fromSeq)))
+        {
+            ++it;
+        }
+        else
+        {
+            it = m_diffs.erase(it);
+        }
+    }
+}
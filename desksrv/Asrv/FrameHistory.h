@@ -0,0 +1,74 @@
+#ifndef FRAMEHISTORY_H
+#define FRAMEHISTORY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QMap>
+#include <QRect>
+#include <QSet>
+#include <QVector>
+
+// 从某一帧更新到另一帧需要发送的内容
+struct FramePatches
+{
+    QVector<QRect>      rects;       // 变化矩形（没有变化时为空）
+    QVector<QByteArray> jpegs;       // 每个矩形编码后的JPG，与 rects 一一对应
+    qint64              totalBytes = 0;
+    bool                isFull     = false;  // 是否整帧发送
+};
+
+// ScreenServer 所有客户端共用的截屏历史
+// 每帧截屏只保存一份（带递增的帧序号），客户端只记录自己画面对应的帧序号；
+// 两帧之间的差分和编码结果按 (起始帧, 目标帧, 阈值) 缓存，画面同步的客户端共用同一份差分和JPG
+class FrameHistory
+{
+public:
+    // 保存新截屏，返回帧序号（从1开始，0 表示没有基准帧）
+    quint64 push(const QImage &frame);
+
+    quint64 latestSeq() const
+    {
+        return m_latestSeq;
+    }
+
+    /**
+     * @brief 从 fromSeq 更新到 toSeq 的分片（差分和编码结果都会缓存）
+     * fromSeq 为 0、已不在历史中或分辨率不同时返回整帧
+     * @param tolerance 单个颜色通道允许的差值
+     * @param quality/scalePercent 编码质量和缩放比例（百分比）
+     */
+    FramePatches patches(quint64 fromSeq, quint64 toSeq, int tolerance, int quality, int scalePercent);
+
+    // 只保留仍被客户端引用的帧和最新帧，释放其余帧及相关的缓存
+    void retain(const QSet<quint64> &inUse);
+
+private:
+    struct DiffKey
+    {
+        quint64 fromSeq;
+        quint64 toSeq;
+        int     tolerance;
+
+        bool operator==(const DiffKey &other) const
+        {
+            return fromSeq == other.fromSeq && toSeq == other.toSeq && tolerance == other.tolerance;
+        }
+    };
+    struct DiffEntry
+    {
+        QVector<QRect>                  rects;
+        QHash<int, QVector<QByteArray>> encoded;  // key: quality * 1000 + scalePercent
+    };
+    friend uint qHash(const DiffKey &key, uint seed)
+    {
+        return ::qHash(key.fromSeq, seed) ^ ::qHash(key.toSeq, seed) ^ ::qHash(key.tolerance, seed);
+    }
+
+private:
+    QMap<quint64, QImage>     m_frames;  // 按帧序号排序，最早的帧在前
+    QHash<DiffKey, DiffEntry> m_diffs;
+    quint64                   m_latestSeq = 0;
+};
+
+#endif  // FRAMEHISTORY_H
@@ -0,0 +1,133 @@
+#include "HtmlTemplate.h"
+#include <cctype>
+
+// 占位符名只允许字母、数字、下划线，其余 {{...}}（如 js 代码）按原文处理
+static bool isValidVariableName(const char *begin, const char *end)
+{
+    if (begin == end)
+    {
+        return false;
+    }
+    for (const char *p = begin; p != end; ++p)
+    {
+        if (!isalnum(static_cast<unsigned char>(*p)) && *p != '_')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+HtmlTemplate::HtmlTemplate(const QByteArray &source)
+{
+    const int size    = source.size();
+    int       literal = 0;  // 当前文本段起点
+    int       pos     = 0;
+    while (pos < size)
+    {
+        int open = source.indexOf("{{", pos);
+        if (open < 0)
+        {
+            break;
+        }
+        int close = source.indexOf("}}", open + 2);
+        if (close < 0)
+        {
+            break;
+        }
+
+        const char *nameBegin = source.constData() + open + 2;
+        const char *nameEnd   = source.constData() + close;
+        if (!isValidVariableName(nameBegin, nameEnd))
+        {
+            pos = open + 1;
+            continue;
+        }
+
+        if (open > literal)
+        {
+            Segment segment;
+            segment.text = source.mid(literal, open - literal);
+            m_literalSize += segment.text.size();
+            m_segments.append(segment);
+        }
+
+        QByteArray name(nameBegin, static_cast<int>(nameEnd - nameBegin));
+        int        index = m_names.indexOf(name);
+        if (index < 0)
+        {
+            index = m_names.size();
+            m_names.append(name);
+        }
+        Segment segment;
+        segment.variable = index;
+        segment.text     = source.mid(open, close + 2 - open);
+        m_segments.append(segment);
+
+        pos     = close + 2;
+        literal = pos;
+    }
+
+    if (literal < size)
+    {
+        Segment segment;
+        segment.text = source.mid(literal);
+        m_literalSize += segment.text.size();
+        m_segments.append(segment);
+    }
+}
+
+int HtmlTemplate::variableIndex(const QByteArray &name) const
+{
+    return m_names.indexOf(name);
+}
+
+void HtmlTemplate::renderTo(QByteArray &out, const QVector<QByteArray> &values) const
+{
+    for (const Segment &segment : m_segments)
+    {
+        if (segment.variable >= 0 && segment.variable < values.size())
+        {
+            out.append(values.at(segment.variable));
+        }
+        else
+        {
+            out.append(segment.text);
+        }
+    }
+}
+
+QByteArray HtmlTemplate::render(const QHash<QByteArray, QByteArray> &variables) const
+{
+    // 先按变量编号查好值，渲染时不再查表
+    QVector<const QByteArray *> values(m_names.size(), nullptr);
+    int                         totalSize = m_literalSize;
+    for (int i = 0; i < m_names.size(); ++i)
+    {
+        auto it = variables.constFind(m_names.at(i));
+        if (it != variables.constEnd())
+        {
+            values[i] = &it.value();
+            totalSize += it.value().size();
+        }
+    }
+
+    QByteArray out;
+    out.reserve(totalSize);
+    for (const Segment &segment : m_segments)
+    {
+        const QByteArray *value = segment.variable >= 0 ? values.at(segment.variable) : nullptr;
+        out.append(value ? *value : segment.text);
+    }
+    return out;
+}
+
+QByteArray HtmlTemplate::render(const QMap<QString, QString> &variables) const
+{
+    QHash<QByteArray, QByteArray> utf8Variables;
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it)
+    {
+        utf8Variables.insert(it.key().toUtf8(), it.value().toUtf8());
+    }
+    return render(utf8Variables);
+}
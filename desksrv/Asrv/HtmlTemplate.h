@@ -0,0 +1,57 @@
+#ifndef HTMLTEMPLATE_H
+#define HTMLTEMPLATE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+// 编译后的模板
+// 加载时把 {{NAME}} 占位符切分为 文本段/变量段，渲染时按顺序追加到预分配的 QByteArray，
+// 不再转换为 QString，也不再对每个变量做一次全文 replace
+class HtmlTemplate
+{
+public:
+    HtmlTemplate() = default;
+    explicit HtmlTemplate(const QByteArray &source);
+
+    bool isEmpty() const
+    {
+        return m_segments.isEmpty();
+    }
+    // 变量编号（按首次出现顺序从 0 开始），模板中没有该变量时返回 -1
+    int variableIndex(const QByteArray &name) const;
+    int variableCount() const
+    {
+        return m_names.size();
+    }
+    // 文本段总长度（用于预估渲染结果大小）
+    int literalSize() const
+    {
+        return m_literalSize;
+    }
+
+    /**
+     * @brief 按变量编号渲染，结果追加到 out（调用方可提前 reserve，批量渲染时复用同一个缓冲区）
+     * @param values values[i] 为编号 i 的变量值；编号超出 values 长度的变量保留原占位符
+     */
+    void renderTo(QByteArray &out, const QVector<QByteArray> &values) const;
+
+    // 按变量名渲染（未提供的变量保留原占位符）
+    QByteArray render(const QHash<QByteArray, QByteArray> &variables) const;
+    QByteArray render(const QMap<QString, QString> &variables) const;
+
+private:
+    struct Segment
+    {
+        int        variable = -1;  // -1：文本段，否则为变量编号
+        QByteArray text;           // 文本段内容 / 变量段的原占位符
+    };
+
+    QVector<Segment>    m_segments;
+    QVector<QByteArray> m_names;
+    int                 m_literalSize = 0;
+};
+
+#endif  // HTMLTEMPLATE_H
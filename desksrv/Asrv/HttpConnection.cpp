@@ -0,0 +1,96 @@
+#include "HttpConnection.h"
+#include <QDebug>
+
+#include "def.h"
+#include "MultipartUploadWriter.h"
+#include "RouteTable.h"
+
+HttpConnection::HttpConnection(QTcpSocket *socket): QObject(socket), m_socket(socket)
+{
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(HTTP_KEEP_ALIVE_TIMEOUT * 1000);
+    connect(m_idleTimer, &QTimer::timeout, this, &HttpConnection::onIdleTimeout);
+    m_idleTimer->start();
+}
+
+HttpConnection::~HttpConnection()
+{
+}
+
+HttpConnection *HttpConnection::fromSocket(QTcpSocket *socket)
+{
+    if (!socket)
+    {
+        return nullptr;
+    }
+    return socket->findChild<HttpConnection *>(QString(), Qt::FindDirectChildrenOnly);
+}
+
+void HttpConnection::setUploadWriter(MultipartUploadWriter *writer)
+{
+    m_uploadWriter.reset(writer);
+}
+
+void HttpConnection::beginResponse()
+{
+    m_busy = true;
+    m_requestCount++;
+    m_idleTimer->stop();
+    m_responseTimer.start();
+    m_routeMetrics = nullptr;
+    // 客户端要求关闭 / 达到单连接请求上限时，本次响应后关闭连接
+    if (!m_parser.keepAlive() || m_requestCount >= HTTP_KEEP_ALIVE_MAX)
+    {
+        m_keepAlive = false;
+    }
+}
+
+void HttpConnection::finishResponse()
+{
+    if (m_routeMetrics)
+    {
+        m_routeMetrics->addResponse(m_responseTimer.nsecsElapsed() / 1000);
+        m_routeMetrics = nullptr;
+    }
+    if (!m_keepAlive)
+    {
+        m_socket->disconnectFromHost();
+        return;
+    }
+
+    m_busy = false;
+    m_parser.reset();
+    m_uploadWriter.reset();
+    m_idleTimer->start();
+    emit responseFinished();
+}
+
+QByteArray HttpConnection::connectionHeader() const
+{
+    if (!m_keepAlive)
+    {
+        return "Connection: close\r\n";
+    }
+    return "Connection: keep-alive\r\nKeep-Alive: timeout=" + QByteArray::number(HTTP_KEEP_ALIVE_TIMEOUT) +
+           ", max=" + QByteArray::number(HTTP_KEEP_ALIVE_MAX - m_requestCount) + "\r\n";
+}
+
+void HttpConnection::restartIdleTimer()
+{
+    if (!m_busy)
+    {
+        m_idleTimer->start();
+    }
+}
+
+void HttpConnection::onIdleTimeout()
+{
+    if (m_busy)
+    {
+        return;
+    }
+    qDebug() << "HTTP连接空闲超时，关闭：IP=" << m_socket->peerAddress().toString()
+             << "，已处理请求数=" << m_requestCount;
+    m_socket->disconnectFromHost();
+}
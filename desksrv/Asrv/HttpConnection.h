@@ -0,0 +1,100 @@
+#ifndef HTTPCONNECTION_H
+#define HTTPCONNECTION_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <memory>
+#include "HttpParser.h"
+
+class MultipartUploadWriter;
+struct RouteMetrics;
+
+// 单个HTTP连接的状态（挂在socket下，随socket一起释放）
+// 负责长连接管理：空闲超时、单连接请求数上限、流水线请求按顺序响应
+class HttpConnection : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HttpConnection(QTcpSocket *socket);
+    ~HttpConnection() override;
+
+    // 获取socket关联的连接状态（非HTTP连接返回nullptr）
+    static HttpConnection *fromSocket(QTcpSocket *socket);
+
+    QTcpSocket *socket() const
+    {
+        return m_socket;
+    }
+    HttpParser &parser()
+    {
+        return m_parser;
+    }
+    // 已收到但尚未解析的数据（流水线请求在前一个响应完成前暂存于此）
+    QByteArray &inBuffer()
+    {
+        return m_inBuffer;
+    }
+
+    // 当前请求的上传写入器（请求头到达时创建，响应结束后释放）
+    MultipartUploadWriter *uploadWriter() const
+    {
+        return m_uploadWriter.get();
+    }
+    void setUploadWriter(MultipartUploadWriter *writer);
+
+    // 开始响应一个已解析完成的请求
+    void beginResponse();
+    // 当前请求所属路由的统计，响应完成时记录耗时
+    void setRouteMetrics(RouteMetrics *metrics)
+    {
+        m_routeMetrics = metrics;
+    }
+    // 当前响应已完整写入：长连接则准备处理下一个请求，否则关闭连接
+    void finishResponse();
+    // 强制在当前响应后关闭连接（推流、解析错误等）
+    void closeAfterResponse()
+    {
+        m_keepAlive = false;
+    }
+
+    bool isBusy() const
+    {
+        return m_busy;
+    }
+    bool keepAlive() const
+    {
+        return m_keepAlive;
+    }
+    int requestCount() const
+    {
+        return m_requestCount;
+    }
+    // 响应头中的 Connection/Keep-Alive 字段
+    QByteArray connectionHeader() const;
+    // 有新数据到达时重置空闲计时
+    void restartIdleTimer();
+
+signals:
+    // 异步响应结束，可以继续处理缓存中的流水线请求
+    void responseFinished();
+
+private slots:
+    void onIdleTimeout();
+
+private:
+    QTcpSocket *m_socket = nullptr;
+    HttpParser  m_parser;
+    QByteArray  m_inBuffer;
+    std::unique_ptr<MultipartUploadWriter> m_uploadWriter;
+    QTimer     *m_idleTimer    = nullptr;
+    int         m_requestCount = 0;
+    bool        m_busy         = false;
+    bool        m_keepAlive    = true;
+    // 响应耗时统计
+    QElapsedTimer m_responseTimer;
+    RouteMetrics *m_routeMetrics = nullptr;
+};
+
+#endif  // HTTPCONNECTION_H
@@ -0,0 +1,379 @@
+#include "HttpParser.h"
+#include <cctype>
+#include <cstring>
+
+#include "def.h"
+
+HttpParser::HttpParser(): m_maxBodySize(MAX_REQUEST_SIZE)
+{
+}
+
+void HttpParser::reset()
+{
+    m_state       = RequestLine;
+    m_errorCode   = 0;
+    m_headerBytes = 0;
+    m_line.clear();
+    m_method.clear();
+    m_target.clear();
+    m_path.clear();
+    m_query.clear();
+    m_versionMajor = 1;
+    m_versionMinor = 1;
+    m_headers.clear();
+    m_lastHeaderName.clear();
+    m_contentLength = -1;
+    m_chunked       = false;
+    m_bodyRemaining = 0;
+    m_bodyReceived  = 0;
+    m_body.clear();
+    m_bodyHandler = nullptr;
+}
+
+void HttpParser::setBodyHandler(const BodyHandler &handler)
+{
+    m_bodyHandler = handler;
+}
+
+void HttpParser::setMaxBodySize(qint64 maxBodySize)
+{
+    m_maxBodySize = maxBodySize;
+}
+
+bool HttpParser::keepAlive() const
+{
+    QByteArray connection = header("connection").toLower();
+    if (connection.contains("close"))
+    {
+        return false;
+    }
+    if (m_versionMajor == 1 && m_versionMinor == 0)
+    {
+        return connection.contains("keep-alive");
+    }
+    return true;
+}
+
+int HttpParser::feed(const QByteArray &data, int offset, Result &result)
+{
+    const char *begin = data.constData() + offset;
+    const int   size  = data.size() - offset;
+    int         pos   = 0;
+    QByteArray  line;
+
+    result = NeedMore;
+    while (true)
+    {
+        switch (m_state)
+        {
+            case RequestLine:
+                if (!takeLine(begin, size, pos, line))
+                {
+                    result = (m_state == Error) ? ParseError : NeedMore;
+                    return pos;
+                }
+                // 请求行之前允许出现空行（RFC 7230 3.5）
+                if (line.isEmpty())
+                {
+                    break;
+                }
+                if (!parseRequestLine(line))
+                {
+                    result = ParseError;
+                    return pos;
+                }
+                m_state = Headers;
+                break;
+
+            case Headers:
+                if (!takeLine(begin, size, pos, line))
+                {
+                    result = (m_state == Error) ? ParseError : NeedMore;
+                    return pos;
+                }
+                if (line.isEmpty())
+                {
+                    // 空行：请求头结束，先通知调用方再解析请求体
+                    result = finishHeaders() ? HeadersComplete : ParseError;
+                    return pos;
+                }
+                if (!parseHeaderLine(line))
+                {
+                    result = ParseError;
+                    return pos;
+                }
+                break;
+
+            case Body:
+            case ChunkData:
+            {
+                if (m_bodyRemaining == 0)
+                {
+                    m_state = (m_state == Body) ? Complete : ChunkDataEnd;
+                    break;
+                }
+                if (pos >= size)
+                {
+                    return pos;
+                }
+                int n = static_cast<int>(qMin<qint64>(m_bodyRemaining, size - pos));
+                if (!deliverBody(begin + pos, n))
+                {
+                    result = ParseError;
+                    return pos + n;
+                }
+                pos += n;
+                m_bodyRemaining -= n;
+                break;
+            }
+
+            case ChunkSize:
+            {
+                if (!takeLine(begin, size, pos, line))
+                {
+                    result = (m_state == Error) ? ParseError : NeedMore;
+                    return pos;
+                }
+                // 忽略 chunk 扩展（;name=value）
+                int semicolon = line.indexOf(';');
+                if (semicolon >= 0)
+                {
+                    line.truncate(semicolon);
+                }
+                bool   ok        = false;
+                qint64 chunkSize = line.trimmed().toLongLong(&ok, 16);
+                if (!ok || chunkSize < 0)
+                {
+                    fail(400);
+                    result = ParseError;
+                    return pos;
+                }
+                m_bodyRemaining = chunkSize;
+                m_state         = (chunkSize == 0) ? ChunkTrailer : ChunkData;
+                break;
+            }
+
+            case ChunkDataEnd:
+                if (!takeLine(begin, size, pos, line))
+                {
+                    result = (m_state == Error) ? ParseError : NeedMore;
+                    return pos;
+                }
+                if (!line.isEmpty())
+                {
+                    fail(400);
+                    result = ParseError;
+                    return pos;
+                }
+                m_state = ChunkSize;
+                break;
+
+            case ChunkTrailer:
+                if (!takeLine(begin, size, pos, line))
+                {
+                    result = (m_state == Error) ? ParseError : NeedMore;
+                    return pos;
+                }
+                // trailer 字段不使用，遇到空行即结束
+                if (line.isEmpty())
+                {
+                    m_state = Complete;
+                }
+                break;
+
+            case Complete:
+                result = MessageComplete;
+                return pos;
+
+            case Error:
+                result = ParseError;
+                return pos;
+        }
+    }
+}
+
+bool HttpParser::takeLine(const char *data, int size, int &pos, QByteArray &line)
+{
+    const char *start = data + pos;
+    const char *nl    = static_cast<const char *>(memchr(start, '\n', size - pos));
+    int         len   = nl ? static_cast<int>(nl - start) : size - pos;
+
+    // 请求行/请求头总长度限制，防止恶意客户端无限发送不带换行的数据
+    if (m_state != ChunkSize && m_state != ChunkDataEnd)
+    {
+        m_headerBytes += len + (nl ? 1 : 0);
+        if (m_headerBytes > MAX_HEADER_SIZE)
+        {
+            fail(431);
+            return false;
+        }
+    }
+    else if (m_line.size() + len > MAX_HEADER_SIZE)
+    {
+        fail(400);
+        return false;
+    }
+
+    m_line.append(start, len);
+    pos += len;
+    if (!nl)
+    {
+        return false;
+    }
+    pos += 1;  // 跳过 '\n'
+
+    if (m_line.endsWith('\r'))
+    {
+        m_line.chop(1);
+    }
+    line.swap(m_line);
+    m_line.clear();
+    return true;
+}
+
+bool HttpParser::parseRequestLine(const QByteArray &line)
+{
+    // 格式：METHOD SP request-target SP HTTP/x.y
+    int sp1 = line.indexOf(' ');
+    int sp2 = line.indexOf(' ', sp1 + 1);
+    if (sp1 <= 0 || sp2 <= sp1 + 1)
+    {
+        fail(400);
+        return false;
+    }
+
+    QByteArray version = line.mid(sp2 + 1);
+    if (version.size() != 8 || !version.startsWith("HTTP/") || version[6] != '.' || !isdigit(version[5]) ||
+        !isdigit(version[7]))
+    {
+        fail(400);
+        return false;
+    }
+    m_versionMajor = version[5] - '0';
+    m_versionMinor = version[7] - '0';
+    if (m_versionMajor != 1)
+    {
+        fail(505);
+        return false;
+    }
+
+    m_method = line.left(sp1);
+    m_target = line.mid(sp1 + 1, sp2 - sp1 - 1);
+
+    int question = m_target.indexOf('?');
+    if (question >= 0)
+    {
+        m_path  = m_target.left(question);
+        m_query = m_target.mid(question + 1);
+    }
+    else
+    {
+        m_path = m_target;
+    }
+    return true;
+}
+
+bool HttpParser::parseHeaderLine(const QByteArray &line)
+{
+    // obs-fold：以空白开头的行是上一个请求头的续行
+    if (line[0] == ' ' || line[0] == '\t')
+    {
+        if (m_lastHeaderName.isEmpty())
+        {
+            fail(400);
+            return false;
+        }
+        m_headers[m_lastHeaderName] += ' ' + line.trimmed();
+        return true;
+    }
+
+    int colon = line.indexOf(':');
+    if (colon <= 0)
+    {
+        fail(400);
+        return false;
+    }
+
+    QByteArray name  = line.left(colon).trimmed().toLower();
+    QByteArray value = line.mid(colon + 1).trimmed();
+    auto       it    = m_headers.find(name);
+    if (it == m_headers.end())
+    {
+        m_headers.insert(name, value);
+    }
+    else
+    {
+        it.value() += ", " + value;
+    }
+    m_lastHeaderName = name;
+    return true;
+}
+
+bool HttpParser::finishHeaders()
+{
+    QByteArray transferEncoding = header("transfer-encoding").toLower();
+    if (!transferEncoding.isEmpty())
+    {
+        // 只支持 chunked，其余编码（gzip 等）无法解码
+        if (transferEncoding != "chunked")
+        {
+            fail(501);
+            return false;
+        }
+        m_chunked = true;
+        m_state   = ChunkSize;
+        return true;
+    }
+
+    if (hasHeader("content-length"))
+    {
+        bool   ok     = false;
+        qint64 length = header("content-length").toLongLong(&ok);
+        if (!ok || length < 0)
+        {
+            fail(400);
+            return false;
+        }
+        m_contentLength = length;
+        m_bodyRemaining = length;
+        m_state         = (length > 0) ? Body : Complete;
+        return true;
+    }
+
+    // 无请求体
+    m_state = Complete;
+    return true;
+}
+
+bool HttpParser::deliverBody(const char *data, int size)
+{
+    m_bodyReceived += size;
+    if (m_bodyHandler)
+    {
+        if (!m_bodyHandler(data, size))
+        {
+            fail(500);
+            return false;
+        }
+        return true;
+    }
+
+    if (m_body.size() + size > m_maxBodySize)
+    {
+        fail(413);
+        return false;
+    }
+    // 已知长度时一次性预留，避免大请求体反复扩容
+    if (m_body.isEmpty() && m_contentLength > 0)
+    {
+        m_body.reserve(static_cast<int>(qMin(m_contentLength, m_maxBodySize)));
+    }
+    m_body.append(data, size);
+    return true;
+}
+
+void HttpParser::fail(int errorCode)
+{
+    m_state     = Error;
+    m_errorCode = errorCode;
+}
@@ -0,0 +1,158 @@
+#ifndef HTTPPARSER_H
+#define HTTPPARSER_H
+#include <QByteArray>
+#include <QHash>
+#include <functional>
+
+// 增量式 HTTP/1.1 请求解析器（状态机）
+// 每个连接持有一个实例，readyRead 时只把新到的数据喂进来，已解析过的字节不会被重复扫描
+// 支持：请求行、请求头、Content-Length 请求体、chunked 请求体
+class HttpParser
+{
+public:
+    // 解析状态
+    enum State
+    {
+        RequestLine,   // 请求行
+        Headers,       // 请求头
+        Body,          // Content-Length 请求体
+        ChunkSize,     // chunk 大小行
+        ChunkData,     // chunk 数据
+        ChunkDataEnd,  // chunk 数据后的 CRLF
+        ChunkTrailer,  // 最后一个 chunk 之后的 trailer
+        Complete,      // 请求解析完成
+        Error          // 解析失败
+    };
+
+    // feed 的返回事件
+    enum Result
+    {
+        NeedMore,         // 数据不完整，等待下一次 readyRead
+        HeadersComplete,  // 请求头解析完成（此时可调用 setBodyHandler 接管请求体）
+        MessageComplete,  // 整个请求解析完成
+        ParseError        // 请求格式错误，errorCode() 给出建议的响应码
+    };
+
+    // 请求体接收器：返回 false 表示接收方出错，解析器转入 Error 状态
+    using BodyHandler = std::function<bool(const char *data, int size)>;
+
+    HttpParser();
+
+    /**
+     * @brief 从 data[offset] 开始继续解析
+     * @param data 本次收到的数据
+     * @param offset 起始偏移
+     * @param result 输出：本次解析停下来的原因
+     * @return 本次消费的字节数（请求完成后剩余的字节属于下一个请求）
+     */
+    int feed(const QByteArray &data, int offset, Result &result);
+
+    // 重置为初始状态，准备解析同一连接上的下一个请求
+    void reset();
+
+    // 请求体接收器（为空时请求体缓存在 body() 中，受 maxBodySize 限制）
+    void setBodyHandler(const BodyHandler &handler);
+    void setMaxBodySize(qint64 maxBodySize);
+
+    State state() const
+    {
+        return m_state;
+    }
+    int errorCode() const
+    {
+        return m_errorCode;
+    }
+
+    const QByteArray &method() const
+    {
+        return m_method;
+    }
+    // 原始请求目标（路径 + 查询串）
+    const QByteArray &target() const
+    {
+        return m_target;
+    }
+    const QByteArray &path() const
+    {
+        return m_path;
+    }
+    const QByteArray &query() const
+    {
+        return m_query;
+    }
+    int versionMajor() const
+    {
+        return m_versionMajor;
+    }
+    int versionMinor() const
+    {
+        return m_versionMinor;
+    }
+    // 请求头名称统一为小写，重复的请求头以 ", " 合并
+    QByteArray header(const QByteArray &lowerName) const
+    {
+        return m_headers.value(lowerName);
+    }
+    bool hasHeader(const QByteArray &lowerName) const
+    {
+        return m_headers.contains(lowerName);
+    }
+    const QHash<QByteArray, QByteArray> &headers() const
+    {
+        return m_headers;
+    }
+    // 请求方是否希望保持连接（HTTP/1.1 默认保持，HTTP/1.0 需显式 keep-alive）
+    bool keepAlive() const;
+
+    qint64 contentLength() const
+    {
+        return m_contentLength;
+    }
+    bool isChunked() const
+    {
+        return m_chunked;
+    }
+    // 已收到的请求体字节数（chunked 时为解码后的长度）
+    qint64 bodyReceived() const
+    {
+        return m_bodyReceived;
+    }
+    const QByteArray &body() const
+    {
+        return m_body;
+    }
+
+private:
+    // 从 data 中取出一行（不含 CRLF），行不完整时返回 false
+    bool takeLine(const char *data, int size, int &pos, QByteArray &line);
+    bool parseRequestLine(const QByteArray &line);
+    bool parseHeaderLine(const QByteArray &line);
+    // 请求头结束后确定请求体的读取方式
+    bool finishHeaders();
+    bool deliverBody(const char *data, int size);
+    void fail(int errorCode);
+
+private:
+    State       m_state = RequestLine;
+    int         m_errorCode = 0;
+    QByteArray  m_line;             // 未完成的行缓存
+    int         m_headerBytes = 0;  // 请求行 + 请求头累计字节数
+    QByteArray  m_method;
+    QByteArray  m_target;
+    QByteArray  m_path;
+    QByteArray  m_query;
+    int         m_versionMajor = 1;
+    int         m_versionMinor = 1;
+    QHash<QByteArray, QByteArray> m_headers;
+    QByteArray  m_lastHeaderName;   // 兼容 obs-fold 续行
+
+    qint64      m_contentLength  = -1;
+    bool        m_chunked        = false;
+    qint64      m_bodyRemaining  = 0;  // Content-Length 剩余字节 / 当前 chunk 剩余字节
+    qint64      m_bodyReceived   = 0;
+    qint64      m_maxBodySize;
+    QByteArray  m_body;
+    BodyHandler m_bodyHandler;
+};
+
+#endif  // HTTPPARSER_H
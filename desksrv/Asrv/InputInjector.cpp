@@ -0,0 +1,187 @@
+#include "InputInjector.h"
+#include <QDebug>
+
+#include "def.h"
+#include "commontool/x11struct.h"
+
+InputInjector::InputInjector(QObject *parent): QThread(parent)
+{
+    m_clock.start();
+}
+
+InputInjector::~InputInjector()
+{
+    stop();
+    wait();
+}
+
+void InputInjector::post(const InputEvent &event)
+{
+    quint64 pending = m_queue.size();
+    if (pending >= quint64(QUEUE_SIZE - 1) ||
+        (event.type == InputEvent::INPUT_MOVE && pending >= quint64(INPUT_QUEUE_MOVE_LIMIT)))
+    {
+        // 注入线程跟不上：丢弃新事件而不是让队列挤掉最早的事件；移动会被下一次移动更新，日志按数量抽样
+        ++m_dropped;
+        if (event.type != InputEvent::INPUT_MOVE || m_dropped % 256 == 1)
+        {
+            qWarning() << "InputInjector: queue backlog" << pending << ", dropped event type" << int(event.type)
+                       << "(total dropped" << m_dropped << ")";
+        }
+        return;
+    }
+    m_queue.enqueue(event);
+    m_wakeup.release();
+}
+
+void InputInjector::stop()
+{
+    m_stop.store(1);
+    m_wakeup.release();
+}
+
+void InputInjector::run()
+{
+    // Xlib 连接不能跨线程共用，注入线程使用自己的连接
+    Display *display = XOpenDisplay(nullptr);
+    if (!display)
+    {
+        qCritical() << "InputInjector: failed to open X display, remote input disabled";
+        return;
+    }
+
+    const qint64 moveInterval = qint64(INPUT_MOVE_INTERVAL) * 1000000;
+    InputEvent   pendingMove;
+    bool         hasPendingMove = false;
+    qint64       lastMoveNs     = -moveInterval;
+    while (m_stop.load() == 0)
+    {
+        // 有合并中的移动时只等到下一个刷新周期，否则一直等新事件
+        int timeout = -1;
+        if (hasPendingMove)
+        {
+            qint64 remain = qMax<qint64>(0, lastMoveNs + moveInterval - timestamp());
+            timeout       = static_cast<int>((remain + 999999) / 1000000);
+        }
+        if (m_wakeup.tryAcquire(1, timeout))
+        {
+            m_wakeup.tryAcquire(m_wakeup.available());
+        }
+
+        bool       injected = false;
+        InputEvent event;
+        while (m_queue.dequeue(event))
+        {
+            if (event.type == InputEvent::INPUT_MOVE)
+            {
+                if (hasPendingMove)
+                {
+                    ++m_coalesced;
+                }
+                pendingMove    = event;
+                hasPendingMove = true;
+                continue;
+            }
+            // 按键/滚轮之前先注入积压的移动，保证事件顺序和点击位置
+            if (hasPendingMove)
+            {
+                inject(display, pendingMove);
+                hasPendingMove = false;
+                lastMoveNs     = timestamp();
+            }
+            inject(display, event);
+            injected = true;
+        }
+        if (hasPendingMove && timestamp() - lastMoveNs >= moveInterval)
+        {
+            inject(display, pendingMove);
+            hasPendingMove = false;
+            lastMoveNs     = timestamp();
+            injected       = true;
+        }
+        if (injected)
+        {
+            XFlush(display);
+        }
+        reportStats(false);
+    }
+    reportStats(true);
+    XCloseDisplay(display);
+}
+
+void InputInjector::inject(void *display, const InputEvent &event)
+{
+    Display *dpy = static_cast<Display *>(display);
+    switch (event.type)
+    {
+        case InputEvent::INPUT_MOVE:
+            XTestFakeMotionEvent(dpy, 0, event.x, event.y, CurrentTime);
+            break;
+        case InputEvent::INPUT_BUTTON:
+            XTestFakeMotionEvent(dpy, 0, event.x, event.y, CurrentTime);
+            XTestFakeButtonEvent(dpy, event.button, event.pressed, CurrentTime);
+            break;
+        case InputEvent::INPUT_WHEEL:
+            for (int i = 0; i < event.steps; ++i)
+            {
+                XTestFakeButtonEvent(dpy, event.button, True, CurrentTime);
+                XTestFakeButtonEvent(dpy, event.button, False, CurrentTime);
+            }
+            break;
+        case InputEvent::INPUT_KEY:
+        {
+            KeyCode target = XKeysymToKeycode(dpy, event.keysym);
+            if (target == 0)
+            {
+                qWarning() << "InputInjector: no keycode for keysym" << event.keysym;
+                return;
+            }
+            KeyCode masks[4];
+            int     maskCount = 0;
+            for (int i = 0; i < event.maskCount; ++i)
+            {
+                KeyCode code = XKeysymToKeycode(dpy, event.masks[i]);
+                if (code != 0)
+                {
+                    masks[maskCount++] = code;
+                }
+            }
+            // 按下掩码键 → 按下并释放目标键 → 逆序释放掩码键
+            for (int i = 0; i < maskCount; ++i)
+            {
+                XTestFakeKeyEvent(dpy, masks[i], True, CurrentTime);
+            }
+            XTestFakeKeyEvent(dpy, target, True, CurrentTime);
+            XTestFakeKeyEvent(dpy, target, False, CurrentTime);
+            for (int i = maskCount - 1; i >= 0; --i)
+            {
+                XTestFakeKeyEvent(dpy, masks[i], False, CurrentTime);
+            }
+            break;
+        }
+        default:
+            return;
+    }
+
+    qint64 latency = timestamp() - event.received;
+    m_latencySum += latency;
+    m_latencyMax = qMax(m_latencyMax, latency);
+    ++m_injected;
+}
+
+void InputInjector::reportStats(bool force)
+{
+    qint64 now = timestamp();
+    if (m_injected == 0 || (!force && now - m_lastReportNs < qint64(INPUT_STATS_INTERVAL) * 1000000))
+    {
+        return;
+    }
+    qInfo() << "Input injection:" << m_injected << "events, latency avg"
+            << m_latencySum / qint64(m_injected) / 1000 << "us, max" << m_latencyMax / 1000 << "us, coalesced"
+            << m_coalesced << "moves";
+    m_injected     = 0;
+    m_coalesced    = 0;
+    m_latencySum   = 0;
+    m_latencyMax   = 0;
+    m_lastReportNs = now;
+}
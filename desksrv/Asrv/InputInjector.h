@@ -0,0 +1,83 @@
+#ifndef INPUTINJECTOR_H
+#define INPUTINJECTOR_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QThread>
+
+#include "common/lock_free_queue.h"
+
+// 注入线程处理的一个输入事件（主线程解析消息、换算成屏幕坐标后入队）
+struct InputEvent
+{
+    enum Type : quint8
+    {
+        INPUT_NONE = 0,
+        INPUT_MOVE,    // 鼠标移动到 (x, y)
+        INPUT_BUTTON,  // 鼠标按键按下/释放（先移动到 (x, y)）
+        INPUT_WHEEL,   // 滚轮（button 为 X11 滚轮按键号 4~7）
+        INPUT_KEY      // 组合键：按下掩码键和目标键后依次释放
+    };
+
+    quint8  type      = INPUT_NONE;
+    quint8  button    = 0;  // X11 鼠标按键号
+    bool    pressed   = false;
+    int     x         = 0;  // 屏幕绝对坐标
+    int     y         = 0;
+    int     steps     = 0;  // 滚轮步数
+    quint32 keysym    = 0;
+    quint32 masks[4]  = {0, 0, 0, 0};  // 组合键的掩码键（KeySym）
+    int     maskCount = 0;
+    qint64  received  = 0;  // 收到消息的时间（InputInjector::timestamp），用于统计注入延迟
+};
+
+// 远程控制的输入注入线程
+// 主线程只负责解析消息并入队（无锁队列），本线程用独立的 X11 连接调用 XTest 注入：
+// 连续的鼠标移动合并为最新位置，每个刷新周期最多注入一次；一批事件注入后只 XFlush 一次，
+// 不再和截屏编码抢主线程，也不会每个事件都往返一次 X 服务器
+class InputInjector : public QThread
+{
+    Q_OBJECT
+public:
+    explicit InputInjector(QObject *parent = nullptr);
+    ~InputInjector() override;
+
+    // 事件入队（只在主线程调用）
+    // 队列满时无锁队列会丢掉最早的事件（可能是按键释放，导致按键卡住），所以入队前检查积压：
+    // 积压较多时只丢弃新的鼠标移动，队列满时丢弃新事件，并记录日志
+    void post(const InputEvent &event);
+    // 通知线程退出
+    void stop();
+
+    // 单调时钟（纳秒），收到消息时记录，注入时计算延迟
+    qint64 timestamp() const
+    {
+        return m_clock.nsecsElapsed();
+    }
+
+protected:
+    void run() override;
+
+private:
+    void inject(void *display, const InputEvent &event);
+    void reportStats(bool force);
+
+private:
+    // 队列容量（其中一个节点是哨兵）
+    static const int QUEUE_SIZE = 1024;
+
+    IJK::CLockFreeQueue<InputEvent, QUEUE_SIZE> m_queue;
+    QSemaphore                                  m_wakeup;
+    QAtomicInt                                  m_stop;
+    QElapsedTimer                               m_clock;
+    quint64                                     m_dropped = 0;  // 队列积压时丢弃的事件数（主线程访问）
+    // 以下统计只在注入线程访问
+    quint64 m_injected     = 0;
+    quint64 m_coalesced    = 0;  // 被合并掉的鼠标移动数
+    qint64  m_latencySum   = 0;
+    qint64  m_latencyMax   = 0;
+    qint64  m_lastReportNs = 0;
+};
+
+#endif  // INPUTINJECTOR_H
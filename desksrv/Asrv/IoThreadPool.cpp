@@ -0,0 +1,77 @@
+#include "IoThreadPool.h"
+#include <QDebug>
+#include <unistd.h>
+
+IoWorker::IoWorker(const SetupFunction &setup): m_setup(setup)
+{
+}
+
+void IoWorker::addConnection(qintptr socketDescriptor)
+{
+    // socket 作为 worker 的子对象，线程退出时随 worker 一起释放
+    QTcpSocket *socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor))
+    {
+        qWarning() << "接管连接失败：" << socket->errorString();
+        m_connections.deref();
+        delete socket;
+        ::close(static_cast<int>(socketDescriptor));
+        return;
+    }
+    connect(socket, &QObject::destroyed, this, [this]() {
+        m_connections.deref();
+    });
+    m_setup(socket);
+}
+
+IoThreadPool::IoThreadPool(int threadCount, const IoWorker::SetupFunction &setup, QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<qintptr>("qintptr");
+    threadCount = qMax(threadCount, 1);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        QThread  *thread = new QThread(this);
+        IoWorker *worker = new IoWorker(setup);
+        thread->setObjectName(QString("http-io-%1").arg(i));
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+        m_threads.append(thread);
+        m_workers.append(worker);
+    }
+    qInfo() << "HTTP I/O线程数：" << threadCount;
+}
+
+IoThreadPool::~IoThreadPool()
+{
+    for (QThread *thread : m_threads)
+    {
+        thread->quit();
+    }
+    for (QThread *thread : m_threads)
+    {
+        thread->wait();
+    }
+}
+
+void IoThreadPool::dispatch(qintptr socketDescriptor)
+{
+    // 从轮询起点开始找连接数最少的线程
+    const int count = m_workers.size();
+    int       best  = m_next;
+    for (int i = 1; i < count; ++i)
+    {
+        int index = (m_next + i) % count;
+        if (m_workers.at(index)->connectionCount() < m_workers.at(best)->connectionCount())
+        {
+            best = index;
+        }
+    }
+    m_next = (best + 1) % count;
+
+    // 计数在分配时增加，避免连接到达 worker 之前被重复选中
+    IoWorker *worker = m_workers.at(best);
+    worker->m_connections.ref();
+    QMetaObject::invokeMethod(worker, "addConnection", Qt::QueuedConnection, Q_ARG(qintptr, socketDescriptor));
+}
@@ -0,0 +1,64 @@
+#ifndef IOTHREADPOOL_H
+#define IOTHREADPOOL_H
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QTcpSocket>
+#include <QThread>
+#include <QVector>
+#include <functional>
+
+// 运行在某个I/O线程中的连接宿主：在本线程创建socket，socket的读写和请求处理都在本线程完成
+class IoWorker : public QObject
+{
+    Q_OBJECT
+public:
+    using SetupFunction = std::function<void(QTcpSocket *)>;
+
+    explicit IoWorker(const SetupFunction &setup);
+
+    // 当前连接数（分配新连接时参考，跨线程读取）
+    int connectionCount() const
+    {
+        return m_connections.load();
+    }
+
+public slots:
+    // 接管新连接（由 IoThreadPool 排队调用，在本线程执行）
+    void addConnection(qintptr socketDescriptor);
+
+private:
+    friend class IoThreadPool;
+    SetupFunction m_setup;
+    QAtomicInt    m_connections;
+};
+
+// HTTP连接的I/O线程池
+// 每个线程运行自己的事件循环；新连接分配给当前连接数最少的线程（相同时轮询），
+// 某个连接上的慢请求只阻塞所在线程，不影响其他线程上的连接和主线程的 WebSocket 服务
+class IoThreadPool : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @param threadCount I/O线程数（小于1时按1处理）
+     * @param setup 新socket创建后的初始化函数（在I/O线程中调用，负责绑定信号和连接状态）
+     */
+    IoThreadPool(int threadCount, const IoWorker::SetupFunction &setup, QObject *parent = nullptr);
+    ~IoThreadPool() override;
+
+    int threadCount() const
+    {
+        return m_workers.size();
+    }
+
+    // 把新连接交给一个I/O线程（在监听线程调用）
+    void dispatch(qintptr socketDescriptor);
+
+private:
+    QVector<QThread *>  m_threads;
+    QVector<IoWorker *> m_workers;
+    int                 m_next = 0;  // 轮询起点
+};
+
+#endif  // IOTHREADPOOL_H
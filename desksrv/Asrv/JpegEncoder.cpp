@@ -0,0 +1,121 @@
+#include "JpegEncoder.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QThreadStorage>
+
+#ifdef HAVE_TURBOJPEG
+#    include <turbojpeg.h>
+#endif
+
+JpegEncoder::JpegEncoder()
+{
+#ifdef HAVE_TURBOJPEG
+    m_handle = tjInitCompress();
+    if (!m_handle)
+    {
+        qWarning() << "tjInitCompress failed:" << tjGetErrorStr();
+    }
+#endif
+}
+
+JpegEncoder::~JpegEncoder()
+{
+#ifdef HAVE_TURBOJPEG
+    if (m_buffer)
+    {
+        tjFree(m_buffer);
+    }
+    if (m_handle)
+    {
+        tjDestroy(m_handle);
+    }
+#endif
+}
+
+JpegEncoder *JpegEncoder::forCurrentThread()
+{
+    static QThreadStorage<JpegEncoder *> encoders;
+    if (!encoders.hasLocalData())
+    {
+        encoders.setLocalData(new JpegEncoder);
+    }
+    return encoders.localData();
+}
+
+const char *JpegEncoder::backend()
+{
+#ifdef HAVE_TURBOJPEG
+    return "libjpeg-turbo";
+#else
+    return "qimage";
+#endif
+}
+
+QByteArray JpegEncoder::encode(const QImage &image, int quality, Subsampling subsampling)
+{
+    return encode(image, QRect(), quality, subsampling);
+}
+
+QByteArray JpegEncoder::encode(const QImage &image, const QRect &rect, int quality, Subsampling subsampling)
+{
+    QRect area = rect.isNull() ? image.rect() : rect.intersected(image.rect());
+    if (image.isNull() || area.isEmpty())
+    {
+        return QByteArray();
+    }
+
+#ifdef HAVE_TURBOJPEG
+    if (m_handle)
+    {
+        // Format_RGB32/ARGB32 按 32 位整数 0xAARRGGBB 存储，小端机器上的内存顺序是 B G R A
+        QImage source = image;
+        if (source.format() != QImage::Format_RGB32 && source.format() != QImage::Format_ARGB32)
+        {
+            source = image.convertToFormat(QImage::Format_RGB32);
+        }
+#    if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        const int pixelFormat = TJPF_BGRX;
+#    else
+        const int pixelFormat = TJPF_XRGB;
+#    endif
+        static const int sampling[] = {TJSAMP_444, TJSAMP_422, TJSAMP_420};
+        int              subsamp    = sampling[subsampling];
+
+        // 按最坏情况预分配输出缓冲，编码时不再重新分配（TJFLAG_NOREALLOC）
+        unsigned long needed = tjBufSize(area.width(), area.height(), subsamp);
+        if (needed > m_bufferSize)
+        {
+            if (m_buffer)
+            {
+                tjFree(m_buffer);
+            }
+            m_buffer     = tjAlloc(static_cast<int>(needed));
+            m_bufferSize = m_buffer ? needed : 0;
+        }
+        if (m_buffer)
+        {
+            // 直接从矩形左上角的像素开始压缩，行距用原图的行距
+            const int            stride = source.bytesPerLine();
+            const unsigned char *pixels = source.constBits() + qint64(area.y()) * stride + area.x() * 4;
+            unsigned long        size   = m_bufferSize;
+            int                  result = tjCompress2(m_handle, pixels, area.width(), stride, area.height(),
+                                                      pixelFormat, &m_buffer, &size, subsamp, qBound(1, quality, 100),
+                                                      TJFLAG_NOREALLOC | TJFLAG_FASTDCT);
+            if (result == 0)
+            {
+                return QByteArray(reinterpret_cast<const char *>(m_buffer), static_cast<int>(size));
+            }
+            qWarning() << "tjCompress2 failed:" << tjGetErrorStr();
+        }
+    }
+#else
+    Q_UNUSED(subsampling);
+#endif
+
+    // QImage 实现：只编码矩形区域时需要先复制
+    QByteArray jpegData;
+    QBuffer    buffer(&jpegData);
+    buffer.open(QIODevice::WriteOnly);
+    (area == image.rect() ? image : image.copy(area)).save(&buffer, "JPEG", quality);
+    return jpegData;
+}
@@ -0,0 +1,48 @@
+#ifndef JPEGENCODER_H
+#define JPEGENCODER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+
+// 可复用的JPG编码器
+// 有 libjpeg-turbo（HAVE_TURBOJPEG）时直接压缩 32 位图像的 BGRX 内存，不转换格式、不复制矩形区域，
+// 压缩句柄和输出缓冲在多次编码之间复用；否则退回 QImage::save。
+// 同一个编码器不能并发使用，各线程通过 forCurrentThread() 取自己的实例
+class JpegEncoder
+{
+public:
+    // 色度抽样（turbojpeg 的 TJSAMP_444/422/420）
+    enum Subsampling
+    {
+        Subsampling444,
+        Subsampling422,
+        Subsampling420
+    };
+
+    JpegEncoder();
+    ~JpegEncoder();
+    JpegEncoder(const JpegEncoder &)            = delete;
+    JpegEncoder &operator=(const JpegEncoder &) = delete;
+
+    // 当前线程的编码器（线程退出时释放）
+    static JpegEncoder *forCurrentThread();
+    // 实际使用的实现："libjpeg-turbo" 或 "qimage"
+    static const char *backend();
+
+    /**
+     * @brief 编码整幅图像或其中的 rect 区域（rect 为空时编码整幅图像）
+     * @param quality 质量（0-100）
+     * @param subsampling 色度抽样，文字较多的画面可用 444 避免彩色边缘（QImage 实现忽略）
+     * @return 编码失败时返回空
+     */
+    QByteArray encode(const QImage &image, int quality, Subsampling subsampling = Subsampling420);
+    QByteArray encode(const QImage &image, const QRect &rect, int quality, Subsampling subsampling = Subsampling420);
+
+private:
+    void          *m_handle     = nullptr;  // tjhandle
+    unsigned char *m_buffer     = nullptr;  // 预分配的输出缓冲（tjAlloc）
+    unsigned long  m_bufferSize = 0;
+};
+
+#endif  // JPEGENCODER_H
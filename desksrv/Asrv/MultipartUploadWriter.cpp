@@ -0,0 +1,256 @@
+#include "MultipartUploadWriter.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QUrl>
+
+#include "def.h"
+
+MultipartUploadWriter::MultipartUploadWriter(const QByteArray &boundary, const QString &uploadDir)
+    : m_delimiter("\r\n--" + boundary), m_uploadDir(uploadDir)
+{
+    m_matcher.setPattern(m_delimiter);
+    // 第一个分隔符前面没有 CRLF，补一个后所有分隔符都可按 "\r\n--boundary" 查找
+    m_buffer = "\r\n";
+}
+
+bool MultipartUploadWriter::write(const char *data, int size)
+{
+    if (hasError())
+    {
+        return false;
+    }
+    if (m_state == Done)
+    {
+        return true;  // 忽略 epilogue
+    }
+    m_buffer.append(data, size);
+    process();
+    return !hasError();
+}
+
+bool MultipartUploadWriter::finish()
+{
+    if (!hasError() && m_state != Done)
+    {
+        fail("multipart请求体不完整：缺少结束边界");
+    }
+    return !hasError();
+}
+
+void MultipartUploadWriter::process()
+{
+    // 分隔符可能被拆在两次数据之间，查找失败时保留的尾部长度
+    const int keepTail = m_delimiter.size() - 1;
+
+    while (!hasError())
+    {
+        switch (m_state)
+        {
+            case Preamble:
+            {
+                int index = m_matcher.indexIn(m_buffer);
+                if (index < 0)
+                {
+                    if (m_buffer.size() > keepTail)
+                    {
+                        m_buffer.remove(0, m_buffer.size() - keepTail);
+                    }
+                    return;
+                }
+                m_buffer.remove(0, index + m_delimiter.size());
+                m_state = DelimiterEnd;
+                break;
+            }
+
+            case DelimiterEnd:
+                // 分隔符后允许有空白（transport-padding）
+                while (!m_buffer.isEmpty() && (m_buffer[0] == ' ' || m_buffer[0] == '\t'))
+                {
+                    m_buffer.remove(0, 1);
+                }
+                if (m_buffer.size() < 2)
+                {
+                    return;
+                }
+                if (m_buffer.startsWith("--"))
+                {
+                    m_buffer.clear();
+                    m_state = Done;
+                    return;
+                }
+                if (!m_buffer.startsWith("\r\n"))
+                {
+                    fail("multipart格式错误：分隔符后缺少换行");
+                    return;
+                }
+                m_buffer.remove(0, 2);
+                m_state = PartHeaders;
+                break;
+
+            case PartHeaders:
+            {
+                int index = m_buffer.indexOf("\r\n\r\n");
+                if (index < 0)
+                {
+                    if (m_buffer.size() > MAX_HEADER_SIZE)
+                    {
+                        fail("multipart格式错误：部分头过长");
+                    }
+                    return;
+                }
+                QByteArray header = m_buffer.left(index);
+                m_buffer.remove(0, index + 4);
+                if (!beginPart(header))
+                {
+                    return;
+                }
+                m_state = PartBody;
+                break;
+            }
+
+            case PartBody:
+            {
+                int index = m_matcher.indexIn(m_buffer);
+                if (index < 0)
+                {
+                    // 除可能属于分隔符的尾部外，其余数据直接写出
+                    int safe = m_buffer.size() - keepTail;
+                    if (safe > 0)
+                    {
+                        if (!writePart(m_buffer.constData(), safe))
+                        {
+                            return;
+                        }
+                        m_buffer.remove(0, safe);
+                    }
+                    return;
+                }
+                if (!writePart(m_buffer.constData(), index) || !endPart())
+                {
+                    return;
+                }
+                m_buffer.remove(0, index + m_delimiter.size());
+                m_state = DelimiterEnd;
+                break;
+            }
+
+            case Done:
+                m_buffer.clear();
+                return;
+        }
+    }
+}
+
+bool MultipartUploadWriter::beginPart(const QByteArray &header)
+{
+    // 解析字段名和文件名
+    static const QRegularExpression nameRe("\\bname\\s*=\\s*\"([^\"]*)\"", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression filenameRe("filename\\s*=\\s*\"([^\"]*)\"",
+                                               QRegularExpression::CaseInsensitiveOption);
+
+    QString                 headerStr     = QString::fromUtf8(header);
+    QRegularExpressionMatch nameMatch     = nameRe.match(headerStr);
+    QRegularExpressionMatch filenameMatch = filenameRe.match(headerStr);
+
+    m_fieldName = nameMatch.hasMatch() ? nameMatch.captured(1) : QString();
+    m_fieldValue.clear();
+    m_isField = false;
+
+    if (filenameMatch.hasMatch())
+    {
+        // 处理中文文件名；只保留文件名部分，防止写出上传目录
+        QString fileName = QUrl::fromPercentEncoding(filenameMatch.captured(1).toUtf8());
+        fileName         = QFileInfo(fileName.replace('\\', '/')).fileName();
+        if (fileName.isEmpty())
+        {
+            // 未选择文件的空文件控件，内容忽略
+            if (filenameMatch.captured(1).isEmpty())
+            {
+                return true;
+            }
+            fail("文件名不能为空");
+            return false;
+        }
+        // "."/".." 不是文件名（如 filename=".." 或 "a/.."），否则会拼出上传目录本身或其上级目录
+        if (fileName == "." || fileName == "..")
+        {
+            fail("无效的文件名：" + filenameMatch.captured(1));
+            return false;
+        }
+
+        // QSaveFile 在同目录下写临时文件，commit 时原子重命名
+        m_file.reset(new QSaveFile(m_uploadDir + "/" + fileName));
+        if (!m_file->open(QIODevice::WriteOnly))
+        {
+            fail("文件打开失败：" + m_file->errorString());
+            return false;
+        }
+        return true;
+    }
+
+    m_isField = !m_fieldName.isEmpty();
+    return true;
+}
+
+bool MultipartUploadWriter::writePart(const char *data, int size)
+{
+    if (size <= 0)
+    {
+        return true;
+    }
+    if (m_file)
+    {
+        if (m_file->write(data, size) != size)
+        {
+            fail("文件写入不完整：" + m_file->errorString());
+            return false;
+        }
+    }
+    else if (m_isField)
+    {
+        // 普通字段全部缓存在内存中，限制长度
+        if (m_fieldValue.size() + size > MAX_FORM_FIELD_SIZE)
+        {
+            fail("表单字段过长：" + m_fieldName);
+            return false;
+        }
+        m_fieldValue.append(data, size);
+    }
+    return true;
+}
+
+bool MultipartUploadWriter::endPart()
+{
+    if (m_file)
+    {
+        QString filePath = m_file->fileName();
+        if (!m_file->commit())
+        {
+            fail("文件保存失败：" + m_file->errorString());
+            return false;
+        }
+        m_file.reset();
+        m_savedFiles.append(filePath);
+        qDebug() << "文件上传成功：" << filePath;
+    }
+    else if (m_isField)
+    {
+        m_formFields.insert(m_fieldName, QString::fromUtf8(m_fieldValue));
+        m_fieldValue.clear();
+    }
+    m_isField = false;
+    return true;
+}
+
+void MultipartUploadWriter::fail(const QString &errorString)
+{
+    m_errorString = errorString;
+    m_buffer.clear();
+    // 未提交的临时文件直接丢弃，不覆盖已有文件
+    if (m_file)
+    {
+        m_file->cancelWriting();
+        m_file.reset();
+    }
+}
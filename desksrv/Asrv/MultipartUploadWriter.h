@@ -0,0 +1,81 @@
+#ifndef MULTIPARTUPLOADWRITER_H
+#define MULTIPARTUPLOADWRITER_H
+#include <QByteArray>
+#include <QByteArrayMatcher>
+#include <QMap>
+#include <QSaveFile>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+// 流式 multipart/form-data 解析器（用于 POST /upload）
+// 请求体边到边解析：文件部分直接写入目标目录下的临时文件，部分结束时原子重命名为正式文件
+// 内存占用与文件大小无关：只缓存本次收到的数据和不足一个分隔符长度的尾部
+class MultipartUploadWriter
+{
+public:
+    /**
+     * @param boundary Content-Type 中的 boundary 参数
+     * @param uploadDir 文件保存目录（需已存在）
+     */
+    MultipartUploadWriter(const QByteArray &boundary, const QString &uploadDir);
+
+    // 喂入一段请求体，返回 false 表示出错（errorString() 给出原因）
+    bool write(const char *data, int size);
+    // 请求体接收完毕：校验结束分隔符是否已出现
+    bool finish();
+
+    bool hasError() const
+    {
+        return !m_errorString.isEmpty();
+    }
+    const QString &errorString() const
+    {
+        return m_errorString;
+    }
+    // 已保存的文件路径
+    const QStringList &savedFiles() const
+    {
+        return m_savedFiles;
+    }
+    // 普通表单字段
+    const QMap<QString, QString> &formFields() const
+    {
+        return m_formFields;
+    }
+
+private:
+    enum State
+    {
+        Preamble,      // 第一个分隔符之前
+        DelimiterEnd,  // 分隔符之后："--" 表示结束，CRLF 表示下一个部分
+        PartHeaders,   // 部分的头
+        PartBody,      // 部分的内容
+        Done           // 结束分隔符之后（忽略 epilogue）
+    };
+
+    void process();
+    bool beginPart(const QByteArray &header);
+    bool writePart(const char *data, int size);
+    bool endPart();
+    void fail(const QString &errorString);
+
+private:
+    State             m_state = Preamble;
+    QByteArray        m_delimiter;  // "\r\n--" + boundary
+    QByteArrayMatcher m_matcher;
+    QString           m_uploadDir;
+    QByteArray        m_buffer;     // 未处理完的数据
+    QString           m_errorString;
+
+    // 当前部分
+    std::unique_ptr<QSaveFile> m_file;  // 文件部分：写入临时文件，commit 时重命名
+    QString                    m_fieldName;
+    QByteArray                 m_fieldValue;
+    bool                       m_isField = false;
+
+    QStringList            m_savedFiles;
+    QMap<QString, QString> m_formFields;
+};
+
+#endif  // MULTIPARTUPLOADWRITER_H
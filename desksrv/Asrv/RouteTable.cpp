@@ -0,0 +1,88 @@
+#include "RouteTable.h"
+#include <QJsonObject>
+
+void RouteMetrics::addResponse(qint64 micros)
+{
+    quint64 value = static_cast<quint64>(qMax<qint64>(micros, 0));
+    completed.fetchAndAddRelaxed(1);
+    totalMicros.fetchAndAddRelaxed(value);
+    quint64 current = maxMicros.load();
+    while (value > current && !maxMicros.testAndSetRelaxed(current, value))
+    {
+        current = maxMicros.load();
+    }
+}
+
+RouteTable::~RouteTable()
+{
+    qDeleteAll(m_routes);
+}
+
+void RouteTable::addExact(const QString &path, const QByteArrayList &methods, const Handler &handler)
+{
+    Route *route   = new Route;
+    route->path    = path;
+    route->methods = methods;
+    route->exact   = true;
+    route->handler = handler;
+    m_routes.append(route);
+    m_exact.insert(path, route);
+}
+
+void RouteTable::addPrefix(const QString &prefix, const QByteArrayList &methods, const Handler &handler)
+{
+    Route *route       = new Route;
+    route->path        = prefix;
+    route->methods     = methods;
+    route->subPathOnly = prefix.endsWith('/');
+    route->handler     = handler;
+    m_routes.append(route);
+    m_prefix.insert(route->subPathOnly ? prefix.left(prefix.size() - 1) : prefix, route);
+}
+
+RouteTable::Route *RouteTable::match(const QByteArray &method, const QString &path, bool &methodAllowed) const
+{
+    methodAllowed = true;
+
+    // 1. 精确路由
+    Route *route = m_exact.value(path, nullptr);
+    if (route && route->methods.contains(method))
+    {
+        return route;
+    }
+
+    // 2. 前缀路由：取第一段查表
+    int     end     = path.indexOf('/', 1);
+    QString segment = end < 0 ? path : path.left(end);
+    route           = m_prefix.value(segment, nullptr);
+    if (!route || (route->subPathOnly && end < 0))
+    {
+        return nullptr;
+    }
+    if (!route->methods.contains(method))
+    {
+        route->metrics.rejected.fetchAndAddRelaxed(1);
+        methodAllowed = false;
+    }
+    return route;
+}
+
+QJsonArray RouteTable::metricsJson() const
+{
+    QJsonArray array;
+    for (const Route *route : m_routes)
+    {
+        const RouteMetrics &metrics   = route->metrics;
+        quint64             completed = metrics.completed.load();
+        QJsonObject         item;
+        item["path"]      = route->path;
+        item["methods"]   = QString::fromLatin1(route->methods.join(','));
+        item["requests"]  = static_cast<double>(metrics.requests.load());
+        item["rejected"]  = static_cast<double>(metrics.rejected.load());
+        item["completed"] = static_cast<double>(completed);
+        item["avgMicros"] = completed ? static_cast<double>(metrics.totalMicros.load() / completed) : 0.0;
+        item["maxMicros"] = static_cast<double>(metrics.maxMicros.load());
+        array.append(item);
+    }
+    return array;
+}
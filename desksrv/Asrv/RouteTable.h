@@ -0,0 +1,79 @@
+#ifndef ROUTETABLE_H
+#define ROUTETABLE_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QByteArrayList>
+#include <QHash>
+#include <QJsonArray>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class QTcpSocket;
+class HttpParser;
+
+// 单个路由的统计（多个I/O线程并发累加）
+struct RouteMetrics
+{
+    QAtomicInteger<quint64> requests;     // 分发次数
+    QAtomicInteger<quint64> rejected;     // 方法不允许（405）次数
+    QAtomicInteger<quint64> completed;    // 响应完成次数（推流等不结束的响应不计入）
+    QAtomicInteger<quint64> totalMicros;  // 从开始响应到响应完成的累计耗时（微秒）
+    QAtomicInteger<quint64> maxMicros;    // 单次最大耗时（微秒）
+
+    void addResponse(qint64 micros);
+};
+
+// 特殊请求的路由表（启动时注册，之后只读，可跨线程查询）
+// 精确路由按完整路径查哈希表，前缀路由按路径第一段（如 /$$bash）查哈希表，
+// 分发耗时与路由数量无关，新增接口不会拉长匹配链
+class RouteTable
+{
+public:
+    // 处理函数：requestPath 为解码后的请求路径
+    using Handler = std::function<void(const QString &requestPath, QTcpSocket *socket, const HttpParser &request)>;
+
+    struct Route
+    {
+        QString        path;                 // 精确路径 / 前缀（第一段）
+        QByteArrayList methods;              // 允许的方法
+        bool           exact       = false;
+        bool           subPathOnly = false;  // 前缀路由：只匹配 前缀/xxx，不匹配前缀本身
+        Handler        handler;
+        RouteMetrics   metrics;
+    };
+
+    RouteTable() = default;
+    ~RouteTable();
+    RouteTable(const RouteTable &)            = delete;
+    RouteTable &operator=(const RouteTable &) = delete;
+
+    /**
+     * @brief 注册精确路由：路径相同且方法允许时匹配
+     * 方法不允许时视为未匹配，交给后续逻辑（如 GET /upload 仍按目录浏览处理）
+     */
+    void addExact(const QString &path, const QByteArrayList &methods, const Handler &handler);
+    /**
+     * @brief 注册前缀路由：请求路径第一段等于 prefix 时匹配（如 /$$bash、/$$bash/xxx）
+     * @param prefix 以 / 开头的单段路径，末尾的 / 表示只匹配子路径（如 /$$notify/、/js/）
+     */
+    void addPrefix(const QString &prefix, const QByteArrayList &methods, const Handler &handler);
+
+    /**
+     * @brief 查找路由
+     * @param methodAllowed 前缀路由路径匹配但方法不允许时为 false（应返回 405）
+     * @return 未匹配返回 nullptr
+     */
+    Route *match(const QByteArray &method, const QString &path, bool &methodAllowed) const;
+
+    // 所有路由的统计（JSON数组，按注册顺序）
+    QJsonArray metricsJson() const;
+
+private:
+    QVector<Route *>        m_routes;  // 注册顺序
+    QHash<QString, Route *> m_exact;   // key：完整路径
+    QHash<QString, Route *> m_prefix;  // key：路径第一段（不含末尾 /）
+};
+
+#endif  // ROUTETABLE_H
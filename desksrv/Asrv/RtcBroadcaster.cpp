@@ -0,0 +1,136 @@
+#include "RtcBroadcaster.h"
+#include <QDebug>
+#include <QImage>
+
+#include "def.h"
+#include "JpegEncoder.h"
+#include "WorkerPool.h"
+#include "commontool/screenshooter.h"
+
+RtcBroadcaster::RtcBroadcaster(QObject *parent): QObject(parent)
+{
+    m_frameTimer.setInterval(RTC_FRAME_INTERVAL);
+    connect(&m_frameTimer, &QTimer::timeout, this, &RtcBroadcaster::onFrameTimer);
+}
+
+void RtcBroadcaster::subscribe(QTcpSocket *socket)
+{
+    // 防止重复推流（同一socket只订阅一次）
+    if (socket->findChild<RtcViewer *>(QString(), Qt::FindDirectChildrenOnly))
+    {
+        return;
+    }
+    // 观看者在socket所在线程接收帧（跨线程自动排队）
+    RtcViewer *viewer = new RtcViewer(this, socket);
+    connect(this, &RtcBroadcaster::frameReady, viewer, &RtcViewer::onFrame);
+    if (m_viewers.fetchAndAddOrdered(1) == 0)
+    {
+        // 第一个观看者：在生产者线程启动截屏定时器
+        QMetaObject::invokeMethod(this, "startCapture", Qt::QueuedConnection);
+    }
+}
+
+void RtcBroadcaster::startCapture()
+{
+    if (!m_frameTimer.isActive() && m_viewers.load() > 0)
+    {
+        qDebug() << "开始屏幕推流，观看者数=" << m_viewers.load();
+        m_captureSubscription = ScreenShooter::instance()->subscribe(1000 / RTC_FRAME_INTERVAL);
+        m_frameTimer.start();
+        onFrameTimer();
+    }
+}
+
+void RtcBroadcaster::onFrameTimer()
+{
+    if (m_viewers.load() == 0)
+    {
+        qDebug() << "没有观看者，停止屏幕推流";
+        m_frameTimer.stop();
+        ScreenShooter::instance()->unsubscribe(m_captureSubscription);
+        m_captureSubscription = 0;
+        return;
+    }
+    if (m_encoding)
+    {
+        return;
+    }
+    m_encoding = true;
+
+    // 截屏和JPG编码在工作线程完成
+    WorkerPool::run<QByteArray>(
+        this,
+        []() -> QByteArray {
+            // 截屏线程的最新帧（与截屏线程共享像素，不复制）
+            QImage screenshotImg = ScreenShooter::instance()->latestFrame();
+            if (screenshotImg.isNull())
+            {
+                screenshotImg = ScreenShooter::instance()->captureImage();
+            }
+            if (screenshotImg.isNull())
+            {
+                return QByteArray();
+            }
+
+            // 将图片转为JPG（压缩体积，提升推流效率），80质量，平衡体积和清晰度
+            QByteArray imageData = JpegEncoder::forCurrentThread()->encode(screenshotImg, 80);
+
+            // 构建multipart分片（每帧图片作为一个分片），所有观看者共用
+            QByteArray frameData;
+            frameData.reserve(imageData.size() + 128);
+            frameData += "--screenBoundary\r\n";  // 分隔符
+            frameData += "Content-Type: image/jpeg\r\n";
+            frameData += "Content-Length: " + QByteArray::number(imageData.size()) + "\r\n\r\n";
+            frameData += imageData;
+            frameData += "\r\n";
+            return frameData;
+        },
+        [this](const QByteArray &frameData) {
+            m_encoding = false;
+            if (frameData.isEmpty())
+            {
+                qWarning() << "Failed to capture screen image";
+                return;
+            }
+            emit frameReady(frameData);
+        });
+}
+
+RtcViewer::RtcViewer(RtcBroadcaster *broadcaster, QTcpSocket *socket)
+    : QObject(socket), m_broadcaster(broadcaster), m_socket(socket), m_congestion(RTC_FRAME_INTERVAL, false)
+{
+    connect(socket, &QTcpSocket::bytesWritten, this, [this](qint64 bytes) { m_congestion.onBytesWritten(bytes); });
+}
+
+RtcViewer::~RtcViewer()
+{
+    m_broadcaster->m_viewers.deref();
+    qDebug() << "屏幕推流结束：已发送" << m_sentFrames << "帧，丢弃" << m_droppedFrames << "帧，最终帧率"
+             << 1000 / m_congestion.frameInterval();
+}
+
+void RtcViewer::onFrame(const QByteArray &frameData)
+{
+    if (m_socket->state() != QAbstractSocket::ConnectedState)
+    {
+        return;
+    }
+    // 背压：客户端来不及接收时丢帧，写缓冲不再增长
+    qint64 pending = m_socket->bytesToWrite();
+    if (pending > RTC_MAX_PENDING_BYTES)
+    {
+        m_droppedFrames++;
+        return;
+    }
+    // 拥塞控制：排队延迟超过目标时降低该观看者的帧率
+    m_congestion.setQueuedBytes(pending);
+    if (!m_congestion.shouldSendFrame())
+    {
+        m_droppedFrames++;
+        return;
+    }
+    m_socket->write(frameData);
+    m_socket->flush();
+    m_congestion.onFrameSent(frameData.size());
+    m_sentFrames++;
+}
@@ -0,0 +1,66 @@
+#ifndef RTCBROADCASTER_H
+#define RTCBROADCASTER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "StreamCongestion.h"
+
+// /$$rtc MJPEG 推流的共享生产者
+// 所有观看者共用一路截屏和JPG编码：每帧只截屏、编码一次，编码结果（QByteArray 引用计数共享，不复制数据）
+// 通过排队信号分发到各观看者所在的I/O线程；没有观看者时停止截屏
+class RtcBroadcaster : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RtcBroadcaster(QObject *parent = nullptr);
+
+    // 为socket开始推流（在socket所在线程调用，响应头由调用方发送）
+    void subscribe(QTcpSocket *socket);
+
+    int viewerCount() const
+    {
+        return m_viewers.load();
+    }
+
+signals:
+    // 一帧multipart分片（分隔符 + 分片头 + JPG数据）
+    void frameReady(const QByteArray &frameData);
+
+private slots:
+    void startCapture();
+    void onFrameTimer();
+
+private:
+    friend class RtcViewer;
+    QTimer     m_frameTimer;
+    QAtomicInt m_viewers;
+    bool       m_encoding            = false;  // 上一帧仍在编码时跳过本次，避免任务堆积
+    int        m_captureSubscription = 0;      // ScreenShooter 持续截屏的订阅ID
+};
+
+// 单个观看者（挂在socket下，随socket一起释放）
+// 编码结果所有观看者共用，拥塞控制只调整该观看者的帧率：按写缓冲积压和实际发送速率估计排队延迟，
+// 超过目标延迟时跳过部分帧；写缓冲积压超过上限时丢弃新帧。慢客户端只会降低自己的帧率，不影响其他观看者
+class RtcViewer : public QObject
+{
+    Q_OBJECT
+public:
+    RtcViewer(RtcBroadcaster *broadcaster, QTcpSocket *socket);
+    ~RtcViewer() override;
+
+public slots:
+    void onFrame(const QByteArray &frameData);
+
+private:
+    RtcBroadcaster  *m_broadcaster;
+    QTcpSocket      *m_socket;
+    StreamCongestion m_congestion;
+    quint64          m_sentFrames    = 0;
+    quint64          m_droppedFrames = 0;
+};
+
+#endif  // RTCBROADCASTER_H
@@ -0,0 +1,104 @@
+#include "ScreenPipeline.h"
+#include <QDebug>
+
+#include "def.h"
+#include "ScreenProtocol.h"
+#include "commontool/screenshooter.h"
+
+void ScreenCaptureStage::process(ScreenFrameJobPtr job)
+{
+    // 取截屏线程的下一帧（ScreenServer 有客户端时订阅持续截屏），与截屏线程共享像素，已是32位格式
+    quint64 seq = 0;
+    job->image  = ScreenShooter::instance()->waitFrame(m_lastSeq, SCREEN_MAX_INTERVAL, &seq);
+    if (job->image.isNull())
+    {
+        job->image = ScreenShooter::instance()->captureImage();
+    }
+    else
+    {
+        m_lastSeq = seq;
+    }
+    emit done(job);
+}
+
+void ScreenEncodeStage::process(ScreenFrameJobPtr job)
+{
+    job->seq = m_frames.push(job->image);
+
+    ScreenFrameInfo frameInfo;
+    frameInfo.width  = job->image.width();
+    frameInfo.height = job->image.height();
+    for (ScreenFrameRequest &request : job->requests)
+    {
+        if (request.video)
+        {
+            continue;
+        }
+        // 差分和JPG编码按 (起始帧, 当前帧, 阈值, 质量, 缩放) 缓存，画面同步的客户端只计算一次
+        FramePatches patches =
+            m_frames.patches(request.fromSeq, job->seq, request.tolerance, request.quality, request.scale);
+        if (!patches.rects.isEmpty())
+        {
+            request.message = encodeScreenFrame(frameInfo, patches);
+        }
+    }
+
+    // 只保留客户端画面仍引用的帧，以及还在发往主线程途中的帧
+    m_recentSeqs.append(job->seq);
+    while (m_recentSeqs.size() > SCREEN_PIPELINE_DEPTH)
+    {
+        m_recentSeqs.removeFirst();
+    }
+    QSet<quint64> inUse = job->inUse;
+    for (quint64 seq : m_recentSeqs)
+    {
+        inUse.insert(seq);
+    }
+    m_frames.retain(inUse);
+    emit done(job);
+}
+
+ScreenPipeline::ScreenPipeline(QObject *parent): QObject(parent)
+{
+    qRegisterMetaType<ScreenFrameJobPtr>("ScreenFrameJobPtr");
+
+    m_captureStage = new ScreenCaptureStage;
+    m_encodeStage  = new ScreenEncodeStage;
+    m_captureThread.setObjectName("screen-capture");
+    m_encodeThread.setObjectName("screen-encode");
+    m_captureStage->moveToThread(&m_captureThread);
+    m_encodeStage->moveToThread(&m_encodeThread);
+    connect(&m_captureThread, &QThread::finished, m_captureStage, &QObject::deleteLater);
+    connect(&m_encodeThread, &QThread::finished, m_encodeStage, &QObject::deleteLater);
+
+    // 阶段之间都是排队连接，每个阶段按提交顺序处理
+    connect(m_captureStage, &ScreenCaptureStage::done, m_encodeStage, &ScreenEncodeStage::process);
+    connect(m_encodeStage, &ScreenEncodeStage::done, this, &ScreenPipeline::onEncoded);
+    m_captureThread.start();
+    m_encodeThread.start();
+}
+
+ScreenPipeline::~ScreenPipeline()
+{
+    m_captureThread.quit();
+    m_encodeThread.quit();
+    m_captureThread.wait();
+    m_encodeThread.wait();
+}
+
+bool ScreenPipeline::isFull() const
+{
+    return m_inflight >= SCREEN_PIPELINE_DEPTH;
+}
+
+void ScreenPipeline::submit(const ScreenFrameJobPtr &job)
+{
+    ++m_inflight;
+    QMetaObject::invokeMethod(m_captureStage, "process", Qt::QueuedConnection, Q_ARG(ScreenFrameJobPtr, job));
+}
+
+void ScreenPipeline::onEncoded(ScreenFrameJobPtr job)
+{
+    --m_inflight;
+    emit frameReady(job);
+}
@@ -0,0 +1,95 @@
+#ifndef SCREENPIPELINE_H
+#define SCREENPIPELINE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+
+#include "FrameHistory.h"
+
+class QWebSocket;
+
+// 一个客户端本帧的差分参数（主线程填写）和打包结果（编码阶段填写）
+struct ScreenFrameRequest
+{
+    QWebSocket *client    = nullptr;
+    quint64     fromSeq   = 0;  // 客户端画面对应的帧序号，0 表示发送整帧
+    int         tolerance = 0;
+    int         quality   = 0;
+    int         scale     = 100;
+    bool        video     = false;  // 视频流客户端只需要截屏原图
+    QByteArray  message;            // 打包好的帧（帧序号和统计由主线程发送前改写），没有变化时为空
+};
+
+// 在流水线各阶段之间传递的一帧（共享指针传递，主线程改写帧头时不会复制数据）
+struct ScreenFrameJob
+{
+    QVector<ScreenFrameRequest> requests;
+    QSet<quint64>               inUse;  // 提交时客户端画面仍引用的帧
+    QImage                      image;  // 截屏（32位）
+    quint64                     seq = 0;
+};
+typedef QSharedPointer<ScreenFrameJob> ScreenFrameJobPtr;
+Q_DECLARE_METATYPE(ScreenFrameJobPtr)
+
+// 截屏阶段（截屏线程）
+class ScreenCaptureStage : public QObject
+{
+    Q_OBJECT
+public slots:
+    void process(ScreenFrameJobPtr job);
+signals:
+    void done(ScreenFrameJobPtr job);
+
+private:
+    quint64 m_lastSeq = 0;  // 上一次取到的 ScreenShooter 帧序号，每次等待更新的一帧
+};
+
+// 差分和编码阶段（编码线程），截屏历史只在这个线程访问
+class ScreenEncodeStage : public QObject
+{
+    Q_OBJECT
+public slots:
+    void process(ScreenFrameJobPtr job);
+signals:
+    void done(ScreenFrameJobPtr job);
+
+private:
+    FrameHistory   m_frames;
+    QList<quint64> m_recentSeqs;  // 最近产生的帧，结果可能还没送到主线程，不能释放
+};
+
+// ScreenServer 的截屏 → 差分 → 编码流水线
+// 截屏和编码各占一个线程，相邻的帧在不同阶段并行处理；流水线中最多 SCREEN_PIPELINE_DEPTH 帧，
+// 各阶段之间的排队长度也就不会超过这个值；主线程只负责提交请求和发送打包好的帧
+class ScreenPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ScreenPipeline(QObject *parent = nullptr);
+    ~ScreenPipeline() override;
+
+    // 流水线已满（截屏/编码跟不上定时器）时不再提交
+    bool isFull() const;
+    void submit(const ScreenFrameJobPtr &job);
+
+signals:
+    // 一帧处理完成（主线程）
+    void frameReady(ScreenFrameJobPtr job);
+
+private slots:
+    void onEncoded(ScreenFrameJobPtr job);
+
+private:
+    QThread            m_captureThread;
+    QThread            m_encodeThread;
+    ScreenCaptureStage *m_captureStage = nullptr;
+    ScreenEncodeStage  *m_encodeStage  = nullptr;
+    int                 m_inflight     = 0;
+};
+
+#endif  // SCREENPIPELINE_H
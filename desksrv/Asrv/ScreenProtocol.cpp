@@ -0,0 +1,102 @@
+#include "ScreenProtocol.h"
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+// 超出字段范围的值截断到最大值
+template <typename T>
+static T clampField(qint64 value)
+{
+    return static_cast<T>(qBound<qint64>(0, value, std::numeric_limits<T>::max()));
+}
+
+qint64 screenFrameSize(const FramePatches &patches)
+{
+    return SCREEN_FRAME_HEADER_SIZE + qint64(patches.rects.size()) * SCREEN_FRAME_PATCH_SIZE + patches.totalBytes;
+}
+
+// 写入帧头（不含矩形表）
+static void writeFrameHeader(uchar *out, const ScreenFrameInfo &info, quint8 flags, int patchCount)
+{
+    out[0] = SCREEN_FRAME_VERSION;
+    out[1] = flags;
+    qToLittleEndian<quint16>(clampField<quint16>(patchCount), out + 2);
+    qToLittleEndian<quint32>(info.seq, out + 4);
+    qToLittleEndian<quint16>(clampField<quint16>(info.width), out + 8);
+    qToLittleEndian<quint16>(clampField<quint16>(info.height), out + 10);
+    out[12] = clampField<quint8>(info.stats.fps);
+    out[13] = clampField<quint8>(info.stats.quality);
+    out[14] = clampField<quint8>(info.stats.scale);
+    out[15] = clampField<quint8>(info.stats.inflight);
+    qToLittleEndian<quint16>(clampField<quint16>(info.stats.latencyMs), out + 16);
+    qToLittleEndian<quint16>(clampField<quint16>(info.stats.rttMs), out + 18);
+    qToLittleEndian<quint32>(clampField<quint32>(info.stats.queuedBytes), out + 20);
+}
+
+QByteArray encodeScreenFrame(const ScreenFrameInfo &info, const FramePatches &patches)
+{
+    QByteArray frame(static_cast<int>(screenFrameSize(patches)), Qt::Uninitialized);
+    uchar     *out = reinterpret_cast<uchar *>(frame.data());
+    writeFrameHeader(out, info, patches.isFull ? SCREEN_FRAME_FLAG_FULL : 0, patches.rects.size());
+
+    uchar *entry   = out + SCREEN_FRAME_HEADER_SIZE;
+    uchar *payload = entry + patches.rects.size() * SCREEN_FRAME_PATCH_SIZE;
+    for (int i = 0; i < patches.rects.size(); ++i)
+    {
+        const QRect      &rect = patches.rects[i];
+        const QByteArray &jpeg = patches.jpegs[i];
+        qToLittleEndian<quint16>(clampField<quint16>(rect.x()), entry);
+        qToLittleEndian<quint16>(clampField<quint16>(rect.y()), entry + 2);
+        qToLittleEndian<quint16>(clampField<quint16>(rect.width()), entry + 4);
+        qToLittleEndian<quint16>(clampField<quint16>(rect.height()), entry + 6);
+        qToLittleEndian<quint32>(static_cast<quint32>(jpeg.size()), entry + 8);
+        entry += SCREEN_FRAME_PATCH_SIZE;
+
+        memcpy(payload, jpeg.constData(), jpeg.size());
+        payload += jpeg.size();
+    }
+    return frame;
+}
+
+void updateScreenFrameHeader(QByteArray &frame, const ScreenFrameInfo &info)
+{
+    if (frame.size() < SCREEN_FRAME_HEADER_SIZE)
+    {
+        return;
+    }
+    uchar *out = reinterpret_cast<uchar *>(frame.data());
+    writeFrameHeader(out, info, out[1], qFromLittleEndian<quint16>(out + 2));
+}
+
+QByteArray encodeCursorMessage(const CursorInfo &info, const QImage &sprite)
+{
+    const int  width  = sprite.width();
+    const int  height = sprite.height();
+    QByteArray message(SCREEN_CURSOR_HEADER_SIZE + width * height * 4, Qt::Uninitialized);
+    uchar     *out = reinterpret_cast<uchar *>(message.data());
+
+    out[0] = SCREEN_FRAME_VERSION;
+    out[1] = SCREEN_FRAME_FLAG_CURSOR;
+    qToLittleEndian<qint16>(static_cast<qint16>(qBound(-32768, info.x, 32767)), out + 2);
+    qToLittleEndian<qint16>(static_cast<qint16>(qBound(-32768, info.y, 32767)), out + 4);
+    qToLittleEndian<quint16>(clampField<quint16>(info.hotX), out + 6);
+    qToLittleEndian<quint16>(clampField<quint16>(info.hotY), out + 8);
+    qToLittleEndian<quint16>(clampField<quint16>(width), out + 10);
+    qToLittleEndian<quint16>(clampField<quint16>(height), out + 12);
+    qToLittleEndian<quint32>(info.serial, out + 14);
+    uchar *pixels = out + SCREEN_CURSOR_HEADER_SIZE;
+    for (int y = 0; y < height; ++y)
+    {
+        memcpy(pixels + y * width * 4, sprite.constScanLine(y), width * 4);
+    }
+    return message;
+}
+
+QByteArray encodeVideoFrame(const ScreenFrameInfo &info, quint8 flags, const QByteArray &payload)
+{
+    QByteArray frame(SCREEN_FRAME_HEADER_SIZE + payload.size(), Qt::Uninitialized);
+    uchar     *out = reinterpret_cast<uchar *>(frame.data());
+    writeFrameHeader(out, info, flags | SCREEN_FRAME_FLAG_VIDEO, 0);
+    memcpy(out + SCREEN_FRAME_HEADER_SIZE, payload.constData(), payload.size());
+    return frame;
+}
@@ -0,0 +1,100 @@
+#ifndef SCREENPROTOCOL_H
+#define SCREENPROTOCOL_H
+
+#include <QByteArray>
+#include <QImage>
+
+#include "FrameHistory.h"
+#include "StreamCongestion.h"
+
+/*
+ * ScreenServer 推送的屏幕帧：一帧只发一个 WebSocket 二进制消息，所有整数小端
+ *
+ * 帧头（SCREEN_FRAME_HEADER_SIZE 字节）
+ *   0  u8   版本（SCREEN_FRAME_VERSION）
+ *   1  u8   标志（bit0：整帧）
+ *   2  u16  矩形数 n
+ *   4  u32  帧序号（客户端确认时回传）
+ *   8  u16  屏幕宽度
+ *   10 u16  屏幕高度
+ *   12 u8   帧率            13 u8  JPG质量
+ *   14 u8   缩放比例（%）   15 u8  未确认帧数
+ *   16 u16  估计延迟（毫秒）
+ *   18 u16  往返时间（毫秒）
+ *   20 u32  发送队列积压（字节）
+ * 矩形表（n * SCREEN_FRAME_PATCH_SIZE 字节）
+ *   u16 x, u16 y, u16 w, u16 h, u32 JPG长度
+ * 之后按矩形顺序依次是各自的JPG数据
+ *
+ * 视频流模式（标志 bit1）：矩形数为 0，帧头之后直接是 H.264 数据
+ *   bit2 置位：AVCDecoderConfigurationRecord（解码器配置，编码进程启动后发送一次）
+ *   否则为一帧 AVCC 格式的编码数据，bit3 表示关键帧
+ *
+ * 光标消息（标志 bit4）：不占用帧序号，不需要确认（SCREEN_CURSOR_HEADER_SIZE 字节 + 图标）
+ *   0  u8   版本          1  u8  标志（SCREEN_FRAME_FLAG_CURSOR）
+ *   2  i16  光标x         4  i16 光标y（屏幕坐标，热点所在位置）
+ *   6  u16  热点x         8  u16 热点y
+ *   10 u16  图标宽        12 u16 图标高（为 0 表示只更新位置，沿用之前的图标）
+ *   14 u32  图标序号
+ *   之后是 宽 * 高 * 4 字节的 RGBA 像素（非预乘）
+ */
+const quint8 SCREEN_FRAME_VERSION      = 1;
+const quint8 SCREEN_FRAME_FLAG_FULL    = 0x01;
+const quint8 SCREEN_FRAME_FLAG_VIDEO   = 0x02;
+const quint8 SCREEN_FRAME_FLAG_CONFIG  = 0x04;
+const quint8 SCREEN_FRAME_FLAG_KEY     = 0x08;
+const quint8 SCREEN_FRAME_FLAG_CURSOR  = 0x10;
+const int    SCREEN_FRAME_HEADER_SIZE  = 24;
+const int    SCREEN_FRAME_PATCH_SIZE   = 12;
+const int    SCREEN_CURSOR_HEADER_SIZE = 18;
+
+/*
+ * 页面发送的鼠标输入：一个 WebSocket 二进制消息包含若干条记录，每条 SCREEN_INPUT_RECORD_SIZE 字节，小端
+ *   0  u8   类型（SCREEN_INPUT_MOVE / BUTTON / WHEEL）
+ *   1  u8   按键：鼠标按键（1左 2中 3右），bit7 表示按下；滚轮：方向（MouseSimulator::WheelDirection）
+ *   2  u16  滚轮步数
+ *   4  u16  x       6  u16 y（画布坐标）
+ *   8  u16  画布宽  10 u16 画布高（为 0 时不更新鼠标位置）
+ * 键盘事件需要按键名映射，仍使用JSON文本消息
+ */
+const quint8 SCREEN_INPUT_MOVE        = 1;
+const quint8 SCREEN_INPUT_BUTTON      = 2;
+const quint8 SCREEN_INPUT_WHEEL       = 3;
+const quint8 SCREEN_INPUT_PRESSED     = 0x80;
+const int    SCREEN_INPUT_RECORD_SIZE = 12;
+
+// 帧头中的屏幕信息
+struct ScreenFrameInfo
+{
+    quint32     seq    = 0;
+    int         width  = 0;
+    int         height = 0;
+    StreamStats stats;
+};
+
+// 光标消息中的光标信息
+struct CursorInfo
+{
+    int     x      = 0;
+    int     y      = 0;
+    int     hotX   = 0;
+    int     hotY   = 0;
+    quint32 serial = 0;
+};
+
+// 整个消息的字节数
+qint64 screenFrameSize(const FramePatches &patches);
+
+// 按上面的格式打包一帧（一次分配，不经过JSON）
+QByteArray encodeScreenFrame(const ScreenFrameInfo &info, const FramePatches &patches);
+
+// 改写已打包帧的帧序号、尺寸和统计（标志和矩形数不变），帧在工作线程打包、主线程发送前才确定序号
+void updateScreenFrameHeader(QByteArray &frame, const ScreenFrameInfo &info);
+
+// 光标消息：sprite 为空时只有位置，否则附带 RGBA8888 格式的图标
+QByteArray encodeCursorMessage(const CursorInfo &info, const QImage &sprite);
+
+// 视频流模式：帧头（flags 中带 SCREEN_FRAME_FLAG_VIDEO）+ H.264 数据
+QByteArray encodeVideoFrame(const ScreenFrameInfo &info, quint8 flags, const QByteArray &payload);
+
+#endif  // SCREENPROTOCOL_H
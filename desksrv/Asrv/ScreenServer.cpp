@@ -4,24 +4,45 @@
 #include <QImage>
 #include <QApplication>
 #include <QThread>
+#include <QtEndian>
 
 #include "commontool/globaltool.h"
 #include "x11tool.h"
-#include "commontool/screenshooter.h"
 #include "commontool/globaldef.h"
+#include "commontool/screenshooter.h"
+#include "ScreenProtocol.h"
+#include "VideoEncoder.h"
 
 ScreenServer::ScreenServer(QObject *parent): QObject(parent)
 {
-    // 初始化截屏定时器（30帧/秒，可调整）
+    // 初始化截屏定时器（最高帧率，各客户端的实际帧率由拥塞控制决定）
     m_captureTimer = new QTimer(this);
     //    m_captureTimer->setInterval(33);  // ~30fps
-    m_captureTimer->setInterval(15);  // ~60fps
+    m_captureTimer->setInterval(SCREEN_MIN_INTERVAL);  // ~60fps
     connect(m_captureTimer, &QTimer::timeout, this, &ScreenServer::captureScreenAndPush);
 
     // 初始化截屏进程
     m_screenshotProcess = new QProcess(this);
     connect(m_screenshotProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
             &ScreenServer::onProcessFinished);
+
+    // 截屏编码流水线：主线程只提交请求和发送结果
+    m_pipeline = new ScreenPipeline(this);
+    connect(m_pipeline, &ScreenPipeline::frameReady, this, &ScreenServer::onFrameReady);
+
+    // 光标叠加层：截屏不含光标，图标和位置单独发送，差分传输不会留下光标残影
+    m_cursorTracker = new CursorTracker(this);
+    connect(m_cursorTracker, &CursorTracker::spriteChanged, this, [this](const QByteArray &message) {
+        m_cursorSprite = message;
+        broadcastCursor(message, false);
+    });
+    connect(m_cursorTracker, &CursorTracker::positionChanged, this,
+            [this](const QByteArray &message) { broadcastCursor(message, true); });
+    m_cursorTracker->start();
+
+    // 输入注入线程：鼠标键盘事件不在主线程调用 XTest
+    m_inputInjector = new InputInjector(this);
+    m_inputInjector->start();
 }
 
 ScreenServer::~ScreenServer()
@@ -106,6 +127,27 @@ void ScreenServer::onNewConnection()
     connect(client, &QWebSocket::disconnected, this, &ScreenServer::onClientDisconnected);
     connect(client, &QWebSocket::textMessageReceived, this, &ScreenServer::onTextMessageReceived);
     connect(client, &QWebSocket::binaryMessageReceived, this, &ScreenServer::onBinaryReceived);
+    // 实际写出的字节数用于估计发送队列积压和发送速率
+    connect(client, &QWebSocket::bytesWritten, this, [this, client](qint64 bytes) {
+        auto it = m_clientMap.find(client);
+        if (it != m_clientMap.end())
+        {
+            it->congestion.onBytesWritten(bytes);
+        }
+    });
+
+    // 有客户端时截屏线程持续截屏，流水线直接取它的最新帧
+    if (m_captureSubscription == 0)
+    {
+        m_captureSubscription = ScreenShooter::instance()->subscribe(1000 / SCREEN_MIN_INTERVAL);
+    }
+
+    // 先发送当前光标图标，之后只收到位置更新
+    m_cursorTracker->setEnabled(true);
+    if (!m_cursorSprite.isEmpty())
+    {
+        sendBinaryToClient(client, m_cursorSprite);
+    }
 }
 
 void ScreenServer::onClientDisconnected()
@@ -127,6 +169,7 @@ void ScreenServer::onTextMessageReceived(const QString &message)
     {
         return;
     }
+    qint64 received = m_inputInjector->timestamp();
 
     // 解析JSON格式的鼠标事件
     QJsonDocument jsonDoc = QJsonDocument::fromJson(message.toUtf8());
@@ -137,20 +180,60 @@ void ScreenServer::onTextMessageReceived(const QString &message)
     }
 
     QJsonObject jsonObj = jsonDoc.object();
-    if (jsonObj["type"].toString().contains("mouse"))
+    if (jsonObj["type"].toString() == "frame_ack")
+    {
+        // 客户端已显示该帧
+        auto it = m_clientMap.find(client);
+        if (it != m_clientMap.end())
+        {
+            it->congestion.onFrameAck(static_cast<quint32>(jsonObj["seq"].toDouble()));
+        }
+    }
+    else if (jsonObj["type"].toString() == "stream_mode")
     {
-        handleMouseEvent(jsonObj, client);
+        setStreamMode(client, jsonObj["mode"].toString());
+    }
+    else if (jsonObj["type"].toString().contains("mouse"))
+    {
+        handleMouseEvent(jsonObj, client, received);
     }
     else if (jsonObj["type"].toString().contains("keyboard"))
     {
-        handleKeyboardEvent(jsonObj, client);
+        handleKeyboardEvent(jsonObj, client, received);
     }
 }
 
 void ScreenServer::onBinaryReceived(const QByteArray &binary)
 {
-    Q_UNUSED(binary);
-    qWarning() << "Binary message not supported";
+    QWebSocket *client = qobject_cast<QWebSocket *>(sender());
+    auto        it     = m_clientMap.find(client);
+    if (it == m_clientMap.end())
+    {
+        return;
+    }
+    qint64 received = m_inputInjector->timestamp();
+
+    // 批量鼠标输入（格式见 ScreenProtocol.h）
+    if (binary.isEmpty() || binary.size() % SCREEN_INPUT_RECORD_SIZE != 0)
+    {
+        qWarning() << "Invalid input message size:" << binary.size();
+        return;
+    }
+    const uchar *data = reinterpret_cast<const uchar *>(binary.constData());
+    for (int offset = 0; offset < binary.size(); offset += SCREEN_INPUT_RECORD_SIZE)
+    {
+        const uchar *record = data + offset;
+        int          width  = qFromLittleEndian<quint16>(record + 8);
+        int          height = qFromLittleEndian<quint16>(record + 10);
+        if (width > 0 && height > 0)
+        {
+            it->mouseX       = qFromLittleEndian<quint16>(record + 4);
+            it->mouseY       = qFromLittleEndian<quint16>(record + 6);
+            it->screenWidth  = width;
+            it->screenHeight = height;
+        }
+        postMouseInput(*it, record[0], record[1], qFromLittleEndian<quint16>(record + 2), received);
+    }
 }
 
 void ScreenServer::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
@@ -167,9 +250,29 @@ void ScreenServer::closeClientConnection(QWebSocket *client)
         return;
     }
 
+    auto it = m_clientMap.find(client);
+    if (it != m_clientMap.end())
+    {
+        StreamStats stats = it->congestion.stats();
+        qInfo() << "Screen stream stats: sent" << stats.sentFrames << "frames, skipped" << stats.skippedFrames
+                << "frames, final fps" << stats.fps << "quality" << stats.quality << "scale" << stats.scale;
+        if (it->videoEncoder)
+        {
+            it->videoEncoder->stop();
+            it->videoEncoder->deleteLater();
+            it->videoEncoder = nullptr;
+        }
+    }
+
     client->abort();
     client->deleteLater();
     m_clientMap.remove(client);
+    if (m_clientMap.isEmpty())
+    {
+        m_cursorTracker->setEnabled(false);
+        ScreenShooter::instance()->unsubscribe(m_captureSubscription);
+        m_captureSubscription = 0;
+    }
 }
 
 void ScreenServer::sendMessageToClient(QWebSocket *client, const QString &msg)
@@ -190,79 +293,177 @@ void ScreenServer::sendBinaryToClient(QWebSocket *client, const QByteArray &bina
     client->sendBinaryMessage(binary);
 }
 
+void ScreenServer::setStreamMode(QWebSocket *client, const QString &mode)
+{
+    auto it = m_clientMap.find(client);
+    if (it == m_clientMap.end())
+    {
+        return;
+    }
+
+    QJsonObject reply;
+    reply["type"] = "stream_mode";
+    if (mode == "h264" && !it->videoEncoder)
+    {
+        if (!VideoEncoder::isAvailable())
+        {
+            reply["mode"]  = "jpeg";
+            reply["error"] = "ffmpeg not found";
+            sendMessageToClient(client, QJsonDocument(reply).toJson(QJsonDocument::Compact));
+            return;
+        }
+        VideoEncoder *encoder = new VideoEncoder(this);
+        connect(encoder, &VideoEncoder::configReady, this,
+                [this, client](const QByteArray &config) { sendVideoFrame(client, SCREEN_FRAME_FLAG_CONFIG, config); });
+        connect(encoder, &VideoEncoder::frameReady, this, [this, client](const QByteArray &frame, bool keyFrame) {
+            sendVideoFrame(client, keyFrame ? SCREEN_FRAME_FLAG_KEY : 0, frame);
+        });
+        // 编码进程异常时退回差分JPG
+        connect(encoder, &VideoEncoder::failed, this, [this, client](const QString &reason) {
+            qWarning() << "Video stream failed, fallback to jpeg:" << reason;
+            setStreamMode(client, "jpeg");
+        });
+        it->videoEncoder = encoder;
+        // 码率由编码器控制，拥塞时只降低帧率
+        it->congestion.setAdaptImage(false);
+        reply["mode"] = "h264";
+    }
+    else if (mode != "h264")
+    {
+        if (it->videoEncoder)
+        {
+            // 可能在编码器自身的信号中调用，延迟释放
+            it->videoEncoder->disconnect(this);
+            it->videoEncoder->stop();
+            it->videoEncoder->deleteLater();
+            it->videoEncoder = nullptr;
+            it->congestion.setAdaptImage(true);
+            it->isFirstFrame = true;
+        }
+        reply["mode"] = "jpeg";
+    }
+    else
+    {
+        reply["mode"] = "h264";
+    }
+    qInfo() << "Client" << client->peerAddress().toString() << "stream mode:" << reply["mode"].toString();
+    sendMessageToClient(client, QJsonDocument(reply).toJson(QJsonDocument::Compact));
+}
+
+void ScreenServer::sendVideoFrame(QWebSocket *client, quint8 flags, const QByteArray &payload)
+{
+    auto it = m_clientMap.find(client);
+    if (it == m_clientMap.end() || !it->videoEncoder)
+    {
+        return;
+    }
+    ScreenFrameInfo frameInfo;
+    frameInfo.seq    = it->congestion.onFrameSent(SCREEN_FRAME_HEADER_SIZE + payload.size());
+    frameInfo.width  = it->videoEncoder->width();
+    frameInfo.height = it->videoEncoder->height();
+    frameInfo.stats  = it->congestion.stats();
+    sendBinaryToClient(client, encodeVideoFrame(frameInfo, flags, payload));
+}
+
+void ScreenServer::broadcastCursor(const QByteArray &message, bool onlyIdle)
+{
+    for (auto it = m_clientMap.begin(); it != m_clientMap.end(); ++it)
+    {
+        if (onlyIdle && it.key()->bytesToWrite() > SCREEN_MAX_PENDING_BYTES)
+        {
+            continue;
+        }
+        sendBinaryToClient(it.key(), message);
+    }
+}
+
 void ScreenServer::captureScreenAndPush()
 {
     if (m_clientMap.isEmpty())
     {
         return;  // 无客户端，跳过截屏
     }
-
-    // 1. 截取当前屏幕
-    std::future<QPixmap> pixmapFuture       = ScreenShooter::instance()->captureScreenAsync();
-    QPixmap              currPixmap         = pixmapFuture.get();
-    int                  globalScreenWidth  = currPixmap.width();
-    int                  globalScreenHeight = currPixmap.height();
-    // 5. 为每个客户端推送差分数据
-    for (auto client : m_clientMap.keys())
+    // 截屏编码跟不上定时器时跳过本次，不在流水线里堆积
+    if (m_pipeline->isFull())
     {
-        ClientInfo &info = m_clientMap[client];  // 单个客户端的专属状态
-        QRect       diffRect;
+        return;
+    }
 
-        // 2.1 该客户端的差分区域计算（独立判断首帧）
-        if (info.isFirstFrame || info.prevPixmap.isNull() || info.prevPixmap.size() != currPixmap.size())
+    // 拥塞控制：只给到了发送时间且网络不拥塞的客户端推送，都不需要时跳过截屏
+    ScreenFrameJobPtr job(new ScreenFrameJob);
+    for (auto it = m_clientMap.begin(); it != m_clientMap.end(); ++it)
+    {
+        ClientInfo &info = it.value();  // 单个客户端的专属状态
+        job->inUse.insert(info.frameSeq);
+        if (info.frameInFlight || !info.congestion.shouldSendFrame())
         {
-            // 该客户端首帧/分辨率变化：发送全屏
-            diffRect          = QRect(0, 0, globalScreenWidth, globalScreenHeight);
-            info.isFirstFrame = false;
-            info.prevPixmap   = currPixmap.copy();  // 初始化该客户端的上一帧
+            continue;
         }
-        else
+        // 缩放比例提高后重发全屏，替换之前的低分辨率画面
+        if (info.congestion.takeRefreshRequest())
         {
-            // 对比该客户端的上一帧和当前帧
-            diffRect = calculateDiffRect(info.prevPixmap, currPixmap, info.diffThreshold);
-            if (diffRect.isEmpty())
-            {
-                continue;  // 该客户端无变化，跳过推送
-            }
-            info.prevPixmap = currPixmap.copy();  // 更新该客户端的上一帧
+            info.isFirstFrame = true;
         }
 
-        // 2.2 裁剪该客户端的差分区域
-        QPixmap diffPixmap = currPixmap.copy(diffRect);
+        // 从该客户端画面对应的帧到当前帧的分片（首帧/分辨率变化时为全屏）
+        info.frameInFlight = true;
+        ScreenFrameRequest request;
+        request.client    = it.key();
+        request.fromSeq   = info.isFirstFrame ? 0 : info.frameSeq;
+        request.tolerance = info.diffThreshold;
+        request.quality   = info.congestion.quality();
+        request.scale     = info.congestion.scalePercent();
+        request.video     = info.videoEncoder != nullptr;
+        job->requests.append(request);
+    }
+    if (job->requests.isEmpty())
+    {
+        return;
+    }
+    m_pipeline->submit(job);
+}
 
-        // 2.3 绘制该客户端的专属鼠标
-        QPixmap clientPixmap = diffPixmap.copy();
-        if (diffRect.contains(info.mouseX, info.mouseY))
+void ScreenServer::onFrameReady(ScreenFrameJobPtr job)
+{
+    for (ScreenFrameRequest &request : job->requests)
+    {
+        auto it = m_clientMap.find(request.client);
+        if (it == m_clientMap.end())
         {
-            // 差分传输 鼠标会有残影
-//            drawVirtualMouse(info, globalScreenWidth, globalScreenHeight, clientPixmap);
+            continue;  // 处理期间客户端已断开
         }
+        ClientInfo &info   = it.value();
+        info.frameInFlight = false;
 
-        // 2.4 构造该客户端的差分帧信息
-        QJsonObject frameInfo;
-        frameInfo["type"]    = "screen_frame_meta";
-        frameInfo["width"]   = globalScreenWidth;
-        frameInfo["height"]  = globalScreenHeight;
-        frameInfo["diff_x"]  = diffRect.x();
-        frameInfo["diff_y"]  = diffRect.y();
-        frameInfo["diff_w"]  = diffRect.width();
-        frameInfo["diff_h"]  = diffRect.height();
-        frameInfo["is_full"] = (diffRect.width() == globalScreenWidth && diffRect.height() == globalScreenHeight);
-
-        // 2.5 发送该客户端的元信息和二进制数据
-        QJsonDocument infoDoc(frameInfo);
-        sendMessageToClient(client, infoDoc.toJson(QJsonDocument::Compact));
-
-        QImage     diffImage = clientPixmap.toImage();
-        QByteArray jpegData;
-        QBuffer    buffer(&jpegData);
-        buffer.open(QIODevice::WriteOnly);
-        diffImage.save(&buffer, "JPEG", 100);
-        sendBinaryToClient(client, jpegData);
+        // 视频流模式：整帧交给编码器，编码结果由 sendVideoFrame 异步推送（不参与差分和截屏历史）
+        if (request.video || info.videoEncoder)
+        {
+            if (request.video && info.videoEncoder)
+            {
+                info.videoEncoder->encode(job->image);
+            }
+            continue;
+        }
+        if (request.message.isEmpty())
+        {
+            continue;  // 该客户端无变化，跳过推送（保留原来的帧，小于阈值的变化不会累积丢失）
+        }
+        info.isFirstFrame = false;
+        info.frameSeq     = job->seq;
+        // 光标不画进画面（差分传输会有残影），由 CursorTracker 作为叠加层单独发送
+
+        // 帧在编码线程已打包好（格式见 ScreenProtocol.h），这里只填入帧序号和拥塞控制统计
+        ScreenFrameInfo frameInfo;
+        frameInfo.seq    = info.congestion.onFrameSent(request.message.size());
+        frameInfo.width  = job->image.width();
+        frameInfo.height = job->image.height();
+        frameInfo.stats  = info.congestion.stats();
+        updateScreenFrameHeader(request.message, frameInfo);
+        sendBinaryToClient(request.client, request.message);
     }
 }
 
-void ScreenServer::handleMouseEvent(const QJsonObject &mouseEvent, QWebSocket *client)
+void ScreenServer::handleMouseEvent(const QJsonObject &mouseEvent, QWebSocket *client, qint64 received)
 {
     if (!client || !m_clientMap.contains(client))
     {
@@ -272,74 +473,41 @@ void ScreenServer::handleMouseEvent(const QJsonObject &mouseEvent, QWebSocket *c
     ClientInfo &info = m_clientMap[client];
     QString     type = mouseEvent["type"].toString();
 
-    // 处理鼠标移动
+    // 处理鼠标移动（高频事件，不逐条记录日志；连续移动由注入线程合并）
     if (type == "mouse_move")
     {
+        int width  = mouseEvent["screen_width"].toInt();
+        int height = mouseEvent["screen_height"].toInt();
+        if (width <= 0 || height <= 0)
+        {
+            return;
+        }
         info.mouseX       = mouseEvent["x"].toInt();
         info.mouseY       = mouseEvent["y"].toInt();
-        info.screenWidth  = mouseEvent["screen_width"].toInt();
-        info.screenHeight = mouseEvent["screen_height"].toInt();
-
-        // 模拟移动
-        int x, y;
-        getRealXY(info, x, y);
-        MouseSimulator::getInstance()->moveMouse(x, y);
-        QString logStr = QString("Client %1 mouse move to: %2,%3 wh=%4x%5")
-                             .arg(client->peerAddress().toString())  // %1: 客户端地址
-                             .arg(info.mouseX)                       // %2: 鼠标X坐标
-                             .arg(info.mouseY)                       // %3: 鼠标Y坐标
-                             .arg(info.screenWidth)                  // %4: 屏幕宽度
-                             .arg(info.screenHeight);                // %5: 屏幕高度
-        LOG_MESSAGE("Asrv", logStr)
+        info.screenWidth  = width;
+        info.screenHeight = height;
+        postMouseInput(info, SCREEN_INPUT_MOVE, 0, 0, received);
     }
     // 处理鼠标点击
     else if (type == "mouse_click")
     {
-        QString button  = mouseEvent["button"].toString();
-        QString action  = mouseEvent["action"].toString();
-        bool    pressed = action == "press";
-        // 模拟点击
-        int x, y;
-        getRealXY(info, x, y);
-        MouseSimulator::MouseButton btn = MouseSimulator::MouseButton::ButtonNone;
-        if (pressed)
+        QString                     button = mouseEvent["button"].toString();
+        QString                     action = mouseEvent["action"].toString();
+        MouseSimulator::MouseButton btn    = MouseSimulator::MouseButton::ButtonNone;
+        if (button == "left")
         {
-            if (button == "left")
-            {
-                info.isLeftPressed = pressed;
-                btn                = MouseSimulator::MouseButton::LeftButton;
-            }
-            else if (button == "right")
-            {
-                info.isRightPressed = pressed;
-                btn                 = MouseSimulator::MouseButton::RightButton;
-            }
-            else if (button == "middle")
-            {
-                info.isMiddlePressed = pressed;
-                btn                  = MouseSimulator::MouseButton::MiddleButton;
-            }
-            MouseSimulator::getInstance()->pressMouse(btn, x, y);
+            btn = MouseSimulator::MouseButton::LeftButton;
         }
-        else
+        else if (button == "right")
         {
-            if (button == "left")
-            {
-                info.isLeftPressed = pressed;
-                btn                = MouseSimulator::MouseButton::LeftButton;
-            }
-            else if (button == "right")
-            {
-                info.isRightPressed = pressed;
-                btn                 = MouseSimulator::MouseButton::RightButton;
-            }
-            else if (button == "middle")
-            {
-                info.isMiddlePressed = pressed;
-                btn                  = MouseSimulator::MouseButton::MiddleButton;
-            }
-            MouseSimulator::getInstance()->releaseMouse(btn, x, y);
+            btn = MouseSimulator::MouseButton::RightButton;
+        }
+        else if (button == "middle")
+        {
+            btn = MouseSimulator::MouseButton::MiddleButton;
         }
+        quint8 arg = static_cast<quint8>(btn) | (action == "press" ? SCREEN_INPUT_PRESSED : 0);
+        postMouseInput(info, SCREEN_INPUT_BUTTON, arg, 0, received);
         QString logStr =
             QString("Client %1 mouse  %2 %3").arg(client->peerAddress().toString()).arg(button).arg(action);
 
@@ -348,25 +516,74 @@ void ScreenServer::handleMouseEvent(const QJsonObject &mouseEvent, QWebSocket *c
     // 新增：处理滚轮事件
     else if (type == "mouse_wheel")
     {
-        QString direction = mouseEvent["direction"].toString();
-        int     steps     = mouseEvent["steps"].toInt();
-        int     x         = mouseEvent["x"].toInt();
-        int     y         = mouseEvent["y"].toInt();
-        // 模拟Linux系统滚轮
+        QString                        direction  = mouseEvent["direction"].toString();
+        int                            steps      = mouseEvent["steps"].toInt();
         MouseSimulator::WheelDirection eDirection = getScrollWhellDirection(direction);
-        MouseSimulator::getInstance()->scrollWheel(eDirection, steps);
-        QString logStr = QString("Client %1 mouse wheel: %2 steps: %3 at %4,%5")
+        postMouseInput(info, SCREEN_INPUT_WHEEL, static_cast<quint8>(eDirection), steps, received);
+        QString logStr = QString("Client %1 mouse wheel: %2 steps: %3")
                              .arg(client->peerAddress().toString())  // %1: 客户端地址
                              .arg(direction)                         // %2: 滚轮方向
-                             .arg(steps)                             // %3: 滚动步数
-                             .arg(x)                                 // %4: X坐标
-                             .arg(y);                                // %5: Y坐标
+                             .arg(steps);                            // %3: 滚动步数
         LOG_MESSAGE("Asrv", logStr)
     }
 }
 
+void ScreenServer::postMouseInput(ClientInfo &info, quint8 type, quint8 arg, int steps, qint64 received)
+{
+    InputEvent event;
+    event.received = received;
+    getRealXY(info, event.x, event.y);
+    if (type == SCREEN_INPUT_MOVE)
+    {
+        event.type = InputEvent::INPUT_MOVE;
+    }
+    else if (type == SCREEN_INPUT_BUTTON)
+    {
+        int  button  = arg & ~SCREEN_INPUT_PRESSED;
+        bool pressed = (arg & SCREEN_INPUT_PRESSED) != 0;
+        if (button == MouseSimulator::MouseButton::LeftButton)
+        {
+            info.isLeftPressed = pressed;
+        }
+        else if (button == MouseSimulator::MouseButton::RightButton)
+        {
+            info.isRightPressed = pressed;
+        }
+        else if (button == MouseSimulator::MouseButton::MiddleButton)
+        {
+            info.isMiddlePressed = pressed;
+        }
+        else
+        {
+            return;
+        }
+        // MouseButton 的取值就是 X11 的按键号
+        event.type    = InputEvent::INPUT_BUTTON;
+        event.button  = static_cast<quint8>(button);
+        event.pressed = pressed;
+    }
+    else if (type == SCREEN_INPUT_WHEEL)
+    {
+        // X11滚轮事件映射：Up/Down用Button4/5，Left/Right用Button6/7（按 WheelDirection 取值索引）
+        static const quint8 wheelButtons[] = {0, Button4, Button5, Button6, Button7};
+        if (arg < MouseSimulator::WheelDirection::WheelUp || arg > MouseSimulator::WheelDirection::WheelRight ||
+            steps <= 0)
+        {
+            return;
+        }
+        event.type   = InputEvent::INPUT_WHEEL;
+        event.button = wheelButtons[arg];
+        event.steps  = qMin(steps, INPUT_WHEEL_MAX_STEPS);
+    }
+    else
+    {
+        return;
+    }
+    m_inputInjector->post(event);
+}
+
 // 补全键盘事件处理逻辑
-void ScreenServer::handleKeyboardEvent(const QJsonObject &keyboardEvent, QWebSocket *client)
+void ScreenServer::handleKeyboardEvent(const QJsonObject &keyboardEvent, QWebSocket *client, qint64 received)
 {
     // 校验客户端有效性
     if (!client || !m_clientMap.contains(client))
@@ -389,7 +606,6 @@ void ScreenServer::handleKeyboardEvent(const QJsonObject &keyboardEvent, QWebSoc
     QString     action    = keyboardEvent["action"].toString();     // press/release
     QString     keyStr    = keyboardEvent["key"].toString();        // 标准化的按键名
     QJsonObject modifiers = keyboardEvent["modifiers"].toObject();  // 组合键状态
-    QString     rawKey    = keyboardEvent["rawKey"].toString();     // 新增：前端传的原始符号键（如!）
 
     // 更新客户端的组合键状态
     info.isCtrlPressed  = modifiers["ctrl"].toBool();
@@ -403,9 +619,6 @@ void ScreenServer::handleKeyboardEvent(const QJsonObject &keyboardEvent, QWebSoc
     // 跳过纯组合键的press/release（单独处理组合键状态即可）
     if (keyName == "ctrl" || keyName == "shift" || keyName == "alt" || keyName == "meta")
     {
-        QString logStr =
-            QString("Client %1 modifier key %2 %3").arg(client->peerAddress().toString()).arg(keyStr).arg(action);
-        LOG_MESSAGE("Asrv", logStr)
         return;
     }
 
@@ -417,39 +630,26 @@ void ScreenServer::handleKeyboardEvent(const QJsonObject &keyboardEvent, QWebSoc
         return;
     }
 
-    // 只处理press事件（release事件由simulateKeyWithMask内部处理）
+    // 只处理press事件（注入线程按下目标键后随即释放，release事件忽略）
+    // 注入是异步的，这里拿不到结果；和鼠标移动一样不逐个事件打日志，注入统计由 InputInjector 定期输出
     if (action == "press")
     {
         // 构建组合键掩码列表
         std::vector<KeySym> maskKeys = buildMaskKeys(info);
 
-        // 模拟按键（包含组合键）
-        bool success = simulateKeyWithMask(maskKeys, targetKey);
-
-        // 日志输出（补充符号键信息）
-        QString logStr =
-            QString(
-                "Client %1 keyboard press: %2 (original: %3) modifiers: Ctrl=%4 Shift=%5 Alt=%6 Meta=%7 success: %8")
-                .arg(client->peerAddress().toString())  // %1: 客户端地址
-                .arg(keyStr)                            // %2: 按键字符串
-                .arg(rawKey)                            // %3: 原始按键值
-                .arg(info.isCtrlPressed)                // %4: Ctrl是否按下
-                .arg(info.isShiftPressed)               // %5: Shift是否按下
-                .arg(info.isAltPressed)                 // %6: Alt是否按下
-                .arg(info.isMetaPressed)                // %7: Meta是否按下
-                .arg(success);                          // %8: 操作是否成功
-        LOG_MESSAGE("Asrv", logStr)
-    }
-    else if (action == "release")
-    {
-        bool success = true;
-        // 日志输出
-        QString logStr = QString("Client %1 keyboard release: %2 (original: %3)  success: %4")
-                             .arg(client->peerAddress().toString())  // %1: 客户端地址
-                             .arg(keyStr)                            // %2: 按键字符串
-                             .arg(rawKey)                            // %3: 原始按键值
-                             .arg(success);                          // %4: 操作是否成功
-        LOG_MESSAGE("Asrv", logStr)
+        // 模拟按键（包含组合键），交给注入线程，不在主线程等待按键间隔
+        InputEvent event;
+        event.type     = InputEvent::INPUT_KEY;
+        event.keysym   = static_cast<quint32>(targetKey);
+        event.received = received;
+        for (KeySym mask : maskKeys)
+        {
+            if (event.maskCount < 4)
+            {
+                event.masks[event.maskCount++] = static_cast<quint32>(mask);
+            }
+        }
+        m_inputInjector->post(event);
     }
 }
 
@@ -528,52 +728,3 @@ void ScreenServer::drawVirtualMouse(const ClientInfo &info,
     painter.setPen(QPen(Qt::white, 1));
     painter.drawPath(mousePath);
 }
-
-QRect ScreenServer::calculateDiffRect(const QPixmap &prev, const QPixmap &curr, int threshold)
-{
-    QImage prevImg = prev.toImage().convertToFormat(QImage::Format_RGB888);
-    QImage currImg = curr.toImage().convertToFormat(QImage::Format_RGB888);
-
-    int  width  = prevImg.width();
-    int  height = prevImg.height();
-    int  minX = width, minY = height, maxX = 0, maxY = 0;
-    bool hasDiff = false;
-
-    // 逐像素对比（可优化：按块对比提升性能）
-    for (int y = 0; y < height; y++)
-    {
-        uchar *prevLine = prevImg.scanLine(y);
-        uchar *currLine = currImg.scanLine(y);
-        for (int x = 0; x < width; x++)
-        {
-            // 计算RGB差值
-            int rDiff     = abs(prevLine[x * 3] - currLine[x * 3]);
-            int gDiff     = abs(prevLine[x * 3 + 1] - currLine[x * 3 + 1]);
-            int bDiff     = abs(prevLine[x * 3 + 2] - currLine[x * 3 + 2]);
-            int totalDiff = rDiff + gDiff + bDiff;
-
-            if (totalDiff > threshold)
-            {
-                // 更新差分区域边界
-                minX    = qMin(minX, x);
-                minY    = qMin(minY, y);
-                maxX    = qMax(maxX, x);
-                maxY    = qMax(maxY, y);
-                hasDiff = true;
-            }
-        }
-    }
-
-    if (!hasDiff)
-    {
-        return QRect();  // 无变化
-    }
-
-    // 扩展差分区域（避免边缘截断，可选）
-    minX = qMax(0, minX - 2);
-    minY = qMax(0, minY - 2);
-    maxX = qMin(width - 1, maxX + 2);
-    maxY = qMin(height - 1, maxY + 2);
-
-    return QRect(minX, minY, maxX - minX + 1, maxY - minY + 1);
-}
@@ -17,6 +17,9 @@
 
 #include "commontool/mousesimulator.h"
 #include "ClientInfo.h"
+#include "ScreenPipeline.h"
+#include "InputInjector.h"
+#include "CursorTracker.h"
 
 class ScreenServer : public QObject
 {
@@ -37,11 +40,12 @@ private slots:
     void closeClientConnection(QWebSocket *client);
     void sendMessageToClient(QWebSocket *client, const QString &msg);
     void sendBinaryToClient(QWebSocket *client, const QByteArray &binary);
-    // 新增：定时截屏并推送
+    // 新增：定时截屏并推送（提交到截屏编码流水线，处理完成后在 onFrameReady 中发送）
     void captureScreenAndPush();
-    // 新增：处理鼠标事件
-    void handleMouseEvent(const QJsonObject &mouseEvent, QWebSocket *client);
-    void handleKeyboardEvent(const QJsonObject &mouseEvent, QWebSocket *client);
+    void onFrameReady(ScreenFrameJobPtr job);
+    // 新增：处理鼠标事件（received 为收到消息的时间，用于统计注入延迟）
+    void handleMouseEvent(const QJsonObject &mouseEvent, QWebSocket *client, qint64 received);
+    void handleKeyboardEvent(const QJsonObject &mouseEvent, QWebSocket *client, qint64 received);
 
 private:
     QWebSocketServer              *m_wsServer = nullptr;
@@ -50,16 +54,27 @@ private:
     QTimer                        *m_captureTimer = nullptr;       // 截屏定时器
     QMap<QWebSocket *, ClientInfo> m_clientMap;                    // 客户端映射
     QProcess                      *m_screenshotProcess = nullptr;  // 截屏进程
+    ScreenPipeline                *m_pipeline = nullptr;           // 截屏、差分和编码在工作线程完成
+    InputInjector                 *m_inputInjector = nullptr;      // 鼠标键盘注入线程
+    CursorTracker                 *m_cursorTracker = nullptr;      // 光标叠加层（图标和位置）
+    QByteArray                     m_cursorSprite;                 // 最近的光标图标消息，新客户端连接时先发送
+    int                            m_captureSubscription = 0;      // ScreenShooter 持续截屏的订阅ID，0 表示未订阅
 
 //    QPixmap m_prevPixmap;            // 上一帧截图，用于差分对比
 //    QRect   m_diffRect;              // 差分区域（需要更新的矩形）
 //    bool    m_isFirstFrame  = true;  // 是否是第一帧（第一帧需发送全屏）
 //    int     m_diffThreshold = 10;    // 像素差异阈值（可调整，值越小越灵敏）
 private:
+    // 切换客户端的推流模式："h264"（视频流，需要 ffmpeg）或 "jpeg"（差分JPG）
+    void                           setStreamMode(QWebSocket *client, const QString &mode);
+    void                           sendVideoFrame(QWebSocket *client, quint8 flags, const QByteArray &payload);
+    // 光标消息发给所有客户端，onlyIdle 时跳过发送队列积压的客户端（位置更新可以丢弃，图标不能）
+    void                           broadcastCursor(const QByteArray &message, bool onlyIdle);
+    // 鼠标输入交给注入线程（type/arg/steps 含义见 ScreenProtocol.h 的输入记录），按键时更新按压状态
+    void postMouseInput(ClientInfo &info, quint8 type, quint8 arg, int steps, qint64 received);
     void                           getRealXY(const ClientInfo &info, int &x, int &y);
     MouseSimulator::WheelDirection getScrollWhellDirection(const QString &direction);
-    void  drawVirtualMouse(const ClientInfo &info, const int screenWidth, const int screenHeight, QPixmap &pixmap);
-    QRect calculateDiffRect(const QPixmap &prev, const QPixmap &curr, int threshold);
+    void drawVirtualMouse(const ClientInfo &info, const int screenWidth, const int screenHeight, QPixmap &pixmap);
 };
 
 #endif  // SCREENSERVER_H
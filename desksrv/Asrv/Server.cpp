@@ -1,7 +1,9 @@
 #include "Server.h"
+#include <QCoreApplication>
 #include <QFileInfo>
 #include "def.h"
 #include "tool.h"
+#include "StaticCache.h"
 
 static quint16 s_wsPort             = 0;
 static quint16 s_wsScreenServerPort = 0;
@@ -13,6 +15,16 @@ Server::Server(QString ip, quint16 port)
     m_screenSrv.startListen(ip, port + 2);
     s_wsPort             = port + 1;
     s_wsScreenServerPort = port + 2;
+
+    // 端口确定后预加载www资源，js中的WebSocket地址在加载时一次性替换
+    QString      strIp           = getLocalIpv4();
+    QString      strWsAddr       = "ws://" + strIp + ":" + QString::number(s_wsPort);
+    QString      strScreenWsAddr = "ws://" + strIp + ":" + QString::number(s_wsScreenServerPort);
+    StaticCache *cache           = StaticCache::instance();
+    cache->setFileVariables("bash.js", {{"WS_HOST", strWsAddr}});
+    cache->setFileVariables("xtermpage.js", {{"WS_HOST", strWsAddr}});
+    cache->setFileVariables("screen_ctrl.js", {{"WS_HOST", strScreenWsAddr}});
+    cache->load(QCoreApplication::applicationDirPath() + "/www");
 }
 
 quint16 Server::getWsPort()
@@ -0,0 +1,209 @@
+#include "StaticCache.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+#include "tool.h"
+
+StaticCache *StaticCache::m_instance = nullptr;
+QMutex       StaticCache::m_instanceMutex;
+
+StaticCache *StaticCache::instance()
+{
+    if (m_instance == nullptr)
+    {
+        QMutexLocker locker(&m_instanceMutex);
+        if (m_instance == nullptr)
+        {
+            m_instance = new StaticCache(nullptr);
+        }
+    }
+    return m_instance;
+}
+
+StaticCache::StaticCache(QObject *parent): QObject(parent)
+{
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &StaticCache::onFileChanged);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &StaticCache::onDirectoryChanged);
+}
+
+void StaticCache::setFileVariables(const QString &fileName, const QMap<QString, QString> &variables)
+{
+    m_fileVariables[fileName] = variables;
+}
+
+void StaticCache::load(const QString &rootDir)
+{
+    m_rootDir = QDir(rootDir).absolutePath();
+    if (!QFileInfo(m_rootDir).isDir())
+    {
+        qWarning() << "www目录不存在，静态资源缓存为空：" << m_rootDir;
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    loadDirectory(m_rootDir);
+
+    qint64 totalSize = 0;
+    {
+        QReadLocker locker(&m_lock);
+        for (const EntryPtr &entry : m_entries)
+        {
+            totalSize += entry->data.size() + entry->gzip.size() + entry->brotli.size();
+        }
+        qInfo() << "www资源缓存加载完成：文件数=" << m_entries.size() << "，占用内存=" << formatFileSize(totalSize)
+                << "，耗时=" << timer.elapsed() << "ms";
+    }
+}
+
+StaticCache::EntryPtr StaticCache::find(const QString &requestPath) const
+{
+    QReadLocker locker(&m_lock);
+    return m_entries.value(requestPath);
+}
+
+void StaticCache::onFileChanged(const QString &filePath)
+{
+    qDebug() << "www资源变化，重新加载：" << filePath;
+    loadFile(filePath);
+}
+
+void StaticCache::onDirectoryChanged(const QString &dirPath)
+{
+    // 新增/删除/改名（编辑器保存时常先写临时文件再改名）都会触发目录变化
+    qDebug() << "www目录变化，重新扫描：" << dirPath;
+    loadDirectory(dirPath);
+
+    // 移除该目录下已不存在的文件
+    QString prefix = cacheKey(dirPath);
+    if (!prefix.endsWith('/'))
+    {
+        prefix += '/';
+    }
+    QStringList removed;
+    {
+        QWriteLocker locker(&m_lock);
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            if (it.key().startsWith(prefix) && !QFileInfo::exists(m_rootDir + it.key()))
+            {
+                removed.append(it.key());
+                it = m_entries.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+    for (const QString &key : removed)
+    {
+        qDebug() << "www资源已删除，移出缓存：" << key;
+    }
+}
+
+void StaticCache::loadDirectory(const QString &dirPath)
+{
+    if (!m_watcher.directories().contains(dirPath))
+    {
+        m_watcher.addPath(dirPath);
+    }
+
+    QDirIterator it(dirPath, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+    while (it.hasNext())
+    {
+        QString   path     = it.next();
+        QFileInfo fileInfo = it.fileInfo();
+        if (fileInfo.isDir())
+        {
+            loadDirectory(path);
+            continue;
+        }
+
+        // 未变化的文件不重复加载
+        EntryPtr entry = find(cacheKey(path));
+        if (entry && entry->fileSize == fileInfo.size() && entry->lastModified == fileInfo.lastModified())
+        {
+            continue;
+        }
+        loadFile(path);
+    }
+}
+
+void StaticCache::loadFile(const QString &filePath)
+{
+    QString key = cacheKey(filePath);
+    QFile   file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        QWriteLocker locker(&m_lock);
+        m_entries.remove(key);
+        return;
+    }
+
+    QSharedPointer<Entry> entry(new Entry);
+    QFileInfo             fileInfo(filePath);
+    entry->data         = file.readAll();
+    entry->fileSize     = fileInfo.size();
+    entry->lastModified = fileInfo.lastModified();
+    entry->mimeType     = getMimeType(filePath).toUtf8();
+    file.close();
+
+    // 1. 预先替换占位符
+    auto varsIt = m_fileVariables.constFind(fileInfo.fileName());
+    if (varsIt != m_fileVariables.constEnd())
+    {
+        for (auto it = varsIt->constBegin(); it != varsIt->constEnd(); ++it)
+        {
+            entry->data.replace("{{" + it.key().toUtf8() + "}}", it.value().toUtf8());
+        }
+    }
+
+    // 2. 文本类资源预压缩，压缩后没有明显变小则不保留
+    bool compressible = entry->mimeType.startsWith("text/") || entry->mimeType.contains("javascript") ||
+                        entry->mimeType.contains("json") || entry->mimeType.contains("svg");
+    if (compressible && entry->data.size() >= STATIC_COMPRESS_MIN_SIZE)
+    {
+        QByteArray gzip = gzipCompress(entry->data);
+        if (!gzip.isEmpty() && gzip.size() < entry->data.size() * 9 / 10)
+        {
+            entry->gzip = gzip;
+        }
+        QByteArray brotli = brotliCompress(entry->data);
+        if (!brotli.isEmpty() && brotli.size() < entry->data.size() * 9 / 10)
+        {
+            entry->brotli = brotli;
+        }
+    }
+
+    // 3. html 模板预编译（readTemplate 渲染时直接使用）
+    if (fileInfo.suffix().toLower() == "html")
+    {
+        entry->compiled = HtmlTemplate(entry->data);
+    }
+
+    // 4. ETag 基于替换后的内容
+    entry->etag = "\"" + QCryptographicHash::hash(entry->data, QCryptographicHash::Md5).toHex().left(16) + "\"";
+
+    {
+        QWriteLocker locker(&m_lock);
+        m_entries.insert(key, entry);
+    }
+
+    // 编辑器改名替换文件后原监听失效，重新添加
+    if (!m_watcher.files().contains(filePath))
+    {
+        m_watcher.addPath(filePath);
+    }
+}
+
+QString StaticCache::cacheKey(const QString &filePath) const
+{
+    QString key = QDir(filePath).absolutePath().mid(m_rootDir.length());
+    return key.isEmpty() ? QString("/") : key;
+}
@@ -0,0 +1,79 @@
+#ifndef STATICCACHE_H
+#define STATICCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QString>
+#include "HtmlTemplate.h"
+
+// www 资源内存缓存（单例）
+// 启动时加载整个 www 目录：占位符预先替换，文本类资源预先生成 gzip/brotli 压缩版本；
+// 通过 QFileSystemWatcher（Linux 下基于 inotify）监听文件变化并重新加载，静态资源请求直接从内存响应
+class StaticCache : public QObject
+{
+    Q_OBJECT
+    explicit StaticCache(QObject *parent = nullptr);
+
+    StaticCache(const StaticCache &)            = delete;
+    StaticCache &operator=(const StaticCache &) = delete;
+
+public:
+    // 一个缓存的资源文件（加载后只读，可跨线程共享）
+    struct Entry
+    {
+        QByteArray   data;          // 已替换占位符的内容
+        QByteArray   gzip;          // gzip 压缩版本（不值得压缩时为空）
+        QByteArray   brotli;        // brotli 压缩版本（未启用 brotli 或不值得压缩时为空）
+        QByteArray   mimeType;
+        QByteArray   etag;
+        HtmlTemplate compiled;      // html 模板预编译结果（非 html 文件为空）
+        QDateTime    lastModified;
+        qint64       fileSize = 0;  // 磁盘上的原始大小，用于判断文件是否变化
+    };
+    using EntryPtr = QSharedPointer<const Entry>;
+
+    static StaticCache *instance();
+
+    /**
+     * @brief 设置某个文件加载时需要替换的占位符（{{KEY}} -> value）
+     * @param fileName 文件名（不含目录，如 bash.js）
+     * 需在 load 之前调用
+     */
+    void setFileVariables(const QString &fileName, const QMap<QString, QString> &variables);
+
+    // 加载 www 目录并开始监听变化
+    void load(const QString &rootDir);
+
+    // 按请求路径查找资源（如 /js/bash.js），不存在返回空指针
+    EntryPtr find(const QString &requestPath) const;
+
+private slots:
+    void onFileChanged(const QString &filePath);
+    void onDirectoryChanged(const QString &dirPath);
+
+private:
+    // 加载目录下所有文件（递归），未变化的文件跳过
+    void loadDirectory(const QString &dirPath);
+    // 加载单个文件，文件不存在时移除对应缓存
+    void loadFile(const QString &filePath);
+    QString cacheKey(const QString &filePath) const;
+
+private:
+    static StaticCache *m_instance;
+    static QMutex       m_instanceMutex;
+
+    QString                                m_rootDir;
+    QMap<QString, QMap<QString, QString>>  m_fileVariables;
+    QFileSystemWatcher                     m_watcher;
+    mutable QReadWriteLock                 m_lock;
+    QHash<QString, EntryPtr>               m_entries;  // key：以 / 开头的相对路径
+};
+
+#endif  // STATICCACHE_H
@@ -0,0 +1,239 @@
+#include "StreamCongestion.h"
+#include <QtGlobal>
+
+#include "def.h"
+
+// 发送速率的采样窗口（毫秒）
+static const int RATE_WINDOW = 200;
+// 最多保留的未确认帧发送时间（旧版页面不发送确认，避免无限增长）
+static const int SEND_HISTORY = 64;
+
+StreamCongestion::StreamCongestion(int minInterval, bool adaptImage)
+    : m_minInterval(minInterval),
+      m_adaptImage(adaptImage),
+      m_interval(minInterval),
+      m_quality(SCREEN_MAX_QUALITY)
+{
+    m_clock.start();
+}
+
+bool StreamCongestion::shouldSendFrame()
+{
+    adjust();
+
+    // 截屏定时器的触发时间有抖动，留半个最小间隔的余量
+    qint64 now = m_clock.elapsed();
+    if (m_lastSendTime >= 0 && now - m_lastSendTime < m_interval - m_minInterval / 2)
+    {
+        return false;
+    }
+
+    quint32 inflight = m_nextSeq - 1 - m_lastAckSeq;
+    if ((m_ackSeen && inflight >= static_cast<quint32>(SCREEN_MAX_INFLIGHT)) ||
+        m_queuedBytes > SCREEN_MAX_PENDING_BYTES)
+    {
+        m_skippedFrames++;
+        return false;
+    }
+    return true;
+}
+
+quint32 StreamCongestion::onFrameSent(qint64 bytes)
+{
+    qint64 now = m_clock.elapsed();
+    if (m_queuedBytes == 0)
+    {
+        // 队列从空开始积压，发送速率重新计时
+        m_rateWindowStart = now;
+        m_rateWindowBytes = 0;
+    }
+    m_lastSendTime = now;
+    m_queuedBytes += bytes;
+    m_sentFrames++;
+
+    quint32 seq      = m_nextSeq++;
+    m_sendTimes[seq] = now;
+    m_sendTimes.remove(seq - SEND_HISTORY);
+    return seq;
+}
+
+void StreamCongestion::onBytesWritten(qint64 bytes)
+{
+    m_queuedBytes = qMax<qint64>(0, m_queuedBytes - bytes);
+    m_rateWindowBytes += bytes;
+
+    qint64 now     = m_clock.elapsed();
+    qint64 elapsed = now - m_rateWindowStart;
+    if (elapsed < RATE_WINDOW)
+    {
+        return;
+    }
+    // 队列为空时的速率只反映发送量，不代表链路能力，只在队列仍有积压或速率更高时采样
+    double sample = static_cast<double>(m_rateWindowBytes) / elapsed;
+    if (m_queuedBytes > 0 || sample > m_throughput)
+    {
+        m_throughput = (m_throughput == 0) ? sample : m_throughput * 0.7 + sample * 0.3;
+    }
+    m_rateWindowStart = now;
+    m_rateWindowBytes = 0;
+}
+
+void StreamCongestion::setQueuedBytes(qint64 bytes)
+{
+    m_queuedBytes = bytes;
+}
+
+void StreamCongestion::onFrameAck(quint32 seq)
+{
+    // 确认是累积的：seq 之前未确认的帧一并视为已确认
+    if (seq < m_lastAckSeq || seq >= m_nextSeq)
+    {
+        return;
+    }
+    m_ackSeen    = true;
+    m_freshAck   = true;
+    m_lastAckSeq = seq;
+
+    auto it = m_sendTimes.find(seq);
+    if (it != m_sendTimes.end())
+    {
+        double sample = static_cast<double>(m_clock.elapsed() - it.value());
+        m_rtt         = (m_rtt == 0) ? sample : m_rtt * 0.8 + sample * 0.2;
+    }
+    auto iter = m_sendTimes.begin();
+    while (iter != m_sendTimes.end())
+    {
+        if (iter.key() <= seq)
+        {
+            iter = m_sendTimes.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void StreamCongestion::setAdaptImage(bool adaptImage)
+{
+    m_adaptImage = adaptImage;
+    if (!adaptImage)
+    {
+        m_quality = SCREEN_MAX_QUALITY;
+        m_scale   = 100;
+    }
+}
+
+bool StreamCongestion::takeRefreshRequest()
+{
+    bool requested     = m_refreshRequested;
+    m_refreshRequested = false;
+    return requested;
+}
+
+int StreamCongestion::latency() const
+{
+    double value = m_rtt;
+    // 发送队列中的数据还需多久才能发完
+    if (m_queuedBytes > 0 && m_throughput > 0)
+    {
+        value = qMax(value, m_queuedBytes / m_throughput);
+    }
+    // 最早的未确认帧已等待的时间（客户端卡住时往返时间不再更新）
+    if (m_ackSeen)
+    {
+        qint64 now = m_clock.elapsed();
+        for (auto it = m_sendTimes.constBegin(); it != m_sendTimes.constEnd(); ++it)
+        {
+            value = qMax(value, static_cast<double>(now - it.value()));
+        }
+    }
+    return static_cast<int>(value);
+}
+
+StreamStats StreamCongestion::stats() const
+{
+    StreamStats stats;
+    stats.fps           = 1000 / m_interval;
+    stats.quality       = m_quality;
+    stats.scale         = m_scale;
+    stats.latencyMs     = latency();
+    stats.rttMs         = static_cast<int>(m_rtt);
+    stats.inflight      = static_cast<int>(m_nextSeq - 1 - m_lastAckSeq);
+    stats.queuedBytes   = m_queuedBytes;
+    stats.sentFrames    = m_sentFrames;
+    stats.skippedFrames = m_skippedFrames;
+    return stats;
+}
+
+void StreamCongestion::adjust()
+{
+    qint64 now = m_clock.elapsed();
+    if (now - m_lastAdjustTime < SCREEN_ADJUST_INTERVAL)
+    {
+        return;
+    }
+    m_lastAdjustTime = now;
+
+    int current = latency();
+    // 上次调整后没有新的确认且已无在途数据：平滑的往返时间已过时（如画面静止），不据此降级
+    if (m_ackSeen && !m_freshAck && m_sendTimes.isEmpty() && m_queuedBytes == 0)
+    {
+        current = 0;
+    }
+    m_freshAck = false;
+
+    if (current > SCREEN_TARGET_LATENCY)
+    {
+        // 严重超出目标时一次降两级
+        degrade();
+        if (current > SCREEN_TARGET_LATENCY * 2)
+        {
+            degrade();
+        }
+        m_lastDegradeTime = now;
+    }
+    else if (current < SCREEN_TARGET_LATENCY / 2 && now - m_lastDegradeTime >= SCREEN_UPGRADE_HOLD)
+    {
+        upgrade();
+    }
+}
+
+// 降级顺序：质量 -> 缩放 -> 帧率（操作时帧率对手感影响最大，最后才降）
+void StreamCongestion::degrade()
+{
+    if (m_adaptImage && m_quality > SCREEN_MIN_QUALITY)
+    {
+        m_quality = qMax(SCREEN_MIN_QUALITY, m_quality - SCREEN_QUALITY_STEP);
+        return;
+    }
+    if (m_adaptImage && m_scale > SCREEN_MIN_SCALE)
+    {
+        m_scale = qMax(SCREEN_MIN_SCALE, m_scale - SCREEN_SCALE_STEP);
+        return;
+    }
+    if (m_interval < SCREEN_MAX_INTERVAL)
+    {
+        m_interval = qMin(SCREEN_MAX_INTERVAL, m_interval * 3 / 2);
+    }
+}
+
+// 恢复顺序与降级相反：帧率 -> 缩放 -> 质量，质量每次只恢复半步
+void StreamCongestion::upgrade()
+{
+    if (m_interval > m_minInterval)
+    {
+        m_interval = qMax(m_minInterval, m_interval * 2 / 3);
+        return;
+    }
+    if (m_adaptImage && m_scale < 100)
+    {
+        m_scale            = qMin(100, m_scale + SCREEN_SCALE_STEP);
+        m_refreshRequested = true;
+        return;
+    }
+    if (m_adaptImage && m_quality < SCREEN_MAX_QUALITY)
+    {
+        m_quality = qMin(SCREEN_MAX_QUALITY, m_quality + SCREEN_QUALITY_STEP / 2);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef STREAMCONGESTION_H
+#define STREAMCONGESTION_H
+
+#include <QElapsedTimer>
+#include <QHash>
+
+// 拥塞控制的统计信息（随每帧发送给客户端）
+struct StreamStats
+{
+    int     fps           = 0;
+    int     quality       = 0;
+    int     scale         = 0;  // 百分比
+    int     latencyMs     = 0;
+    int     rttMs         = 0;
+    int     inflight      = 0;  // 未确认帧数
+    qint64  queuedBytes   = 0;
+    quint64 sentFrames    = 0;
+    quint64 skippedFrames = 0;
+};
+
+// 屏幕推流的单客户端拥塞控制
+// 根据发送队列积压（按实际发送速率折算成排队时间）和客户端帧确认的往返时间估计端到端延迟，
+// 延迟超过目标时依次降低JPG质量、缩小分辨率、降低帧率；延迟明显低于目标时按相反顺序逐级恢复
+class StreamCongestion
+{
+public:
+    /**
+     * @param minInterval 最小帧间隔（毫秒），即最高帧率
+     * @param adaptImage  是否调整质量和缩放（多个客户端共用同一份编码结果时只能调整帧率）
+     */
+    explicit StreamCongestion(int minInterval, bool adaptImage = true);
+
+    // 本次截屏是否给该客户端发送帧（未到帧间隔、未确认帧过多或积压过多时跳过）
+    bool shouldSendFrame();
+    // 发送一帧后调用（bytes 为写入发送队列的字节数），返回帧序号
+    quint32 onFrameSent(qint64 bytes);
+    // socket 实际写出数据（bytesWritten 信号）
+    void onBytesWritten(qint64 bytes);
+    // 发送队列积压字节数可直接获取时（QTcpSocket::bytesToWrite）覆盖内部估算值
+    void setQueuedBytes(qint64 bytes);
+    // 客户端确认已显示某一帧
+    void onFrameAck(quint32 seq);
+    // 切换是否调整质量和缩放（视频流模式由编码器控制码率，只调整帧率），关闭时恢复原画
+    void setAdaptImage(bool adaptImage);
+    // 缩放比例提高后需要重发全屏帧（之前的低分辨率区域才会变清晰），读取后清除
+    bool takeRefreshRequest();
+
+    int frameInterval() const
+    {
+        return m_interval;
+    }
+    int quality() const
+    {
+        return m_quality;
+    }
+    // 缩放比例（百分比）
+    int scalePercent() const
+    {
+        return m_scale;
+    }
+    // 当前估计的延迟（毫秒）
+    int latency() const;
+
+    // 统计信息（附在每帧的帧头中）
+    StreamStats stats() const;
+
+private:
+    void adjust();
+    void degrade();
+    void upgrade();
+
+private:
+    QElapsedTimer          m_clock;
+    int                    m_minInterval;
+    bool                   m_adaptImage;
+    int                    m_interval;
+    int                    m_quality;
+    int                    m_scale            = 100;
+    bool                   m_refreshRequested = false;
+    qint64                 m_lastSendTime     = -1;
+    qint64                 m_lastAdjustTime   = 0;
+    qint64                 m_lastDegradeTime  = 0;
+    quint32                m_nextSeq          = 1;
+    quint32                m_lastAckSeq       = 0;
+    bool                   m_ackSeen          = false;  // 旧版页面不发送确认，只按发送队列判断
+    bool                   m_freshAck         = false;  // 上次调整后是否收到过确认
+    QHash<quint32, qint64> m_sendTimes;                 // 未确认帧的发送时间
+    qint64                 m_queuedBytes      = 0;
+    double                 m_rtt              = 0;  // 帧确认往返时间（平滑值，毫秒）
+    double                 m_throughput       = 0;  // 实际发送速率（平滑值，字节/毫秒）
+    qint64                 m_rateWindowStart  = 0;
+    qint64                 m_rateWindowBytes  = 0;
+    quint64                m_sentFrames       = 0;
+    quint64                m_skippedFrames    = 0;
+};
+
+#endif  // STREAMCONGESTION_H
@@ -10,6 +10,8 @@
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
+#include <QUrlQuery>
 #include <QUrl>
 #include <QTextCodec>
 #include <QScreen>
@@ -27,11 +29,23 @@
 #include <QMessageBox>
 #include <QApplication>
 #include <QWidget>
+#include <QCryptographicHash>
 
 #include "tool.h"
 #include "def.h"
 #include "Server.h"
 #include "widget/NotifyPopup.h"
+#include "HttpConnection.h"
+#include "MultipartUploadWriter.h"
+#include "FileSender.h"
+#include "StaticCache.h"
+#include "DirListing.h"
+#include "DirListStreamer.h"
+#include "IoThreadPool.h"
+#include "WorkerPool.h"
+#include "RtcBroadcaster.h"
+#include "JpegEncoder.h"
+#include "commontool/screenshooter.h"
 
 TcpServer::TcpServer(QObject *parent): QTcpServer(parent)
 {
@@ -43,6 +57,70 @@ TcpServer::TcpServer(QObject *parent): QTcpServer(parent)
     }
     m_rootDir = strRoot;
     qInfo() << "文件系统根目录映射：" << m_rootDir;
+    m_rtcBroadcaster = new RtcBroadcaster(this);
+    registerRoutes();
+
+    // HTTP连接分散到多个I/O线程，慢请求不再阻塞主线程上的其他客户端和 WebSocket 服务
+    m_ioThreads = new IoThreadPool(configuredThreadCount("ASRV_IO_THREADS", HTTP_IO_THREADS),
+                                   [this](QTcpSocket *socket) {
+                                       setupConnection(socket);
+                                   });
+}
+
+TcpServer::~TcpServer()
+{
+    // 先停止I/O线程，线程中的连接回调会访问本对象
+    SAFE_DELETE(m_ioThreads);
+}
+
+void TcpServer::registerRoutes()
+{
+    const QByteArrayList get  = {"GET"};
+    const QByteArrayList post = {"POST"};
+
+    // 上传（GET /upload 仍按目录浏览处理）
+    m_routes.addExact("/upload", post, [this](const QString &, QTcpSocket *socket, const HttpParser &request) {
+        doHandleUploadRequest(socket, request);
+    });
+
+    // www 静态资源
+    // TODO：区分普通js文件和服务器js资源
+    for (const QString &prefix : {QS("/js/"), QS("/css/"), QS("/img/"), QS("/fonts/")})
+    {
+        m_routes.addPrefix(prefix, get,
+                           [this](const QString &requestPath, QTcpSocket *socket, const HttpParser &request) {
+                               handleStaticResource(requestPath, socket, request);
+                           });
+    }
+
+    // 特殊请求
+    m_routes.addPrefix(REQ_SCREEN, get, [this](const QString &, QTcpSocket *socket, const HttpParser &) {
+        handleScreenRequest(socket);
+    });
+    m_routes.addPrefix(REQ_RTC, get, [this](const QString &, QTcpSocket *socket, const HttpParser &) {
+        handleRTC(socket);
+    });
+    m_routes.addPrefix(REQ_NOTIFY, get, [this](const QString &requestPath, QTcpSocket *socket, const HttpParser &) {
+        handleNotify(requestPath, socket);
+    });
+    m_routes.addPrefix(REQ_TEST, get, [this](const QString &, QTcpSocket *socket, const HttpParser &) {
+        handleTest(socket);
+    });
+    m_routes.addPrefix(REQ_BASH, get, [this](const QString &, QTcpSocket *socket, const HttpParser &) {
+        handleBash(socket);
+    });
+    m_routes.addPrefix(REQ_CTRL, get, [this](const QString &, QTcpSocket *socket, const HttpParser &) {
+        handleControl(socket);
+    });
+    m_routes.addPrefix(REQ_XTERM, get, [this](const QString &, QTcpSocket *socket, const HttpParser &) {
+        handleXterm(socket);
+    });
+    m_routes.addPrefix(REQ_SCREEN_CTRL, get, [this](const QString &, QTcpSocket *socket, const HttpParser &) {
+        handleScreenCtrl(socket);
+    });
+    m_routes.addPrefix(REQ_METRICS, get, [this](const QString &, QTcpSocket *socket, const HttpParser &) {
+        handleMetrics(socket);
+    });
 }
 
 void TcpServer::startListen(const QString &serverIp, const quint16 serverPort)
@@ -71,10 +149,22 @@ void TcpServer::startListen(const QString &serverIp, const quint16 serverPort)
 
 void TcpServer::incomingConnection(qintptr socketDescriptor)
 {
+    // 连接交给I/O线程，读写和请求处理都在该线程完成
+    if (m_ioThreads)
+    {
+        m_ioThreads->dispatch(socketDescriptor);
+        return;
+    }
+
     QTcpSocket *clientSocket = new QTcpSocket(this);
     clientSocket->setSocketDescriptor(socketDescriptor);
+    setupConnection(clientSocket);
+}
 
-    qDebug() << "新客户端连接：IP=" << clientSocket->peerAddress().toString() << "，Socket描述符=" << socketDescriptor;
+void TcpServer::setupConnection(QTcpSocket *clientSocket)
+{
+    qDebug() << "新客户端连接：IP=" << clientSocket->peerAddress().toString()
+             << "，Socket描述符=" << clientSocket->socketDescriptor();
 
     // ========== 关键1：配置Socket适配大文件 ==========
     clientSocket->setReadBufferSize(0);  // 禁用读缓冲区大小限制（0=无限制）
@@ -83,116 +173,141 @@ void TcpServer::incomingConnection(qintptr socketDescriptor)
     // 开启TCP保活，避免大文件上传时连接被断开
     clientSocket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
 
-    connect(clientSocket, &QTcpSocket::readyRead, this, [this, clientSocket]() {
+    // 每个连接的解析/长连接状态挂在socket下，随socket一起释放
+    // 以socket/connection为上下文：槽函数在socket所在的I/O线程执行
+    HttpConnection *connection = new HttpConnection(clientSocket);
+    connect(clientSocket, &QTcpSocket::readyRead, clientSocket, [this, clientSocket]() {
         handleClientRequest(clientSocket);
     });
+    // 异步响应结束后继续处理已缓存的流水线请求（排队执行，避免在响应函数内部递归）
+    // 以connection为上下文：连接释放后排队中的调用自动丢弃
+    connect(connection, &HttpConnection::responseFinished, connection, [this, connection]() {
+        processRequests(connection);
+    }, Qt::QueuedConnection);
     connect(clientSocket, &QTcpSocket::disconnected, clientSocket, &QTcpSocket::deleteLater);
-    connect(clientSocket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::error), this,
+    connect(clientSocket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::error), clientSocket,
             [clientSocket](QAbstractSocket::SocketError socketError) {
                 qWarning() << "客户端连接错误：" << socketError << clientSocket->errorString();
             });
 }
 
-void TcpServer::onSocketDisconnected()
-{
-    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
-    if (socket)
-    {
-        m_socketRequestCache.remove(socket);  // 移除对应socket的缓存
-        socket->deleteLater();                // 释放socket资源
-    }
-}
-
 void TcpServer::handleClientRequest(QTcpSocket *socket)
 {
-    if (!socket)
+    HttpConnection *connection = HttpConnection::fromSocket(socket);
+    if (!connection)
         return;
 
-    // 获取客户端信息
-    QHostAddress clientIp   = socket->peerAddress();
-    quint16      clientPort = socket->peerPort();
-    qDebug() << "客户端请求：IP=" << clientIp.toString() << "，Port=" << clientPort;
-
-    // 读取请求数据
-    QByteArray data = socket->readAll();
-    qDebug().noquote() << "收到请求数据：\n" << data;
-
-    // 1. 绑定断开连接的信号（防止内存泄漏）
-    connect(socket, &QTcpSocket::disconnected, this, &TcpServer::onSocketDisconnected, Qt::UniqueConnection);
-
-    // 2. 读取当前可用数据，追加到对应socket的缓存中
-    m_socketRequestCache[socket] += data;
-    QByteArray &requestData = m_socketRequestCache[socket];
-
-    // ========== 新增：优先处理上传请求（POST /upload） ==========
-    // 优先处理上传请求
-    QRegularExpression postUploadRe("^POST /upload HTTP/[0-9.]+");
-    if (postUploadRe.match(requestData).hasMatch())
+    // 新数据追加到连接的接收缓存；正在响应时只缓存，等响应结束后按顺序处理
+    QByteArray &buffer = connection->inBuffer();
+    if (buffer.isEmpty())
     {
-        // 调用检查函数，不再递归
-        checkUploadDataComplete(socket, requestData);
-        return;
+        buffer = socket->readAll();
     }
-
-    // 解析GET请求路径
-    QRegularExpression      re("^GET (/[^ ]*) HTTP/[0-9.]+");
-    QRegularExpressionMatch match       = re.match(requestData);
-    QString                 requestPath = match.captured(1);
-    requestPath                         = decodeFilePath(requestPath);
-
-    // 先处理静态资源请求
-    // TODO：区分普通js文件和服务器js资源
-    if (handleStaticResource(requestPath, socket) || handleScreenRequest(requestPath, socket) ||
-        handleRTC(requestPath, socket) || handleNotify(requestPath, socket) || handleTest(requestPath, socket) ||
-        handleBash(requestPath, socket) || handleControl(requestPath, socket) || handleXterm(requestPath, socket) ||
-        handleScreenCtrl(requestPath, socket))
+    else
     {
-        return;
+        buffer += socket->readAll();
     }
+    connection->restartIdleTimer();
+    processRequests(connection);
+}
 
-    bool isPreview = false;
-    // 1. 查找X-File-Action: preview（忽略大小写和空格）
-    if (requestData.contains("X-File-Action: preview") || requestData.contains("x-file-action: preview"))
+void TcpServer::processRequests(HttpConnection *connection)
+{
+    QTcpSocket *socket = connection->socket();
+    QByteArray &buffer = connection->inBuffer();
+    HttpParser &parser = connection->parser();
+    int         offset = 0;
+
+    // 同一连接上的流水线请求逐个解析、逐个响应，保证响应顺序与请求顺序一致
+    while (!connection->isBusy() && socket->state() == QAbstractSocket::ConnectedState)
     {
-        // 2. 验证密钥（可选，增强安全性）
-        if (requestData.contains("X-Preview-Key: your_secret_key_123"))
+        HttpParser::Result result;
+        offset += parser.feed(buffer, offset, result);
+
+        if (result == HttpParser::NeedMore)
         {
-            isPreview = true;
+            break;  // 数据未完整，等待下一次readyRead
         }
+        if (result == HttpParser::ParseError)
+        {
+            int errorCode = parser.errorCode();
+            qWarning() << "HTTP请求解析失败：IP=" << socket->peerAddress().toString() << "，状态码=" << errorCode;
+            // 解析出错后无法确定下一个请求的起点，响应后关闭连接
+            connection->closeAfterResponse();
+            connection->beginResponse();
+            MultipartUploadWriter *writer = connection->uploadWriter();
+            sendJsonResponse(socket, errorCode,
+                             (writer && writer->hasError()) ? writer->errorString() : QString("HTTP请求格式错误"));
+            break;
+        }
+        if (result == HttpParser::HeadersComplete)
+        {
+            // 上传请求体可能很大，请求头到达时先校验长度
+            if (parser.contentLength() > MAX_REQUEST_SIZE)
+            {
+                connection->closeAfterResponse();
+                connection->beginResponse();
+                sendJsonResponse(socket, 413, "请求体过大");
+                break;
+            }
+            // 上传请求：请求体边接收边写入文件，不在内存中缓存
+            if (parser.method() == "POST" && parser.path() == "/upload" && !prepareUpload(connection))
+            {
+                break;
+            }
+            continue;
+        }
+
+        // MessageComplete：完整请求已解析，响应结束前不再解析后续请求
+        qDebug() << "客户端请求：IP=" << socket->peerAddress().toString() << "，Port=" << socket->peerPort()
+                 << parser.method() << parser.target();
+        connection->beginResponse();
+        dispatchRequest(socket, parser);
     }
 
-    // 默认路径：根目录
-    if (requestPath.isEmpty() || requestPath == "/")
+    // 丢弃已解析的数据，未解析部分留给下一次处理
+    if (offset >= buffer.size())
     {
-        requestPath = "/";
+        buffer.clear();
     }
+    else if (offset > 0)
+    {
+        buffer.remove(0, offset);
+    }
+}
 
-    // 拼接服务端路径
-    QDir    rootDir(m_rootDir);
-    QString serverFilePath = rootDir.filePath(requestPath.mid(1));
-    serverFilePath.replace("\\", "/");
-    qDebug() << "映射到服务端路径：" << serverFilePath;
-
+// 普通页面响应（文件预览/目录列表/错误页面），在工作线程中生成
+struct PageResponse
+{
+    int        statusCode = 200;
+    QByteArray mimeType;
+    QByteArray content;
+    QByteArray etag;  // 目录列表按内容生成，其他响应为空
+    QByteArray extraHeaders;
+};
+
+static PageResponse buildPageResponse(const QString &serverFilePath,
+                                      const QString &rootDir,
+                                      const QString &requestPath,
+                                      bool           isPreview)
+{
+    PageResponse page;
     // 读取文件/生成目录列表
-    QByteArray content = readFileOrDir(serverFilePath, m_rootDir, requestPath, isPreview);
+    QByteArray content = readFileOrDir(serverFilePath, rootDir, requestPath, isPreview);
 
     // 构建HTTP响应
-    QByteArray response;
+    int statusCode = 200;
     if (content.contains("403 - 禁止访问"))
     {
-        response += "HTTP/1.1 403 Forbidden\r\n";
+        statusCode = 403;
     }
     else if (content.contains("404 - "))
     {
-        response += "HTTP/1.1 404 Not Found\r\n";
+        statusCode = 404;
     }
     else if (content.contains("500 - 文件不支持预览"))
     {
-        response += "HTTP/1.1 500 No Support Preview\r\n";
-    }
-    else
-    {
-        response += "HTTP/1.1 200 OK\r\n";
+        statusCode = 500;
     }
 
     // 修复：正确设置MIME类型
@@ -215,463 +330,556 @@ void TcpServer::handleClientRequest(QTcpSocket *socket)
     qDebug() << "请求路径是否为目录：" << fileInfo.isDir();
     qDebug() << "最终MIME类型：" << mimeType;
 
-    // 设置响应头
-    response += "Content-Type: " + mimeType.toUtf8() + "\r\n";
-    response += "Content-Length: " + QByteArray::number(content.size()) + "\r\n";
-    response += "Connection: close\r\n";
-    response += "Cache-Control: no-cache\r\n";
-    response += "\r\n";
-    response += content;
+    // 目录列表：按内容生成 ETag
+    page.extraHeaders = "Cache-Control: no-cache\r\n";
+    if (statusCode == 200 && fileInfo.isDir())
+    {
+        page.etag = "\"" + QCryptographicHash::hash(content, QCryptographicHash::Md5).toHex() + "\"";
+        page.extraHeaders += "ETag: " + page.etag + "\r\n";
+    }
 
-    // 发送响应
-    socket->write(response);
-    socket->flush();
-    socket->disconnectFromHost();
+    page.statusCode = statusCode;
+    page.mimeType   = mimeType.toUtf8();
+    page.content    = content;
+    return page;
 }
 
-bool TcpServer::handleStaticResource(const QString &requestPath, QTcpSocket *socket)
+// 发送工作线程生成的页面；目录列表内容未变化时只返回 304
+static void sendPageResponse(QTcpSocket         *socket,
+                             const PageResponse &page,
+                             bool                hasIfNoneMatch,
+                             const QByteArray   &ifNoneMatch)
 {
-    // 1. 定义静态资源前缀（所有以这些前缀开头的请求都视为静态资源）
-    const QStringList staticPrefixes  = {"/js/", "/css/", "/img/", "/fonts/"};
-    bool              isStaticRequest = false;
-    for (const QString &prefix : staticPrefixes)
+    if (!page.etag.isEmpty() && hasIfNoneMatch && etagMatches(ifNoneMatch, page.etag))
     {
-        if (requestPath.startsWith(prefix))
-        {
-            isStaticRequest = true;
-            break;
-        }
-    }
-    if (!isStaticRequest)
-    {
-        return false;  // 不是静态资源，返回false让后续逻辑处理
+        sendNotModified(socket, page.extraHeaders);
+        return;
     }
+    sendHttpResponse(socket, page.statusCode, page.mimeType, page.content, page.extraHeaders);
+}
 
-    // 2. 拼接静态资源的真实路径（安装目录/www + 请求路径）
-    QString realFilePath = QCoreApplication::applicationDirPath() + "/www" + requestPath;
-    QFile   file(realFilePath);
+// 目录列表请求在工作线程中的处理结果
+struct DirListResult
+{
+    enum Kind
+    {
+        Page,   // 完整页面（小目录、HTTP/1.0、索引读取失败）
+        Json,   // 分页 JSON（statusCode 非 200 时为错误信息）
+        Stream  // 大目录：回到socket所在线程交给 DirListStreamer 分批输出
+    };
+    Kind         kind       = Page;
+    int          statusCode = 200;
+    QString      errorMessage;
+    QByteArray   json;
+    PageResponse page;
+    DirIndexPtr  index;
+    QByteArray   pageHead;
+    QByteArray   pageTail;
+};
+
+// 目录列表：?format=json&cursor=&limit= 返回分页 JSON；目录项较多时 HTML 交给分批输出（在工作线程中调用）
+static DirListResult buildDirListResult(const QString &dirPath,
+                                        const QString &rootDir,
+                                        const QString &requestPath,
+                                        const QString &queryString,
+                                        bool           canStream)
+{
+    DirListResult result;
+    QUrlQuery     query(queryString);
+    bool          isJson = (query.queryItemValue("format") == "json");
 
-    // 3. 打开文件并读取内容
-    if (!file.open(QIODevice::ReadOnly))
+    // 排序索引按目录 mtime 缓存，翻页/刷新时不再重新读取和排序整个目录
+    DirIndexPtr index = loadDirIndex(dirPath);
+    if (!index)
     {
-        // 文件不存在，返回404响应
-        QByteArray response = "HTTP/1.1 404 Not Found\r\n";
-        response += "Content-Type: text/plain; charset=UTF-8\r\n";
-        response += "Connection: close\r\n\r\n";
-        response += "File not found: " + requestPath.toUtf8();
-        socket->write(response);
-        socket->flush();
-        socket->disconnectFromHost();
-        return true;
+        if (isJson)
+        {
+            result.kind         = DirListResult::Json;
+            result.statusCode   = 404;
+            result.errorMessage = "目录不存在或无访问权限：" + requestPath;
+            return result;
+        }
+        result.page = buildPageResponse(dirPath, rootDir, requestPath, false);
+        return result;
     }
+    const int total = index->entries.size();
 
-    QByteArray fileContent = file.readAll();
-    file.close();
-
-    // 特殊处理：替换占位符
-    QString fileName = QFileInfo(realFilePath).fileName();
-    if (fileName == "bash.js" || fileName == "xtermpage.js")
+    // 1. 分页 JSON：cursor 为上一页最后一项，翻页期间目录有增删也不会重复/遗漏
+    if (isJson)
     {
-        QMap<QString, QString> replaceMap;
-        QString                strWsAddr = "ws://" + getLocalIpv4() + ":" + QString::number(Server::getWsPort());
-        replaceMap["WS_HOST"]            = strWsAddr;
-        QString contentStr               = QString(fileContent);
-        for (auto it = replaceMap.constBegin(); it != replaceMap.constEnd(); ++it)
+        result.kind = DirListResult::Json;
+        int begin   = 0;
+        if (query.hasQueryItem("cursor") && !query.queryItemValue("cursor").isEmpty())
         {
-            contentStr.replace("{{" + it.key() + "}}", it.value());
+            DirEntry last;
+            if (!decodeDirCursor(query.queryItemValue("cursor").toLatin1(), last))
+            {
+                result.statusCode   = 400;
+                result.errorMessage = "无效的分页游标";
+                return result;
+            }
+            begin = dirIndexUpperBound(*index, last.isDir, last.name);
         }
+        bool ok    = false;
+        int  limit = query.queryItemValue("limit").toInt(&ok);
+        if (!ok || limit <= 0)
+        {
+            limit = DIR_LIST_PAGE_SIZE;
+        }
+        limit   = qMin(limit, DIR_LIST_PAGE_MAX);
+        int end = qMin(begin + limit, total);
 
-        fileContent = contentStr.toUtf8();
-    }
-    else if(fileName == "screen_ctrl.js")
-    {
-        QMap<QString, QString> replaceMap;
-        QString                strWsAddr = "ws://" + getLocalIpv4() + ":" + QString::number(Server::getScreenServerPort());
-        replaceMap["WS_HOST"]            = strWsAddr;
-        QString contentStr               = QString(fileContent);
-        for (auto it = replaceMap.constBegin(); it != replaceMap.constEnd(); ++it)
+        DirListRowWriter writer(dirPath, rootDir, requestPath);
+        QJsonArray       entries;
+        for (int i = begin; i < end; ++i)
         {
-            contentStr.replace("{{" + it.key() + "}}", it.value());
+            const DirEntry &entry = index->entries.at(i);
+            QFileInfo       fileInfo(dirPath + "/" + entry.name);
+            QJsonObject     item;
+            item["name"]  = entry.name;
+            item["isDir"] = entry.isDir;
+            item["size"]  = entry.isDir ? 0 : static_cast<double>(fileInfo.size());
+            item["mtime"] = static_cast<double>(fileInfo.lastModified().toMSecsSinceEpoch());
+            item["path"]  = QString::fromUtf8(writer.filePath(entry.name));
+            entries.append(item);
         }
 
-        fileContent = contentStr.toUtf8();
+        QJsonObject responseJson;
+        responseJson["success"]    = true;
+        responseJson["path"]       = requestPath;
+        responseJson["total"]      = total;
+        responseJson["entries"]    = entries;
+        responseJson["nextCursor"] = QJsonValue(QJsonValue::Null);
+        if (end < total)
+        {
+            responseJson["nextCursor"] = QString::fromLatin1(encodeDirCursor(index->entries.at(end - 1)));
+        }
+        result.json = QJsonDocument(responseJson).toJson(QJsonDocument::Compact);
+        return result;
     }
 
-    // 4. 根据文件后缀获取MIME类型
-    QString contentType = getMimeType(requestPath);
-
-    // 5. 构建HTTP响应
-    QByteArray response = "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: " + contentType.toUtf8() + "\r\n";
-    response += "Content-Length: " + QByteArray::number(fileContent.size()) + "\r\n";
-    response += "Connection: close\r\n";
-    // 可选：添加缓存头，提升性能
-    response += "Cache-Control: max-age=86400\r\n\r\n";
-    response += fileContent;
-
-    // 6. 发送响应
-    socket->write(response);
-    socket->flush();
-    socket->disconnectFromHost();
-
-    return true;
+    // 2. 大目录 HTML：chunked 分批输出（HTTP/1.0 不支持 chunked，仍一次生成）
+    if (total < DIR_LIST_STREAM_MIN || !canStream)
+    {
+        result.page = buildPageResponse(dirPath, rootDir, requestPath, false);
+        return result;
+    }
+    result.kind  = DirListResult::Stream;
+    result.index = index;
+    dirListPageParts(dirPath, rootDir, requestPath, result.pageHead, result.pageTail);
+    return result;
 }
 
-// 处理上传请求
-void TcpServer::handleUploadRequest(QTcpSocket *socket, const QByteArray &requestData)
+void TcpServer::dispatchRequest(QTcpSocket *socket, const HttpParser &request)
 {
-    // 3. 优先判断是否为上传请求（POST /upload）
-    QRegularExpression postUploadRe("^POST /upload HTTP/[0-9.]+");
-    if (postUploadRe.match(requestData).hasMatch())
-    {
-        // 3.1 解析Content-Length，判断数据是否完整
-        QRegularExpression contentLengthRe(R"(Content-Length:\s*(\d+))", QRegularExpression::CaseInsensitiveOption);
-        QRegularExpressionMatch clMatch = contentLengthRe.match(requestData);
-        if (clMatch.hasMatch())
-        {
-            qint64 expectedLength = clMatch.captured(1).toLongLong();
-            int    headerEndPos   = requestData.indexOf("\r\n\r\n");
+    QString requestPath = decodeFilePath(QString::fromUtf8(request.path()));
 
-            // 计算已接收的请求体长度
-            qint64 receivedBodyLength = requestData.size() - (headerEndPos + 4);
-
-            // 数据完整：处理上传请求
-            if (headerEndPos != -1 && receivedBodyLength >= expectedLength)
-            {
-                qDebug() << "上传请求数据完整，总长度：" << requestData.size();
-                handleUploadRequest(socket, requestData);
-                m_socketRequestCache.remove(socket);  // 清理缓存
-                return;
-            }
+    // 特殊请求和静态资源：路由表按路径查表分发
+    bool               methodAllowed = true;
+    RouteTable::Route *route         = m_routes.match(request.method(), requestPath, methodAllowed);
+    if (route)
+    {
+        if (!methodAllowed)
+        {
+            sendJsonResponse(socket, 405, "不支持的请求方法：" + QString::fromLatin1(request.method()));
+            return;
         }
-        // 3.2  检查Multipart结束标记（--boundary--）
-        QRegularExpression      boundaryRe(R"(Content-Type:\s*multipart/form-data;\s*boundary=([^\r\n;]+))",
-                                           QRegularExpression::CaseInsensitiveOption);
-        QRegularExpressionMatch boundaryMatch = boundaryRe.match(requestData);
-        if (boundaryMatch.hasMatch())
+        route->metrics.requests.fetchAndAddRelaxed(1);
+        if (HttpConnection *connection = HttpConnection::fromSocket(socket))
         {
-            QString    boundary  = boundaryMatch.captured(1);
-            QByteArray endMarker = QString("--%1--\r\n").arg(boundary).toUtf8();
-            if (requestData.contains(endMarker))
-            {
-                handleUploadRequest(socket, requestData);
-                m_socketRequestCache.remove(socket);
-                return;
-            }
+            connection->setRouteMetrics(&route->metrics);
         }
-        // 数据未完整，等待下一次readyRead
-        qDebug() << "上传请求数据未完整，当前接收长度：" << requestData.size();
+        route->handler(requestPath, socket, request);
         return;
     }
-}
-
-bool TcpServer::checkUploadDataComplete(QTcpSocket *socket, const QByteArray &requestData)
-{
-    // 1. 解析Content-Length，判断数据是否完整
-    QRegularExpression      contentLengthRe(R"(Content-Length:\s*(\d+))", QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatch clMatch = contentLengthRe.match(requestData);
-    if (clMatch.hasMatch())
+    if (request.method() != "GET")
     {
-        qint64 expectedLength = clMatch.captured(1).toLongLong();
-        int    headerEndPos   = requestData.indexOf("\r\n\r\n");
-
-        if (headerEndPos == -1)
-            return false;
-
-        // 计算已接收的请求体长度
-        qint64 receivedBodyLength = requestData.size() - (headerEndPos + 4);
+        sendJsonResponse(socket, 405, "不支持的请求方法：" + QString::fromLatin1(request.method()));
+        return;
+    }
 
-        // 数据完整：调用实际处理函数
-        if (receivedBodyLength >= expectedLength)
+    bool isPreview = false;
+    // 1. 查找X-File-Action: preview（请求头名称已统一为小写）
+    if (request.header("x-file-action") == "preview")
+    {
+        // 2. 验证密钥（可选，增强安全性）
+        if (request.header("x-preview-key") == "your_secret_key_123")
         {
-            qDebug() << "上传请求数据完整，总长度：" << requestData.size();
-            doHandleUploadRequest(socket, requestData);
-            m_socketRequestCache.remove(socket);  // 清理缓存
-            return true;
+            isPreview = true;
         }
     }
 
-    // 2. 兜底：检查Multipart结束标记（--boundary--）
-    QRegularExpression      boundaryRe(R"(Content-Type:\s*multipart/form-data;\s*boundary=([^\r\n;]+))",
-                                       QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatch boundaryMatch = boundaryRe.match(requestData);
-    if (boundaryMatch.hasMatch())
+    // 默认路径：根目录
+    if (requestPath.isEmpty() || requestPath == "/")
     {
-        QString boundary = boundaryMatch.captured(1);
-        QByteArray endMarker = QString("--%1--").arg(boundary).toUtf8();  // 注意：结束标记可能没有最后的\r\n
-        if (requestData.contains(endMarker))
-        {
-            doHandleUploadRequest(socket, requestData);
-            m_socketRequestCache.remove(socket);
-            return true;
-        }
+        requestPath = "/";
     }
 
-    // 数据未完整
-    qDebug() << "上传请求数据未完整，当前接收长度：" << requestData.size();
-    return false;
-}
+    // 拼接服务端路径
+    QDir    rootDir(m_rootDir);
+    QString serverFilePath = rootDir.filePath(requestPath.mid(1));
+    serverFilePath.replace("\\", "/");
+    qDebug() << "映射到服务端路径：" << serverFilePath;
 
-void TcpServer::doHandleUploadRequest(QTcpSocket *socket, const QByteArray &requestData)
-{
-    // ========== 1. 提取请求体 ==========
-    int headerEndPos = requestData.indexOf("\r\n\r\n");
-    if (headerEndPos == -1)
+    // 普通文件直接从文件描述符发送，不读入内存
+    if (!isPreview && handleFileDownload(socket, request, serverFilePath))
     {
-        sendJsonResponse(socket, 400, "HTTP请求格式错误：未找到请求头与体的分隔符");
         return;
     }
-
-    QByteArray bodyData = requestData.mid(headerEndPos + 4);
-    if (bodyData.isEmpty())
+    // 目录分页 JSON / 大目录分批输出
+    if (!isPreview && handleDirListing(socket, request, serverFilePath, requestPath))
     {
-        sendJsonResponse(socket, 400, "请求体为空");
         return;
     }
 
-    // ========== 2. 解析Boundary ==========
-    QRegularExpression      boundaryRe(R"(Content-Type:\s*multipart/form-data;\s*boundary=([^\r\n;]+))",
-                                       QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatch boundaryMatch = boundaryRe.match(requestData);
-    if (!boundaryMatch.hasMatch())
+    // 读取文件/生成目录列表：磁盘读取和页面渲染放到工作线程，I/O线程继续处理其他连接
+    // 连接在响应结束前保持 busy，流水线上的后续请求仍按顺序响应
+    QString    rootDirPath    = m_rootDir;
+    bool       hasIfNoneMatch = request.hasHeader("if-none-match");
+    QByteArray ifNoneMatch    = request.header("if-none-match");
+    WorkerPool::run<PageResponse>(
+        socket,
+        [serverFilePath, rootDirPath, requestPath, isPreview]() {
+            return buildPageResponse(serverFilePath, rootDirPath, requestPath, isPreview);
+        },
+        [socket, hasIfNoneMatch, ifNoneMatch](const PageResponse &page) {
+            sendPageResponse(socket, page, hasIfNoneMatch, ifNoneMatch);
+        });
+}
+
+bool TcpServer::handleFileDownload(QTcpSocket *socket, const HttpParser &request, const QString &filePath)
+{
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.isFile() || !isValidPath(filePath, m_rootDir))
     {
-        sendJsonResponse(socket, 400, "缺少multipart边界符");
-        return;
+        return false;  // 目录/非法路径/不存在的文件交给 readFileOrDir 生成页面
     }
 
-    QString boundary = boundaryMatch.captured(1);
-    qDebug() << "解析到Boundary：" << boundary;
-    qDebug() << "bodyData长度：" << bodyData.size();
-
-    // ========== 3. 解析表单数据 ==========
-    QMap<QString, QString>            formFields;
-    QList<QPair<QString, QByteArray>> fileDataList;
+    qint64     fileSize     = fileInfo.size();
+    QDateTime  lastModified = fileInfo.lastModified();
+    QByteArray etag         = fileETag(fileInfo);
+    // 校验头：no-cache 表示每次都向服务端确认，未修改时只返回 304
+    QByteArray validators = "ETag: " + etag + "\r\n";
+    validators += "Last-Modified: " + httpDate(lastModified) + "\r\n";
+    validators += "Cache-Control: no-cache\r\n";
 
-    QByteArray        boundaryBytes = QString("--" + boundary).toUtf8();
-    QList<QByteArray> parts;
-    int               pos         = 0;
-    int               boundaryLen = boundaryBytes.length();
-    while (pos < bodyData.length())
+    // 1. 条件请求：If-None-Match 优先于 If-Modified-Since
+    bool notModified = false;
+    if (request.hasHeader("if-none-match"))
     {
-        int nextPos = bodyData.indexOf(boundaryBytes, pos);
-        if (nextPos == -1)
-            break;
-        QByteArray part = bodyData.mid(pos, nextPos - pos);
-        parts.append(part);
-        pos = nextPos + boundaryLen;
+        notModified = etagMatches(request.header("if-none-match"), etag);
     }
-
-    for (QByteArray &part : parts)
+    else if (request.hasHeader("if-modified-since"))
     {
-        part = part.trimmed();
-        if (part.isEmpty() || part == "--")
-            continue;
-
-        int headerEnd = part.indexOf("\r\n\r\n");
-        if (headerEnd == -1)
-            continue;
-
-        QByteArray header  = part.left(headerEnd);
-        QByteArray content = part.mid(headerEnd + 4);
+        QDateTime since = parseHttpDate(request.header("if-modified-since"));
+        notModified     = since.isValid() && lastModified.toSecsSinceEpoch() <= since.toSecsSinceEpoch();
+    }
+    if (notModified)
+    {
+        sendNotModified(socket, validators);
+        return true;
+    }
 
-        // 移除内容末尾的结束标记
-        int contentEnd = content.lastIndexOf("\r\n--");
-        if (contentEnd != -1)
+    // 2. Range 请求（断点续传、视频拖动）；If-Range 不匹配时忽略 Range 返回完整文件
+    QVector<QPair<qint64, qint64>> ranges;
+    bool useRange = request.hasHeader("range") && parseRangeHeader(request.header("range"), fileSize, ranges);
+    if (useRange && request.hasHeader("if-range"))
+    {
+        QByteArray ifRange = request.header("if-range").trimmed();
+        if (ifRange.startsWith('"') || ifRange.startsWith("W/"))
+        {
+            useRange = (ifRange == etag);  // If-Range 要求强比较
+        }
+        else
         {
-            content = content.left(contentEnd);
+            QDateTime date = parseHttpDate(ifRange);
+            useRange       = date.isValid() && lastModified.toSecsSinceEpoch() <= date.toSecsSinceEpoch();
         }
+    }
 
-        // 解析字段名和文件名
-        QRegularExpression nameRe("name\\s*=\\s*\"([^\"]+)\"", QRegularExpression::CaseInsensitiveOption);
-        QRegularExpression filenameRe("filename\\s*=\\s*\"([^\"]+)\"", QRegularExpression::CaseInsensitiveOption);
+    QByteArray mimeType     = getMimeType(filePath).toUtf8();
+    QByteArray extraHeaders = "Accept-Ranges: bytes\r\n" + validators;
+    QByteArray totalSize    = QByteArray::number(fileSize);
 
-        QRegularExpressionMatch nameMatch     = nameRe.match(header);
-        QRegularExpressionMatch filenameMatch = filenameRe.match(header);
+    // 完整文件
+    if (!useRange)
+    {
+        QByteArray header = httpResponseHeader(socket, 200, mimeType, fileSize, extraHeaders);
+        return FileSender::send(socket, header, filePath, 0, fileSize);
+    }
 
-        if (!nameMatch.hasMatch())
-            continue;
+    // 没有可满足的范围
+    if (ranges.isEmpty())
+    {
+        sendHttpResponse(socket, 416, "text/plain; charset=UTF-8", "Requested Range Not Satisfiable",
+                         "Content-Range: bytes */" + totalSize + "\r\n" + extraHeaders);
+        return true;
+    }
 
-        QString fieldName = nameMatch.captured(1);
-        QString fileName  = filenameMatch.hasMatch() ? filenameMatch.captured(1) : QString();
+    // 单个范围：206 + Content-Range
+    if (ranges.size() == 1)
+    {
+        qint64 first = ranges.first().first;
+        qint64 last  = ranges.first().second;
+        extraHeaders += "Content-Range: bytes " + QByteArray::number(first) + "-" + QByteArray::number(last) + "/" +
+                        totalSize + "\r\n";
+        QByteArray header = httpResponseHeader(socket, 206, mimeType, last - first + 1, extraHeaders);
+        return FileSender::send(socket, header, filePath, first, last - first + 1);
+    }
+
+    // 多个范围：multipart/byteranges，每个部分带自己的 Content-Range
+    QByteArray boundary = "asrv_" + QByteArray::number(QDateTime::currentMSecsSinceEpoch(), 16) +
+                          QByteArray::number(qrand(), 16);
+    QVector<FileSender::Segment> segments;
+    qint64                       contentLength = 0;
+    for (const auto &range : ranges)
+    {
+        FileSender::Segment segment;
+        segment.prefix = "\r\n--" + boundary + "\r\n";
+        segment.prefix += "Content-Type: " + mimeType + "\r\n";
+        segment.prefix += "Content-Range: bytes " + QByteArray::number(range.first) + "-" +
+                          QByteArray::number(range.second) + "/" + totalSize + "\r\n\r\n";
+        segment.offset = range.first;
+        segment.length = range.second - range.first + 1;
+        contentLength += segment.prefix.size() + segment.length;
+        segments.append(segment);
+    }
+    FileSender::Segment closing;
+    closing.prefix = "\r\n--" + boundary + "--\r\n";
+    contentLength += closing.prefix.size();
+    segments.append(closing);
+
+    QByteArray header =
+        httpResponseHeader(socket, 206, "multipart/byteranges; boundary=" + boundary, contentLength, extraHeaders);
+    return FileSender::send(socket, header, filePath, segments);
+}
 
-        if (!fileName.isEmpty())
-        {
-            fileDataList.append(qMakePair(fileName, content));
-        }
-        else
+bool TcpServer::handleDirListing(QTcpSocket       *socket,
+                                 const HttpParser &request,
+                                 const QString    &dirPath,
+                                 const QString    &requestPath)
+{
+    QString queryString = QString::fromUtf8(request.query());
+    bool    isJson      = (QUrlQuery(queryString).queryItemValue("format") == "json");
+    if (!QFileInfo(dirPath).isDir() || !isValidPath(dirPath, m_rootDir))
+    {
+        if (isJson)
         {
-            formFields.insert(fieldName, QString::fromUtf8(content));
+            sendJsonResponse(socket, 404, "目录不存在或无访问权限：" + requestPath);
+            return true;
         }
-    }
+        return false;  // 交给 readFileOrDir 生成 403/404 页面
+    }
+
+    // 读取索引（缓存未命中时 readdir + 排序）和生成 JSON/页面都在工作线程完成，I/O线程继续处理其他连接
+    // 只有生成好的数据（或大目录的分批发送器）回到socket所在线程
+    QString    rootDirPath    = m_rootDir;
+    bool       canStream      = request.versionMinor() >= 1;
+    bool       hasIfNoneMatch = request.hasHeader("if-none-match");
+    QByteArray ifNoneMatch    = request.header("if-none-match");
+    WorkerPool::run<DirListResult>(
+        socket,
+        [dirPath, rootDirPath, requestPath, queryString, canStream]() {
+            return buildDirListResult(dirPath, rootDirPath, requestPath, queryString, canStream);
+        },
+        [socket, dirPath, rootDirPath, requestPath, hasIfNoneMatch, ifNoneMatch](const DirListResult &result) {
+            switch (result.kind)
+            {
+                case DirListResult::Json:
+                    if (result.statusCode != 200)
+                    {
+                        sendJsonResponse(socket, result.statusCode, result.errorMessage);
+                        return;
+                    }
+                    sendHttpResponse(socket, 200, "application/json; charset=UTF-8", result.json,
+                                     "Cache-Control: no-cache\r\n");
+                    return;
+                case DirListResult::Stream:
+                {
+                    QByteArray header =
+                        httpResponseHeader(socket, 200, "text/html; charset=UTF-8", -1, "Cache-Control: no-cache\r\n");
+                    DirListStreamer::send(socket, header, result.pageHead, result.pageTail, result.index,
+                                          DirListRowWriter(dirPath, rootDirPath, requestPath));
+                    return;
+                }
+                case DirListResult::Page:
+                    sendPageResponse(socket, result.page, hasIfNoneMatch, ifNoneMatch);
+                    return;
+            }
+        });
+    return true;
+}
 
-    if (formFields.isEmpty() && fileDataList.isEmpty())
+void TcpServer::handleStaticResource(const QString &requestPath, QTcpSocket *socket, const HttpParser &request)
+{
+    // 1. 静态资源前缀（/js/、/css/、/img/、/fonts/）已在路由表中注册
+    // 2. 从www资源缓存中查找（启动时已加载，占位符已替换）
+    StaticCache::EntryPtr entry = StaticCache::instance()->find(requestPath);
+    if (!entry)
     {
-        sendJsonResponse(socket, 400, "表单解析失败：无有效字段或文件");
+        // 文件不存在，返回404响应
+        sendHttpResponse(socket, 404, "text/plain; charset=UTF-8", "File not found: " + requestPath.toUtf8());
         return;
     }
 
-    // ========== 4. 处理上传路径 ==========
-    QString uploadDir = m_rootDir + "/upload";
-
-    // 创建上传目录
-    QDir dir;
-    if (!dir.exists(uploadDir) && !dir.mkpath(uploadDir))
+    // 3. 内容未变化：304
+    QByteArray extraHeaders = "ETag: " + entry->etag + "\r\n";
+    // 可选：添加缓存头，提升性能
+    extraHeaders += "Cache-Control: max-age=86400\r\n";
+    if (request.hasHeader("if-none-match") && etagMatches(request.header("if-none-match"), entry->etag))
     {
-        sendJsonResponse(socket, 500, "创建上传目录失败");
+        sendNotModified(socket, extraHeaders);
         return;
     }
 
-    // ========== 5. 写入文件 ==========
-    bool    uploadSuccess = true;
-    QString errorMsg;
-
-    for (const auto &filePair : fileDataList)
+    // 4. 按 Accept-Encoding 选择预压缩版本
+    const QByteArray *body = &entry->data;
+    if (!entry->gzip.isEmpty() || !entry->brotli.isEmpty())
     {
-        QString    fileName    = filePair.first;
-        QByteArray fileContent = filePair.second;
-
-        // 处理中文文件名
-        fileName = QUrl::fromPercentEncoding(fileName.toUtf8());
-        if (fileName.isEmpty())
+        extraHeaders += "Vary: Accept-Encoding\r\n";
+        QByteArray acceptEncoding = request.header("accept-encoding");
+        if (!entry->brotli.isEmpty() && acceptsEncoding(acceptEncoding, "br"))
         {
-            uploadSuccess = false;
-            errorMsg      = "文件名不能为空";
-            break;
+            body = &entry->brotli;
+            extraHeaders += "Content-Encoding: br\r\n";
         }
-
-        QString filePath = uploadDir + "/" + fileName;
-        QFile   file(filePath);
-
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        else if (!entry->gzip.isEmpty() && acceptsEncoding(acceptEncoding, "gzip"))
         {
-            uploadSuccess = false;
-            errorMsg      = "文件打开失败：" + file.errorString();
-            break;
+            body = &entry->gzip;
+            extraHeaders += "Content-Encoding: gzip\r\n";
         }
+    }
 
-        qint64 written = file.write(fileContent);
-        file.close();
+    // 5. 发送响应
+    sendHttpResponse(socket, 200, entry->mimeType, *body, extraHeaders);
+}
 
-        if (written != fileContent.size())
-        {
-            uploadSuccess = false;
-            errorMsg      = "文件写入不完整";
-            QFile::remove(filePath);
-            break;
-        }
+bool TcpServer::prepareUpload(HttpConnection *connection)
+{
+    QTcpSocket *socket = connection->socket();
+    HttpParser &parser = connection->parser();
+
+    // 出错时请求体尚未读取，响应后必须关闭连接
+    auto reject = [connection, socket](int statusCode, const QString &message) {
+        connection->closeAfterResponse();
+        connection->beginResponse();
+        sendJsonResponse(socket, statusCode, message);
+        return false;
+    };
 
-        qDebug() << "文件上传成功：" << filePath;
+    // ========== 1. 解析Boundary ==========
+    QRegularExpression      boundaryRe(R"(multipart/form-data;\s*boundary=("?)([^\r\n;"]+)\1)",
+                                       QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch boundaryMatch = boundaryRe.match(QString::fromLatin1(parser.header("content-type")));
+    if (!boundaryMatch.hasMatch())
+    {
+        return reject(400, "缺少multipart边界符");
     }
+    QByteArray boundary = boundaryMatch.captured(2).toLatin1();
+    qDebug() << "解析到Boundary：" << boundary;
 
-    // ========== 6. 发送响应 ==========
-    if (uploadSuccess)
+    // ========== 2. 创建上传目录 ==========
+    QString uploadDir = m_rootDir + "/upload";
+    QDir    dir;
+    if (!dir.exists(uploadDir) && !dir.mkpath(uploadDir))
     {
-        sendJsonResponse(socket, 200, "文件上传成功");
+        return reject(500, "创建上传目录失败");
     }
-    else
+
+    // ========== 3. 接管请求体 ==========
+    MultipartUploadWriter *writer = new MultipartUploadWriter(boundary, uploadDir);
+    connection->setUploadWriter(writer);
+    parser.setBodyHandler([writer](const char *data, int size) {
+        return writer->write(data, size);
+    });
+
+    // 客户端等待 100 Continue 后才发送请求体（curl 上传大文件时默认如此）
+    if (parser.header("expect").toLower() == "100-continue")
     {
-        sendJsonResponse(socket, 500, errorMsg);
+        socket->write("HTTP/1.1 100 Continue\r\n\r\n");
     }
+    return true;
 }
 
-bool TcpServer::handleScreenRequest(const QString &requestPath, QTcpSocket *socket)
+void TcpServer::doHandleUploadRequest(QTcpSocket *socket, const HttpParser &request)
 {
-    // 1. 校验请求路径是否匹配截屏指令
-    if (!requestPath.startsWith(REQ_SCREEN))
+    HttpConnection        *connection = HttpConnection::fromSocket(socket);
+    MultipartUploadWriter *writer     = connection ? connection->uploadWriter() : nullptr;
+    if (!writer)
     {
-        return false;  // 非截屏请求，返回false交给后续逻辑处理
+        sendJsonResponse(socket, 400, "缺少multipart边界符");
+        return;
     }
-
-    // 2. 服务端截屏核心逻辑（兼容多屏幕场景）
-    QImage screenshotImg;
-    // 获取系统所有屏幕
-    QList<QScreen *> screens = QGuiApplication::screens();
-    if (screens.isEmpty())
+    if (request.bodyReceived() == 0)
     {
-        // 无可用屏幕，返回500错误
-        sendJsonResponse(socket, 500, "No available screen to capture");
-        return true;
+        sendJsonResponse(socket, 400, "请求体为空");
+        return;
     }
 
-    // 方式1：截取主屏幕（单屏幕场景）
-    //    QScreen *primaryScreen = QGuiApplication::primaryScreen();
-    //    screenshotImg          = primaryScreen->grabWindow(0).toImage();  // 0表示截取整个屏幕
-
-    // 方式2：截取所有屏幕拼接（多屏幕场景，可选）
-    QPixmap totalScreenshot;
-    int     totalWidth = 0, totalHeight = 0;
-    for (QScreen *screen : screens)
+    // 请求体已在接收过程中写入文件，这里只检查结果
+    if (!writer->finish())
     {
-        totalWidth += screen->geometry().width();
-        totalHeight = qMax(totalHeight, screen->geometry().height());
-    }
-    totalScreenshot = QPixmap(totalWidth, totalHeight);
-    QPainter painter(&totalScreenshot);
-    int      xOffset = 0;
-    for (QScreen *screen : screens)
-    {
-        QPixmap screenPix = screen->grabWindow(0);
-        painter.drawPixmap(xOffset, 0, screenPix);
-        xOffset += screen->geometry().width();
+        sendJsonResponse(socket, 500, writer->errorString());
+        return;
     }
-    screenshotImg = totalScreenshot.toImage();
-
-    // 3. 校验截屏是否成功
-    if (screenshotImg.isNull())
+    if (writer->formFields().isEmpty() && writer->savedFiles().isEmpty())
     {
-        sendJsonResponse(socket, 500, "Failed to capture screen image");
-        return true;
+        sendJsonResponse(socket, 400, "表单解析失败：无有效字段或文件");
+        return;
     }
 
-    // 4. 将截屏图片转为Base64编码（嵌入HTML用）
-    QByteArray imageData;
-    QBuffer    buffer(&imageData);
-    buffer.open(QIODevice::WriteOnly);
-    // 保存为JPG格式（体积更小），可改为PNG（质量更高）
-    screenshotImg.save(&buffer, "JPG", 85);  // 85为JPG质量（0-100）
-    QString base64Img = QString(imageData.toBase64());
+    qDebug() << "上传完成：文件数=" << writer->savedFiles().size() << "，请求体长度=" << request.bodyReceived();
+    sendJsonResponse(socket, 200, "文件上传成功");
+}
 
-    // 5. 构建包含Base64图片的HTML响应
-    QMap<QString, QString> replaceMap;
-    replaceMap["BASE64_IMG"] = base64Img;
-    QString htmlContent      = QString::fromUtf8(readTemplate("screen.html", replaceMap));
-
-    // 6. 构建HTTP响应
-    QByteArray  response;
-    QTextStream respStream(&response);
-    respStream << "HTTP/1.1 200 OK\r\n";
-    respStream << "Content-Type: text/html; charset=UTF-8\r\n";
-    respStream << "Content-Length: " << htmlContent.size() << "\r\n";
-    respStream << "Connection: close\r\n\r\n";
-    respStream << htmlContent;
-
-    // 7. 发送响应并关闭连接
-    if (socket->isWritable())
-    {
-        socket->write(response);
-        socket->flush();  // 强制刷出缓冲区
-    }
-    socket->disconnectFromHost();
+void TcpServer::handleScreenRequest(QTcpSocket *socket)
+{
+    // 2. 截屏 + JPG编码 + 页面渲染都在工作线程完成，完成后回到socket所在线程发送
+    // QScreen/QPixmap 只能在GUI线程使用，这里改用 ScreenShooter（X11/DRM，多线程安全，根窗口覆盖所有屏幕）
+    WorkerPool::run<QByteArray>(
+        socket,
+        []() -> QByteArray {
+            // 截屏线程在运行时直接取它的最新帧，否则同步截屏（都返回 QImage，不经过 QPixmap）
+            QImage screenshotImg = ScreenShooter::instance()->latestFrame();
+            if (screenshotImg.isNull())
+            {
+                screenshotImg = ScreenShooter::instance()->captureImage();
+            }
+            // 3. 校验截屏是否成功
+            if (screenshotImg.isNull())
+            {
+                return QByteArray();
+            }
 
-    return true;
+            // 4. 将截屏图片转为Base64编码（嵌入HTML用）
+            // 保存为JPG格式（体积更小），85为JPG质量（0-100）
+            QByteArray imageData = JpegEncoder::forCurrentThread()->encode(screenshotImg, 85);
+
+            // 5. 构建包含Base64图片的HTML响应
+            QHash<QByteArray, QByteArray> variables;
+            variables["BASE64_IMG"] = imageData.toBase64();
+            return compiledTemplate("screen.html").render(variables);
+        },
+        [socket](const QByteArray &htmlContent) {
+            if (htmlContent.isEmpty())
+            {
+                sendJsonResponse(socket, 500, "Failed to capture screen image");
+                return;
+            }
+            // 6. 发送响应（Content-Length 按字节数计算）
+            sendHttpResponse(socket, 200, "text/html; charset=UTF-8", htmlContent);
+        });
 }
 
-bool TcpServer::handleRTC(const QString &requestPath, QTcpSocket *socket)
+void TcpServer::handleRTC(QTcpSocket *socket)
 {
-    // 1. 校验请求路径是否匹配截屏指令
-    if (!requestPath.startsWith(REQ_RTC))
+    // 1. 发送初始化响应头（开启multipart长连接）
+    // 推流响应没有结束点，连接一直处于响应中，客户端断开后socket释放，推流随之停止
+    HttpConnection *connection = HttpConnection::fromSocket(socket);
+    if (connection)
     {
-        return false;
+        connection->closeAfterResponse();
     }
-
-    // 2. 防止重复推流（同一socket只创建一个定时器）
-    QMutexLocker locker(&m_timerMutex);
-    if (m_screenStreamTimers.contains(socket))
-    {
-        return true;  // 已有推流，直接返回
-    }
-
-    // 3. 发送初始化响应头（开启multipart长连接）
     QByteArray initResponse = "HTTP/1.1 200 OK\r\n";
     initResponse += "Content-Type: multipart/x-mixed-replace; boundary=--screenBoundary\r\n";
     initResponse += "Connection: keep-alive\r\n";   // 保持长连接
@@ -683,120 +891,12 @@ bool TcpServer::handleRTC(const QString &requestPath, QTcpSocket *socket)
         socket->flush();
     }
 
-    // 4. 创建帧率定时器（25帧/秒 = 40ms/帧）
-    QTimer *frameTimer = new QTimer(this);
-    frameTimer->setInterval(40);  // 40ms触发一次，≈25帧/秒
-    m_screenStreamTimers[socket] = frameTimer;
-
-    // 5. 关联定时器槽函数（循环截屏+推送）
-    connect(frameTimer, &QTimer::timeout, this, [=]() {
-        // 检查socket是否有效
-        if (!socket || socket->state() != QTcpSocket::ConnectedState)
-        {
-            stopRTC(socket);
-            return;
-        }
-
-        // 6. 截屏逻辑（多屏幕拼接）
-        QImage           screenshotImg;
-        QList<QScreen *> screens = QGuiApplication::screens();
-        if (screens.isEmpty())
-        {
-            sendJsonResponse(socket, 500, "No available screen to capture");
-            stopRTC(socket);
-            return;
-        }
-
-        QPixmap totalScreenshot;
-        int     totalWidth = 0, totalHeight = 0;
-        for (QScreen *screen : screens)
-        {
-            totalWidth += screen->geometry().width();
-            totalHeight = qMax(totalHeight, screen->geometry().height());
-        }
-        totalScreenshot = QPixmap(totalWidth, totalHeight);
-        QPainter painter(&totalScreenshot);
-        int      xOffset = 0;
-        for (QScreen *screen : screens)
-        {
-            QPixmap screenPix = screen->grabWindow(0);
-            painter.drawPixmap(xOffset, 0, screenPix);
-            xOffset += screen->geometry().width();
-        }
-        screenshotImg = totalScreenshot.toImage();
-
-        if (screenshotImg.isNull())
-        {
-            sendJsonResponse(socket, 500, "Failed to capture screen image");
-            stopRTC(socket);
-            return;
-        }
-
-        // 7. 将图片转为JPG（压缩体积，提升推流效率）
-        QByteArray imageData;
-        QBuffer    buffer(&imageData);
-        buffer.open(QIODevice::WriteOnly);
-        screenshotImg.save(&buffer, "JPG", 80);  // 80质量，平衡体积和清晰度
-
-        // 8. 构建multipart分片（每帧图片作为一个分片）
-        QByteArray frameData;
-        frameData += "--screenBoundary\r\n";  // 分隔符
-        frameData += "Content-Type: image/jpeg\r\n";
-        frameData += "Content-Length: " + QByteArray::number(imageData.size()) + "\r\n\r\n";
-        frameData += imageData;
-        frameData += "\r\n";
-
-        // 9. 推送单帧数据
-        if (socket->isWritable())
-        {
-            socket->write(frameData);
-            socket->flush();  // 强制刷出，避免数据堆积
-        }
-    });
-
-    // 10. 监听socket断开事件（客户端关闭则停止推流）
-    connect(socket, &QTcpSocket::disconnected, this, [=]() {
-        stopRTC(socket);
-    });
-    connect(socket, static_cast<void (QTcpSocket::*)(QAbstractSocket::SocketError)>(&QTcpSocket::error), this, [=]() {
-        stopRTC(socket);
-    });
-
-    // 11. 启动定时器，开始推流
-    frameTimer->start();
-
-    return true;
-}
-
-void TcpServer::stopRTC(QTcpSocket *socket)
-{
-    QMetaObject::invokeMethod(this, "slotStopScreenStream", Qt::QueuedConnection, Q_ARG(QTcpSocket *, socket));
+    // 2. 订阅共享推流：所有观看者共用一路截屏和编码
+    m_rtcBroadcaster->subscribe(socket);
 }
 
-void TcpServer::slotStopScreenStream(QTcpSocket *socket)
+void TcpServer::handleNotify(const QString &requestPath, QTcpSocket *socket)
 {
-    QMutexLocker locker(&m_timerMutex);
-    if (m_screenStreamTimers.contains(socket))
-    {
-        QTimer *timer = m_screenStreamTimers.take(socket);
-        timer->stop();
-        timer->deleteLater();
-        m_screenStreamTimers.remove(socket);
-        if (socket)
-        {
-            socket->disconnectFromHost();
-            socket->deleteLater();  // 按需释放，根据你的连接管理逻辑调整
-        }
-    }
-}
-
-bool TcpServer::handleNotify(const QString &requestPath, QTcpSocket *socket)
-{
-    // 1. 校验请求路径是否匹配截屏指令
-    if (!requestPath.startsWith(REQ_NOTIFY))
-    {
-        return false;
-    }
     QString notifyMessage = requestPath.mid(REQ_NOTIFY.length());
     // 安全处理：解码URL编码（避免空格/特殊字符被转义，如%20→空格）
     notifyMessage = QUrl::fromPercentEncoding(notifyMessage.toUtf8());
@@ -804,16 +904,15 @@ bool TcpServer::handleNotify(const QString &requestPath, QTcpSocket *socket)
     if (notifyMessage.isEmpty())
     {
         sendJsonResponse(socket, 400, "Notify message is empty");
-        return true;
+        return;
     }
 
     // 3. 跨线程安全触发弹窗（关键：Qt GUI操作必须在主线程）
-    // 若HttpServer在主线程，直接调用；否则用invokeMethod切换到主线程
-    showNotifyPopup(notifyMessage);
+    // 请求在I/O线程处理，用invokeMethod切换到主线程（本对象所在线程）
+    QMetaObject::invokeMethod(this, "showNotifyPopup", Qt::AutoConnection, Q_ARG(QString, notifyMessage));
 
     // 4. 发送成功响应给客户端
     sendJsonResponse(socket, 200, QString("Notify shown: %1").arg(notifyMessage));
-    return true;
 }
 
 void TcpServer::showNotifyPopup(const QString &message)
@@ -843,144 +942,57 @@ void TcpServer::showNotifyPopup(const QString &message)
     popup->show();
 }
 
-bool TcpServer::handleTest(const QString &requestPath, QTcpSocket *socket)
+void TcpServer::handleTest(QTcpSocket *socket)
 {
-    // 1. 校验请求路径是否匹配截屏指令
-    if (!requestPath.startsWith(REQ_TEST))
-    {
-        return false;
-    }
     auto content = readTemplate("test_ws.html");
-    // 构建HTTP响应
-    QByteArray response;
-    response += "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: text/html; charset=UTF-8\r\n";
-    response += "Content-Length: " + QByteArray::number(content.size()) + "\r\n";
-    response += "Connection: close\r\n";
-    response += "Cache-Control: no-cache\r\n";
-    response += "\r\n";
-    response += content;
-
     // 发送响应
-    socket->write(response);
-    socket->flush();
-    socket->disconnectFromHost();
-
-    return true;
+    sendHttpResponse(socket, 200, "text/html; charset=UTF-8", content, "Cache-Control: no-cache\r\n");
 }
 
-bool TcpServer::handleBash(const QString &requestPath, QTcpSocket *socket)
+void TcpServer::handleBash(QTcpSocket *socket)
 {
-    // 1. 校验请求路径是否匹配截屏指令
-    if (!requestPath.startsWith(REQ_BASH))
-    {
-        return false;
-    }
     QMap<QString, QString> replaceMap;
     QString                strWsAddr = "ws://" + getLocalIpv4() + ":" + QString::number(Server::getWsPort());
     replaceMap["WS_HOST"]            = strWsAddr;
     auto content                     = readTemplate("bash.html", replaceMap);
-    // 构建HTTP响应
-    QByteArray response;
-    response += "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: text/html; charset=UTF-8\r\n";
-    response += "Content-Length: " + QByteArray::number(content.size()) + "\r\n";
-    response += "Connection: close\r\n";
-    response += "Cache-Control: no-cache\r\n";
-    response += "\r\n";
-    response += content;
-
     // 发送响应
-    socket->write(response);
-    socket->flush();
-    socket->disconnectFromHost();
-
-    return true;
+    sendHttpResponse(socket, 200, "text/html; charset=UTF-8", content, "Cache-Control: no-cache\r\n");
 }
 
-bool TcpServer::handleControl(const QString &requestPath, QTcpSocket *socket)
+void TcpServer::handleControl(QTcpSocket *socket)
 {
-    // 1. 校验请求路径是否匹配截屏指令
-    if (!requestPath.startsWith(REQ_CTRL))
-    {
-        return false;
-    }
-
     // 2. 返回分屏HTML页面（核心修改）
     auto htmlContent = readTemplate("control.html");
 
-    // 发送HTML响应头
-    QByteArray response = "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: text/html; charset=utf-8\r\n";
-    response += "Content-Length: " + QByteArray::number(htmlContent.size()) + "\r\n";
-    response += "Connection: close\r\n\r\n";
-    response += htmlContent;
-
-    if (socket->isWritable())
-    {
-        socket->write(response);
-        socket->flush();
-        // 发送完HTML后关闭连接（前端会通过新请求连接WebSocket和屏幕流）
-        QTimer::singleShot(1000, socket, &QTcpSocket::close);
-    }
-
-    return true;
+    // 发送HTML响应（前端会通过新请求连接WebSocket和屏幕流）
+    sendHttpResponse(socket, 200, "text/html; charset=utf-8", htmlContent);
 }
 
-bool TcpServer::handleXterm(const QString &requestPath, QTcpSocket *socket)
+void TcpServer::handleXterm(QTcpSocket *socket)
 {
-    // 1. 校验请求路径是否匹配截屏指令
-    if (!requestPath.startsWith(REQ_XTERM))
-    {
-        return false;
-    }
     QMap<QString, QString> replaceMap;
     //    QString                strWsAddr = "ws://" + getLocalIpv4() + ":" + QString::number(Server::getWsPort());
     //    replaceMap["WS_HOST"]            = strWsAddr;
     auto content = readTemplate("xterm.html", replaceMap);
-    // 构建HTTP响应
-    QByteArray response;
-    response += "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: text/html; charset=UTF-8\r\n";
-    response += "Content-Length: " + QByteArray::number(content.size()) + "\r\n";
-    response += "Connection: close\r\n";
-    response += "Cache-Control: no-cache\r\n";
-    response += "\r\n";
-    response += content;
-
     // 发送响应
-    socket->write(response);
-    socket->flush();
-    socket->disconnectFromHost();
-
-    return true;
+    sendHttpResponse(socket, 200, "text/html; charset=UTF-8", content, "Cache-Control: no-cache\r\n");
 }
 
-bool TcpServer::handleScreenCtrl(const QString &requestPath, QTcpSocket *socket)
+void TcpServer::handleScreenCtrl(QTcpSocket *socket)
 {
-    // 1. 校验请求路径是否匹配截屏指令
-    if (!requestPath.startsWith(REQ_SCREEN_CTRL))
-    {
-        return false;
-    }
     QMap<QString, QString> replaceMap;
     //    QString                strWsAddr = "ws://" + getLocalIpv4() + ":" + QString::number(Server::getWsPort());
     //    replaceMap["WS_HOST"]            = strWsAddr;
     auto content = readTemplate("screen_ctrl.html", replaceMap);
-    // 构建HTTP响应
-    QByteArray response;
-    response += "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: text/html; charset=UTF-8\r\n";
-    response += "Content-Length: " + QByteArray::number(content.size()) + "\r\n";
-    response += "Connection: close\r\n";
-    response += "Cache-Control: no-cache\r\n";
-    response += "\r\n";
-    response += content;
-
     // 发送响应
-    socket->write(response);
-    socket->flush();
-    socket->disconnectFromHost();
+    sendHttpResponse(socket, 200, "text/html; charset=UTF-8", content, "Cache-Control: no-cache\r\n");
+}
 
-    return true;
+void TcpServer::handleMetrics(QTcpSocket *socket)
+{
+    QJsonObject responseJson;
+    responseJson["success"] = true;
+    responseJson["routes"]  = m_routes.metricsJson();
+    sendHttpResponse(socket, 200, "application/json; charset=UTF-8",
+                     QJsonDocument(responseJson).toJson(QJsonDocument::Compact), "Cache-Control: no-cache\r\n");
 }
@@ -9,62 +9,87 @@
 #include <QTimer>
 #include <QMutex>
 #include "def.h"
+#include "HttpParser.h"
+#include "RouteTable.h"
+
+class HttpConnection;
+class IoThreadPool;
+class RtcBroadcaster;
 
 class TcpServer : public QTcpServer
 {
     Q_OBJECT
 public:
     explicit TcpServer(QObject *parent = nullptr);
+    ~TcpServer() override;
     void startListen(const QString &serverIp, const quint16 serverPort);
 
 protected:
     void incomingConnection(qintptr socketDescriptor) override;
 private slots:
-    void onSocketDisconnected();  // 新增：客户端断开时清理缓存
-    // 停止推流（清理定时器和socket关联）
-    void slotStopScreenStream(QTcpSocket *socket);
+    // 弹窗属于GUI操作，必须在主线程执行
+    void showNotifyPopup(const QString &message);
 
 private:
-    // 处理客户端HTTP请求
+    // 新连接初始化：绑定信号和连接状态（在socket所在线程调用）
+    void setupConnection(QTcpSocket *clientSocket);
+    // 处理客户端HTTP请求（增量解析，每次readyRead只处理新到的数据）
     void handleClientRequest(QTcpSocket *socket);
+    // 按顺序处理连接缓存中的请求（长连接/流水线），当前请求响应结束前不解析下一个
+    void processRequests(HttpConnection *connection);
+    // 启动时注册路由表（特殊请求、静态资源、上传）
+    void registerRoutes();
+    // 请求解析完成后分发到具体的处理函数
+    void dispatchRequest(QTcpSocket *socket, const HttpParser &request);
     /**
      * 处理静态资源请求
      * @param requestPath 请求的路径（如 /js/file_browser.js、/css/style.css）
      * @param socket 客户端socket
-     * @return bool 是否为静态资源请求并处理成功
+     * @param request 请求（用于 If-None-Match / Accept-Encoding）
      */
-    bool handleStaticResource(const QString &requestPath, QTcpSocket *socket);
-    // 处理文件上传请求
-    void handleUploadRequest(QTcpSocket *socket, const QByteArray &requestData);
-    bool checkUploadDataComplete(QTcpSocket *socket, const QByteArray &requestData);
-    void doHandleUploadRequest(QTcpSocket *socket, const QByteArray &requestData);
-    // 处理特殊请求
-    bool handleScreenRequest(const QString &requestPath, QTcpSocket *socket);
-    bool handleRTC(const QString &requestPath, QTcpSocket *socket);
-    void stopRTC(QTcpSocket *socket);
+    void handleStaticResource(const QString &requestPath, QTcpSocket *socket, const HttpParser &request);
+    // 文件下载：普通文件用 sendfile 异步发送，支持 Range/206 和条件请求/304
+    // 返回 false 表示不是可发送的普通文件
+    bool handleFileDownload(QTcpSocket *socket, const HttpParser &request, const QString &filePath);
+    // 目录列表：?format=json&cursor=&limit= 返回分页 JSON；目录项较多时 HTML 以 chunked 分批输出
+    // 索引读取和页面生成在工作线程完成；返回 false 表示不是可访问的目录，交给 readFileOrDir 生成错误页面
+    bool handleDirListing(QTcpSocket       *socket,
+                          const HttpParser &request,
+                          const QString    &dirPath,
+                          const QString    &requestPath);
+    // 上传请求头到达时准备流式写入（失败时已发送错误响应）
+    bool prepareUpload(HttpConnection *connection);
+    // 上传请求体接收完毕，发送上传结果
+    void doHandleUploadRequest(QTcpSocket *socket, const HttpParser &request);
+    // 处理特殊请求（由路由表分发，路径已匹配）
+    void handleScreenRequest(QTcpSocket *socket);
+    void handleRTC(QTcpSocket *socket);
     // 通知
-    bool handleNotify(const QString &requestPath, QTcpSocket *socket);
-    void showNotifyPopup(const QString &message);
+    void handleNotify(const QString &requestPath, QTcpSocket *socket);
     // 测试页面
-    bool handleTest(const QString &requestPath, QTcpSocket *socket);
+    void handleTest(QTcpSocket *socket);
     // bash页面
-    bool handleBash(const QString &requestPath, QTcpSocket *socket);
+    void handleBash(QTcpSocket *socket);
     // handleControl
-    bool handleControl(const QString &requestPath, QTcpSocket *socket);
+    void handleControl(QTcpSocket *socket);
     // xterm
-    bool handleXterm(const QString &requestPath, QTcpSocket *socket);
+    void handleXterm(QTcpSocket *socket);
     // 远程控制
-    bool handleScreenCtrl(const QString &requestPath, QTcpSocket *socket);
+    void handleScreenCtrl(QTcpSocket *socket);
+    // 路由统计（请求数、405次数、响应耗时）
+    void handleMetrics(QTcpSocket *socket);
 
 private:
-    QString                        m_listenIp;
-    quint16                        m_listenPort = 0;
-    QString                        m_rootDir;
-    QMap<QTcpSocket *, QByteArray> m_socketRequestCache;  // 每个socket的请求数据缓存
+    QString m_listenIp;
+    quint16 m_listenPort = 0;
+    QString m_rootDir;
+    // HTTP连接的I/O线程池
+    IoThreadPool *m_ioThreads = nullptr;
+    // 特殊请求路由表（构造时注册，之后只读）
+    RouteTable m_routes;
 
-    // handleRTC
-    QMap<QTcpSocket *, QTimer *> m_screenStreamTimers;  // 推流定时器映射
-    QMutex                       m_timerMutex;          // 定时器操作互斥锁
+    // handleRTC：共享的截屏编码生产者
+    RtcBroadcaster *m_rtcBroadcaster = nullptr;
 };
 
 #endif  // TCPSERVER_H
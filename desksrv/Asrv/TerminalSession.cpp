@@ -0,0 +1,63 @@
+#include "TerminalSession.h"
+#include <cstring>
+
+ScrollbackBuffer::ScrollbackBuffer(int capacity): m_capacity(qMax(0, capacity))
+{
+}
+
+void ScrollbackBuffer::append(const char *data, int size)
+{
+    m_end += static_cast<quint64>(size);
+    if (m_capacity == 0 || size <= 0)
+    {
+        return;
+    }
+    if (m_buffer.isEmpty())
+    {
+        m_buffer.resize(m_capacity);
+    }
+
+    // 超过容量时只有最后 m_capacity 个字节有用
+    if (size > m_capacity)
+    {
+        data += size - m_capacity;
+        size = m_capacity;
+    }
+    // 写入位置由写入后的结束偏移倒推，分两段处理回绕
+    int pos   = static_cast<int>((m_end - static_cast<quint64>(size)) % static_cast<quint64>(m_capacity));
+    int first = qMin(size, m_capacity - pos);
+    memcpy(m_buffer.data() + pos, data, static_cast<size_t>(first));
+    memcpy(m_buffer.data(), data + first, static_cast<size_t>(size - first));
+}
+
+QByteArray ScrollbackBuffer::readFrom(quint64 offset) const
+{
+    quint64 from = qBound(startOffset(), offset, m_end);
+    int     size = static_cast<int>(m_end - from);
+    if (size == 0)
+    {
+        return QByteArray();
+    }
+
+    QByteArray result(size, Qt::Uninitialized);
+    int        pos   = static_cast<int>(from % static_cast<quint64>(m_capacity));
+    int        first = qMin(size, m_capacity - pos);
+    memcpy(result.data(), m_buffer.constData() + pos, static_cast<size_t>(first));
+    memcpy(result.data() + first, m_buffer.constData(), static_cast<size_t>(size - first));
+    return result;
+}
+
+int ScrollbackBuffer::capacity() const
+{
+    return m_capacity;
+}
+
+quint64 ScrollbackBuffer::startOffset() const
+{
+    return m_end > static_cast<quint64>(m_capacity) ? m_end - static_cast<quint64>(m_capacity) : 0;
+}
+
+quint64 ScrollbackBuffer::endOffset() const
+{
+    return m_end;
+}
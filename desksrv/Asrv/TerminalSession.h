@@ -0,0 +1,57 @@
+#ifndef TERMINALSESSION_H
+#define TERMINALSESSION_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <sys/types.h>
+
+class QSocketNotifier;
+class QWebSocket;
+
+// 终端回滚缓冲：固定容量的环形缓冲，保存会话最近输出的字节
+// 偏移按会话开始以来的输出字节数计算（与客户端已收到的字节数对应），重新连接时只补发缺少的部分
+class ScrollbackBuffer
+{
+public:
+    explicit ScrollbackBuffer(int capacity = 0);
+
+    void append(const char *data, int size);
+    // 从 offset 开始到最新的输出；offset 早于 startOffset() 时（已被覆盖）从 startOffset() 开始
+    QByteArray readFrom(quint64 offset) const;
+
+    int     capacity() const;
+    quint64 startOffset() const;  // 缓冲中最早的字节的偏移
+    quint64 endOffset() const;    // 输出的总字节数
+
+private:
+    QByteArray m_buffer;  // 第一次写入时才分配
+    int        m_capacity = 0;
+    quint64    m_end      = 0;
+};
+
+// 终端输出的合并发送和流控状态
+struct PtyOutput
+{
+    QByteArray    pending;         // 尚未发送的输出
+    QElapsedTimer lastFlush;       // 上次发送的时间
+    bool          paused = false;  // 发送缓冲超过高水位，已暂停读取 PTY
+    bool          closed = false;  // PTY 已关闭，不再恢复读取
+};
+
+// 终端会话：PTY 和 Shell 属于会话而不是连接
+// 带 session 参数连接的客户端断开后会话保留（detach），Shell 继续运行，输出写入回滚缓冲，可以按 ID 重新连接
+struct TerminalSession
+{
+    QString          id;
+    int              ptyFd      = -1;
+    pid_t            shellPid   = -1;
+    QSocketNotifier *notifier   = nullptr;
+    QWebSocket      *client     = nullptr;  // 当前连接的客户端，断开后为空
+    bool             detachable = false;    // 客户端支持重新连接（否则断开时结束会话）
+    ScrollbackBuffer scrollback;
+    PtyOutput        output;
+    QElapsedTimer    detachedAt;  // 断开的时间，超时后结束会话
+};
+
+#endif  // TERMINALSESSION_H
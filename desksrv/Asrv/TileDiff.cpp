@@ -0,0 +1,300 @@
+#include "TileDiff.h"
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TILE_DIFF_X86
+#endif
+
+#include "def.h"
+
+// 脏区域过于零散（合并前的矩形数超过该值）时直接返回所有脏块的外接矩形
+static const int MAX_FRAGMENTS = 64;
+
+using RowsDifferFunc = bool (*)(const uchar *, int, const uchar *, int, int, int, int);
+
+static bool rowsDifferScalar(const uchar *prev,
+                             int          prevStride,
+                             const uchar *curr,
+                             int          currStride,
+                             int          rowBytes,
+                             int          rows,
+                             int          tolerance)
+{
+    for (int y = 0; y < rows; ++y)
+    {
+        const uchar *a = prev + y * prevStride;
+        const uchar *b = curr + y * currStride;
+        if (tolerance == 0)
+        {
+            if (memcmp(a, b, rowBytes) != 0)
+            {
+                return true;
+            }
+            continue;
+        }
+        for (int x = 0; x < rowBytes; ++x)
+        {
+            if (abs(a[x] - b[x]) > tolerance)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+#ifdef TILE_DIFF_X86
+// 每个字节 |a - b| > tolerance 时结果非零：两个方向的饱和减法取或得到差值，再饱和减去容差
+static bool rowsDifferSse2(const uchar *prev,
+                           int          prevStride,
+                           const uchar *curr,
+                           int          currStride,
+                           int          rowBytes,
+                           int          rows,
+                           int          tolerance)
+{
+    const __m128i tol     = _mm_set1_epi8(static_cast<char>(tolerance));
+    const __m128i zero    = _mm_setzero_si128();
+    const int     simdEnd = rowBytes & ~15;
+    for (int y = 0; y < rows; ++y)
+    {
+        const uchar *a   = prev + y * prevStride;
+        const uchar *b   = curr + y * currStride;
+        __m128i      acc = zero;
+        for (int x = 0; x < simdEnd; x += 16)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+            __m128i d  = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            acc        = _mm_or_si128(acc, _mm_subs_epu8(d, tol));
+        }
+        // 按行检查一次，变化通常集中在分块的某几行，不必等整个分块比较完
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, zero)) != 0xFFFF)
+        {
+            return true;
+        }
+        if (simdEnd < rowBytes &&
+            rowsDifferScalar(a + simdEnd, prevStride, b + simdEnd, currStride, rowBytes - simdEnd, 1, tolerance))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+__attribute__((target("avx2"))) static bool rowsDifferAvx2(const uchar *prev,
+                                                             int          prevStride,
+                                                             const uchar *curr,
+                                                             int          currStride,
+                                                             int          rowBytes,
+                                                             int          rows,
+                                                             int          tolerance)
+{
+    const __m256i tol     = _mm256_set1_epi8(static_cast<char>(tolerance));
+    const int     simdEnd = rowBytes & ~31;
+    for (int y = 0; y < rows; ++y)
+    {
+        const uchar *a   = prev + y * prevStride;
+        const uchar *b   = curr + y * currStride;
+        __m256i      acc = _mm256_setzero_si256();
+        for (int x = 0; x < simdEnd; x += 32)
+        {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + x));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + x));
+            __m256i d  = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+            acc        = _mm256_or_si256(acc, _mm256_subs_epu8(d, tol));
+        }
+        if (!_mm256_testz_si256(acc, acc))
+        {
+            return true;
+        }
+        if (simdEnd < rowBytes &&
+            rowsDifferSse2(a + simdEnd, prevStride, b + simdEnd, currStride, rowBytes - simdEnd, 1, tolerance))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+struct RowsDifferImpl
+{
+    RowsDifferFunc func;
+    const char    *name;
+};
+
+static RowsDifferImpl selectRowsDiffer()
+{
+#ifdef TILE_DIFF_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {rowsDifferAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return {rowsDifferSse2, "sse2"};
+    }
+#endif
+    return {rowsDifferScalar, "scalar"};
+}
+
+static const RowsDifferImpl &rowsDifferImpl()
+{
+    static const RowsDifferImpl impl = selectRowsDiffer();
+    return impl;
+}
+
+const char *tileDiffBackend()
+{
+    return rowsDifferImpl().name;
+}
+
+bool tileDiffers(const uchar *prev,
+                 int          prevStride,
+                 const uchar *curr,
+                 int          currStride,
+                 int          rowBytes,
+                 int          rows,
+                 int          tolerance)
+{
+    return rowsDifferImpl().func(prev, prevStride, curr, currStride, rowBytes, rows, qBound(0, tolerance, 255));
+}
+
+// 合并后多出的面积（两个矩形外接矩形的面积减去各自面积）
+static qint64 mergeCost(const QRect &a, const QRect &b)
+{
+    QRect united = a.united(b);
+    return qint64(united.width()) * united.height() - qint64(a.width()) * a.height() -
+           qint64(b.width()) * b.height();
+}
+
+QVector<QRect> coalesceTiles(const QVector<char> &dirty, int cols, int rows, const QRect &bounds, int maxRects)
+{
+    // 1. 每行连续的脏块合并成横条；与上一行跨度相同的横条纵向延伸（分块坐标）
+    QVector<QRect> rects;
+    QRect          box;
+    for (int row = 0; row < rows; ++row)
+    {
+        int col = 0;
+        while (col < cols)
+        {
+            if (!dirty[row * cols + col])
+            {
+                ++col;
+                continue;
+            }
+            int start = col;
+            while (col < cols && dirty[row * cols + col])
+            {
+                ++col;
+            }
+            QRect run(start, row, col - start, 1);
+            box = box.united(run);
+
+            bool extended = false;
+            for (QRect &rect : rects)
+            {
+                if (rect.bottom() == row - 1 && rect.left() == run.left() && rect.width() == run.width())
+                {
+                    rect.setBottom(row);
+                    extended = true;
+                    break;
+                }
+            }
+            if (!extended)
+            {
+                rects.append(run);
+            }
+        }
+    }
+    if (rects.isEmpty())
+    {
+        return rects;
+    }
+
+    // 2. 过于零散时整体发送外接矩形；否则每次合并代价（多出的面积）最小的两个，
+    //    直到数量不超过 maxRects 且不存在不增加面积的合并
+    if (rects.size() > MAX_FRAGMENTS)
+    {
+        rects = {box};
+    }
+    while (rects.size() > 1)
+    {
+        int    bestI = 0, bestJ = 1;
+        qint64 bestCost = std::numeric_limits<qint64>::max();
+        for (int i = 0; i < rects.size(); ++i)
+        {
+            for (int j = i + 1; j < rects.size(); ++j)
+            {
+                qint64 cost = mergeCost(rects[i], rects[j]);
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestI    = i;
+                    bestJ    = j;
+                }
+            }
+        }
+        if (rects.size() <= maxRects && bestCost > 0)
+        {
+            break;
+        }
+        rects[bestI] = rects[bestI].united(rects[bestJ]);
+        rects.remove(bestJ);
+    }
+
+    // 3. 分块坐标转换为像素坐标（右/下边缘的分块不足一整块）
+    for (QRect &rect : rects)
+    {
+        rect = QRect(bounds.x() + rect.x() * SCREEN_DIFF_TILE, bounds.y() + rect.y() * SCREEN_DIFF_TILE,
+                     rect.width() * SCREEN_DIFF_TILE, rect.height() * SCREEN_DIFF_TILE)
+                   .intersected(bounds);
+    }
+    return rects;
+}
+
+QVector<QRect> diffTiles(const QImage &prev, const QImage &curr, int tolerance, int maxRects)
+{
+    if (prev.size() != curr.size() || prev.depth() != 32 || curr.depth() != 32)
+    {
+        return {curr.rect()};
+    }
+
+    const int width  = curr.width();
+    const int height = curr.height();
+    const int cols   = (width + SCREEN_DIFF_TILE - 1) / SCREEN_DIFF_TILE;
+    const int rows   = (height + SCREEN_DIFF_TILE - 1) / SCREEN_DIFF_TILE;
+
+    const uchar  *prevBits   = prev.constBits();
+    const uchar  *currBits   = curr.constBits();
+    const int     prevStride = prev.bytesPerLine();
+    const int     currStride = curr.bytesPerLine();
+    QVector<char> dirty(cols * rows, 0);
+    bool          hasDiff = false;
+    for (int row = 0; row < rows; ++row)
+    {
+        int y     = row * SCREEN_DIFF_TILE;
+        int tileH = qMin(SCREEN_DIFF_TILE, height - y);
+        for (int col = 0; col < cols; ++col)
+        {
+            int x     = col * SCREEN_DIFF_TILE;
+            int tileW = qMin(SCREEN_DIFF_TILE, width - x);
+            if (tileDiffers(prevBits + y * prevStride + x * 4, prevStride, currBits + y * currStride + x * 4,
+                            currStride, tileW * 4, tileH, tolerance))
+            {
+                dirty[row * cols + col] = 1;
+                hasDiff                 = true;
+            }
+        }
+    }
+    if (!hasDiff)
+    {
+        return {};
+    }
+    return coalesceTiles(dirty, cols, rows, curr.rect(), maxRects);
+}
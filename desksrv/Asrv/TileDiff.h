@@ -0,0 +1,33 @@
+#ifndef TILEDIFF_H
+#define TILEDIFF_H
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+/**
+ * @brief 比较两帧截图，返回需要重发的矩形区域
+ * 按 SCREEN_DIFF_TILE 大小分块，直接比较32位像素（SSE2/AVX2，按CPU运行时选择），
+ * 脏块先按行合并成横条、再把相同跨度的横条纵向合并，最后把数量压缩到 maxRects 以内
+ * @param prev/curr 相同尺寸的 32 位图像（Format_RGB32/ARGB32）
+ * @param tolerance 单个颜色通道允许的差值（0 表示完全相同才算未变化）
+ * @return 没有变化时返回空列表
+ */
+QVector<QRect> diffTiles(const QImage &prev, const QImage &curr, int tolerance, int maxRects);
+
+// 一个分块是否有变化（rowBytes 为分块每行的字节数）
+bool tileDiffers(const uchar *prev,
+                 int          prevStride,
+                 const uchar *curr,
+                 int          currStride,
+                 int          rowBytes,
+                 int          rows,
+                 int          tolerance);
+
+// 合并脏块：dirty 为 cols*rows 的脏块标记，返回像素坐标的矩形（按 bounds 裁剪）
+QVector<QRect> coalesceTiles(const QVector<char> &dirty, int cols, int rows, const QRect &bounds, int maxRects);
+
+// 当前使用的比较实现（"avx2"、"sse2" 或 "scalar"）
+const char *tileDiffBackend();
+
+#endif  // TILEDIFF_H
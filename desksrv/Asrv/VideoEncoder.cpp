@@ -0,0 +1,229 @@
+#include "VideoEncoder.h"
+#include <QDebug>
+#include <QStandardPaths>
+
+#include "def.h"
+
+// FLV：文件头 9 字节 + 第一个 PreviousTagSize 4 字节；标签头 11 字节，标签后是 4 字节的 PreviousTagSize
+static const int FLV_FILE_HEADER_SIZE = 9 + 4;
+static const int FLV_TAG_HEADER_SIZE  = 11;
+static const int FLV_TAG_VIDEO        = 9;
+static const int FLV_CODEC_AVC        = 7;
+
+static quint32 readUInt24(const uchar *data)
+{
+    return (quint32(data[0]) << 16) | (quint32(data[1]) << 8) | data[2];
+}
+
+VideoEncoder::VideoEncoder(QObject *parent): QObject(parent)
+{
+}
+
+VideoEncoder::~VideoEncoder()
+{
+    stop();
+}
+
+bool VideoEncoder::isAvailable()
+{
+    static const bool available = !QStandardPaths::findExecutable("ffmpeg").isEmpty();
+    return available;
+}
+
+void VideoEncoder::start(int width, int height)
+{
+    stop();
+
+    m_width        = width;
+    m_height       = height;
+    m_started      = false;
+    m_headerParsed = false;
+    m_stopping     = false;
+    m_buffer.clear();
+
+    // 输入：原始 BGRX 像素（QImage::Format_RGB32 的内存布局）；输出：FLV 封装的 H.264，每个包立即写出
+    QStringList args;
+    args << "-loglevel" << "error"
+         << "-f" << "rawvideo" << "-pix_fmt" << "bgr0"
+         << "-s" << QString("%1x%2").arg(width).arg(height)
+         << "-r" << QString::number(VIDEO_STREAM_FPS) << "-i" << "pipe:0"
+         << "-an" << "-c:v" << "libx264" << "-preset" << "ultrafast" << "-tune" << "zerolatency"
+         << "-profile:v" << "baseline" << "-pix_fmt" << "yuv420p"
+         << "-crf" << QString::number(VIDEO_STREAM_CRF) << "-g" << QString::number(VIDEO_STREAM_GOP)
+         << "-flush_packets" << "1" << "-f" << "flv" << "pipe:1";
+
+    m_process = new QProcess(this);
+    m_process->setProcessChannelMode(QProcess::SeparateChannels);
+    m_process->setReadChannel(QProcess::StandardOutput);
+    connect(m_process, &QProcess::started, this, &VideoEncoder::onStarted);
+    connect(m_process, &QProcess::errorOccurred, this, &VideoEncoder::onErrorOccurred);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &VideoEncoder::onReadyRead);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            &VideoEncoder::onFinished);
+    // 不在主线程等待进程启动，结果由 started/errorOccurred 通知
+    m_process->start("ffmpeg", args);
+}
+
+void VideoEncoder::onStarted()
+{
+    m_started = true;
+    qInfo() << "Video encoder started:" << m_width << "x" << m_height;
+}
+
+void VideoEncoder::onErrorOccurred(QProcess::ProcessError error)
+{
+    // 运行中的异常退出由 onFinished 报告
+    if (error != QProcess::FailedToStart)
+    {
+        return;
+    }
+    QString reason = m_process->errorString();
+    qWarning() << "Failed to start ffmpeg:" << reason;
+    stop();
+    emit failed(reason);
+}
+
+void VideoEncoder::stop()
+{
+    if (!m_process)
+    {
+        return;
+    }
+    m_stopping = true;
+    m_started  = false;
+    m_process->disconnect(this);
+
+    // 不等待进程退出：脱离父对象（避免随编码器析构时阻塞等待），结束后自行释放
+    QProcess *process = m_process;
+    m_process         = nullptr;
+    process->setParent(nullptr);
+    if (process->state() == QProcess::NotRunning)
+    {
+        process->deleteLater();
+        return;
+    }
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), process, &QObject::deleteLater);
+    connect(process, &QProcess::errorOccurred, process, [process](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+        {
+            process->deleteLater();
+        }
+    });
+    process->closeWriteChannel();
+    process->kill();
+}
+
+bool VideoEncoder::encode(const QImage &frame)
+{
+    // yuv420p 要求宽高为偶数
+    int width  = frame.width() & ~1;
+    int height = frame.height() & ~1;
+    if (width == 0 || height == 0)
+    {
+        return false;
+    }
+    if (!m_process || width != m_width || height != m_height)
+    {
+        start(width, height);
+    }
+    // 进程启动前（或启动失败后）的帧直接丢弃
+    if (!m_process || !m_started)
+    {
+        return false;
+    }
+    // 编码跟不上时丢弃新帧，不在管道里堆积原始画面
+    if (m_process->bytesToWrite() > 0)
+    {
+        return false;
+    }
+
+    if (width == frame.width() && height == frame.height() && frame.bytesPerLine() == width * 4)
+    {
+        m_process->write(reinterpret_cast<const char *>(frame.constBits()), qint64(width) * height * 4);
+    }
+    else
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            m_process->write(reinterpret_cast<const char *>(frame.constScanLine(y)), width * 4);
+        }
+    }
+    return true;
+}
+
+void VideoEncoder::onReadyRead()
+{
+    m_buffer += m_process->readAllStandardOutput();
+    if (!m_headerParsed)
+    {
+        if (m_buffer.size() < FLV_FILE_HEADER_SIZE)
+        {
+            return;
+        }
+        if (!m_buffer.startsWith("FLV"))
+        {
+            qWarning() << "Unexpected ffmpeg output, stopping video encoder";
+            stop();
+            emit failed("invalid encoder output");
+            return;
+        }
+        m_buffer.remove(0, FLV_FILE_HEADER_SIZE);
+        m_headerParsed = true;
+    }
+    int offset = 0;
+    while (parseTag(offset))
+    {
+    }
+    m_buffer.remove(0, offset);
+}
+
+bool VideoEncoder::parseTag(int &offset)
+{
+    if (m_buffer.size() - offset < FLV_TAG_HEADER_SIZE)
+    {
+        return false;
+    }
+    const uchar *tag      = reinterpret_cast<const uchar *>(m_buffer.constData()) + offset;
+    int          dataSize = static_cast<int>(readUInt24(tag + 1));
+    int          tagSize  = FLV_TAG_HEADER_SIZE + dataSize + 4;
+    if (m_buffer.size() - offset < tagSize)
+    {
+        return false;
+    }
+    offset += tagSize;
+
+    // 视频标签：1字节帧类型/编码，1字节 AVCPacketType，3字节合成时间，之后是负载
+    const uchar *data = tag + FLV_TAG_HEADER_SIZE;
+    if (tag[0] != FLV_TAG_VIDEO || dataSize < 5 || (data[0] & 0x0F) != FLV_CODEC_AVC)
+    {
+        return true;
+    }
+    bool       keyFrame = (data[0] >> 4) == 1;
+    QByteArray payload(reinterpret_cast<const char *>(data + 5), dataSize - 5);
+    if (data[1] == 0)
+    {
+        emit configReady(payload);
+    }
+    else if (data[1] == 1)
+    {
+        emit frameReady(payload, keyFrame);
+    }
+    return true;
+}
+
+void VideoEncoder::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (m_stopping)
+    {
+        return;
+    }
+    QString reason = QString("ffmpeg exited (code %1, %2): %3")
+                         .arg(exitCode)
+                         .arg(exitStatus == QProcess::NormalExit ? "normal" : "crash")
+                         .arg(QString::fromLocal8Bit(m_process->readAllStandardError()).trimmed());
+    qWarning() << reason;
+    m_process->deleteLater();
+    m_process = nullptr;
+    m_started = false;
+    emit failed(reason);
+}
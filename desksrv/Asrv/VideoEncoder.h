@@ -0,0 +1,71 @@
+#ifndef VIDEOENCODER_H
+#define VIDEOENCODER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QObject>
+#include <QProcess>
+
+// 屏幕视频流编码器：把截屏写给 ffmpeg 子进程（libx264，ultrafast + zerolatency，帧间压缩），
+// ffmpeg 输出 FLV，在这里拆出 AVCDecoderConfigurationRecord 和每帧的 AVCC 数据，
+// 页面用 WebCodecs VideoDecoder 直接解码（画面滚动/视频播放时比逐块JPG省带宽）
+class VideoEncoder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VideoEncoder(QObject *parent = nullptr);
+    ~VideoEncoder() override;
+
+    // 系统中是否有可用的 ffmpeg
+    static bool isAvailable();
+
+    /**
+     * @brief 写入一帧截屏（32位图像），尺寸变化时重启编码进程
+     * @return 编码进程正在启动、还没处理完之前的帧（输入积压）或启动失败时返回 false，本帧不编码
+     */
+    bool encode(const QImage &frame);
+
+    // 结束编码进程（不等待退出，进程结束后自行释放）
+    void stop();
+
+    // 当前编码尺寸（偶数对齐后的截屏尺寸）
+    int width() const
+    {
+        return m_width;
+    }
+    int height() const
+    {
+        return m_height;
+    }
+
+signals:
+    // 解码器配置（AVCDecoderConfigurationRecord），编码进程启动后输出一次
+    void configReady(const QByteArray &config);
+    // 一帧编码结果（AVCC 格式，4字节长度前缀的NAL单元）
+    void frameReady(const QByteArray &frame, bool keyFrame);
+    // 编码进程异常退出
+    void failed(const QString &reason);
+
+private slots:
+    void onStarted();
+    void onErrorOccurred(QProcess::ProcessError error);
+    void onReadyRead();
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    // 异步启动编码进程，started 之前到达的帧直接丢弃
+    void start(int width, int height);
+    // 解析缓冲区 offset 处的一个 FLV 标签并前移 offset，数据不完整时返回 false
+    bool parseTag(int &offset);
+
+private:
+    QProcess  *m_process      = nullptr;
+    int        m_width        = 0;
+    int        m_height       = 0;
+    QByteArray m_buffer;                // 尚未解析的 FLV 数据
+    bool       m_started      = false;  // 编码进程已启动，可以写入帧
+    bool       m_headerParsed = false;  // FLV 文件头是否已跳过
+    bool       m_stopping     = false;  // 主动停止时不报告异常
+};
+
+#endif  // VIDEOENCODER_H
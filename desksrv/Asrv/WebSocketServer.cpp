@@ -7,8 +7,12 @@
 #include <pty.h>
 #include <unistd.h>
 #include <sys/wait.h>
-#include <QThread>
+#include <QSocketNotifier>
 #include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QUuid>
 #include <errno.h>   // 新增：错误码定义
 #include <string.h>  // 新增：strerror 所需
 #include <fcntl.h>   // 包含fcntl头文件
@@ -16,11 +20,13 @@
 #include "def.h"
 #include "tool.h"
 
-// 初始化静态成员变量
-QMap<QWebSocket *, int> WebSocketServer::m_clientPtyMap;
-
 WebSocketServer::WebSocketServer(QObject *parent): QObject(parent)
 {
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(PTY_FLUSH_INTERVAL);
+    connect(&m_flushTimer, &QTimer::timeout, this, &WebSocketServer::flushAllPtyOutput);
+    m_reapTimer.setInterval(60 * 1000);
+    connect(&m_reapTimer, &QTimer::timeout, this, &WebSocketServer::reapDetachedSessions);
 }
 
 WebSocketServer::~WebSocketServer()
@@ -81,33 +87,19 @@ void WebSocketServer::stopListen()
 {
     if (m_wsServer)
     {
-        // 关闭所有客户端连接、Shell 进程、PTY
-        for (auto it = m_clientShellPidMap.begin(); it != m_clientShellPidMap.end(); ++it)
+        // 关闭所有会话（PTY、Shell 进程）和客户端连接
+        for (TerminalSession *session : m_sessions.values())
         {
-            QWebSocket *client   = it.key();
-            pid_t       shellPid = it.value();
-
-            // 关闭 PTY
-            if (m_clientPtyMap.contains(client))
-            {
-                close(m_clientPtyMap[client]);
-                m_clientPtyMap.remove(client);
-            }
-
-            // 终止 Shell 进程（避免僵尸进程）
-            if (shellPid > 0)
+            QWebSocket *client = session->client;
+            destroySession(session);
+            if (client)
             {
-                kill(shellPid, SIGTERM);
-                waitpid(shellPid, nullptr, WNOHANG);
+                client->disconnect(this);
+                client->close();
+                client->deleteLater();
             }
-
-            // 关闭客户端
-            client->close();
-            client->deleteLater();
         }
-
-        m_clientShellPidMap.clear();
-        m_clientPtyMap.clear();
+        m_clientSessionMap.clear();
 
         m_wsServer->close();
         delete m_wsServer;
@@ -117,7 +109,7 @@ void WebSocketServer::stopListen()
 }
 
 // 核心修复：创建 PTY 并启动 Shell（使用 fork/exec，兼容 Qt 5.9）
-bool WebSocketServer::createPtyAndStartShell(QWebSocket *client)
+bool WebSocketServer::createPtyAndStartShell(QWebSocket *client, TerminalSession *session)
 {
     int            ptyMasterFd = -1;
     int            ptySlaveFd  = -1;
@@ -254,8 +246,8 @@ bool WebSocketServer::createPtyAndStartShell(QWebSocket *client)
         }
 
         // 保存 PTY FD 和 Shell PID（用于后续清理）
-        m_clientPtyMap[client]      = ptyMasterFd;
-        m_clientShellPidMap[client] = shellPid;
+        session->ptyFd    = ptyMasterFd;
+        session->shellPid = shellPid;
         qInfo() << "PTY 绑定成功（客户端：" << client->peerAddress().toString() << "）"
                 << "，Shell：" << shellPath << "，PTY Master FD：" << ptyMasterFd << "，Shell PID：" << shellPid;
 
@@ -263,71 +255,297 @@ bool WebSocketServer::createPtyAndStartShell(QWebSocket *client)
     }
 }
 
-// 子线程读取 PTY 输出（原有逻辑不变，仅优化客户端状态判断）
-void WebSocketServer::readPtyOutput(QWebSocket *client)
+// 新建会话：启动 Shell，监听 PTY 输出（所有终端共用主线程的事件循环，不再每个客户端一个轮询线程）
+TerminalSession *WebSocketServer::createSession(QWebSocket *client, bool detachable)
 {
-    if (!client || !m_clientPtyMap.contains(client))
-        return;
+    TerminalSession *session = new TerminalSession;
+    if (!createPtyAndStartShell(client, session))
+    {
+        delete session;
+        return nullptr;
+    }
+    session->id         = QUuid::createUuid().toString().mid(1, 36);
+    session->detachable = detachable;
 
-    int     ptyMasterFd = m_clientPtyMap[client];
-    char    buffer[1024];
-    ssize_t bytesRead;
-    while (true)
+    // 只有能重新连接的会话需要回滚缓冲；总量达到上限时先结束断开最久的会话，仍不够则不保留回滚
+    if (detachable)
     {
-        bytesRead = read(ptyMasterFd, buffer, sizeof(buffer) - 1);
-        if (bytesRead > 0)
+        while (m_scrollbackBytes + TERM_SCROLLBACK_SIZE > TERM_SCROLLBACK_TOTAL && evictOldestDetachedSession())
         {
-            // 1. 读取 PTY 原始数据
-            QByteArray output(buffer, bytesRead);
-            // 关键调试：打印 read 返回值和读取到的原始数据
-//            qInfo() << "PTY 读取结果：bytesRead=" << bytesRead
-//                    << " errno=" << (bytesRead < 0 ? strerror(errno) : "无错误") << " 读取到的原始数据（hex）："
-//                    << QByteArray(buffer, qMax(0, (int)bytesRead)).toHex();
+        }
+        if (m_scrollbackBytes + TERM_SCROLLBACK_SIZE <= TERM_SCROLLBACK_TOTAL)
+        {
+            session->scrollback = ScrollbackBuffer(TERM_SCROLLBACK_SIZE);
+            m_scrollbackBytes += TERM_SCROLLBACK_SIZE;
+        }
+        else
+        {
+            qWarning() << "终端回滚缓冲已达上限，会话" << session->id << "重新连接时无法补发输出";
+        }
+    }
 
-            // 2. 编码转换（避免乱码）
-            //        QString msg = QString::fromUtf8(output);
+    session->notifier = new QSocketNotifier(session->ptyFd, QSocketNotifier::Read, this);
+    connect(session->notifier, &QSocketNotifier::activated, this, [this, session]() {
+        readPtyOutput(session);
+    });
+    m_sessions[session->id] = session;
+    return session;
+}
 
-            //
-            //            QString msg = QString::fromUtf8(filterAnsiEscapeCodes(output));
+// 客户端连接到会话：可重新连接的会话先告知会话ID，再补发客户端缺少的输出（offset 为客户端已收到的字节数）
+void WebSocketServer::attachSession(QWebSocket *client, TerminalSession *session, quint64 offset)
+{
+    session->client            = client;
+    session->output            = PtyOutput();
+    m_clientSessionMap[client] = session;
 
-            // 3. 关键修复：跨线程委托主线程发送消息（避免操作 QSocketNotifier）
-            // 使用 Qt::QueuedConnection 确保主线程执行
-            //            bool invokeOk = QMetaObject::invokeMethod(this, "sendMessageToClient", Qt::QueuedConnection,
-            //                                                      Q_ARG(QWebSocket *, client), Q_ARG(QString, msg));
-            bool invokeOk = QMetaObject::invokeMethod(this, "sendBinaryToClient", Qt::QueuedConnection,
-                                                      Q_ARG(QWebSocket *, client), Q_ARG(QByteArray, output));
+    if (session->detachable)
+    {
+        // 补发的起点晚于 offset 说明中间的输出已被回滚缓冲覆盖
+        QByteArray  replay = session->scrollback.readFrom(offset);
+        QJsonObject message;
+        message["type"]   = "session";
+        message["id"]     = session->id;
+        message["offset"] = static_cast<double>(session->scrollback.endOffset() - replay.size());
+        client->sendTextMessage(QString::fromUtf8(QJsonDocument(message).toJson(QJsonDocument::Compact)));
+        if (!replay.isEmpty())
+        {
+            sendBinaryToClient(client, replay);
+        }
+    }
+    session->notifier->setEnabled(true);
+}
 
-            if (!invokeOk)
-            {
-                qWarning() << "委托主线程发送消息失败（客户端：" << client->peerAddress().toString() << "）";
-            }
+// 客户端断开：会话保留，Shell 继续运行，输出只写入回滚缓冲
+void WebSocketServer::detachSession(TerminalSession *session)
+{
+    m_clientSessionMap.remove(session->client);
+    session->client = nullptr;
+    session->output = PtyOutput();
+    session->detachedAt.start();
+    session->notifier->setEnabled(true);
+    if (!m_reapTimer.isActive())
+    {
+        m_reapTimer.start();
+    }
+    qInfo() << "终端会话已断开，保留" << TERM_DETACHED_TIMEOUT << "秒：" << session->id;
+}
+
+// 结束会话：停止监听并关闭 PTY，终止 Shell 进程
+void WebSocketServer::destroySession(TerminalSession *session)
+{
+    m_sessions.remove(session->id);
+    if (session->client)
+    {
+        m_clientSessionMap.remove(session->client);
+    }
+    m_scrollbackBytes -= session->scrollback.capacity();
+
+    // 可能正处于该通知器的 activated 信号中，延迟删除；关闭 FD 前先停止监听
+    session->notifier->setEnabled(false);
+    session->notifier->deleteLater();
+    if (session->ptyFd >= 0)
+    {
+        if (close(session->ptyFd) == 0)
+        {
+            qInfo() << "PTY资源已释放（FD：" << session->ptyFd << "）";
+        }
+        else
+        {
+            qWarning() << "关闭PTY失败（FD：" << session->ptyFd << "），错误码：" << errno;
+        }
+    }
+
+    if (session->shellPid > 0)
+    {
+        pid_t shellPid = session->shellPid;
+        // 先发送SIGTERM优雅终止，失败则发送SIGKILL强制杀死
+        if (kill(shellPid, SIGTERM) != 0)
+        {
+            qWarning() << "优雅终止Shell进程失败，强制杀死（PID：" << shellPid << "）";
+            kill(shellPid, SIGKILL);
+        }
+        // 非阻塞回收子进程（避免waitpid阻塞主线程）
+        int status = 0;
+        waitpid(shellPid, &status, WNOHANG);
+        qInfo() << "已终止Shell进程（PID：" << shellPid << "），退出状态：" << status;
+    }
+    delete session;
+}
+
+void WebSocketServer::exitSession(QWebSocket *client, TerminalSession *session)
+{
+    // 交互式 bash 会忽略 SIGTERM，只关闭连接的话可断开会话会被保留，页面重连后又回到原来的 Shell
+    // 直接结束会话：关闭 PTY（Shell 收到 SIGHUP）并终止 Shell
+    bool detachable = session->detachable;
+    destroySession(session);
+    client->sendTextMessage("[WebSocket Bash] 已退出Shell，连接即将关闭\n");
+    if (detachable)
+    {
+        client->sendTextMessage(R"({"type":"session_closed"})");
+    }
+    client->close();
+}
+
+void WebSocketServer::reapDetachedSessions()
+{
+    bool detached = false;
+    for (TerminalSession *session : m_sessions.values())
+    {
+        if (session->client)
+        {
+            continue;
+        }
+        if (session->detachedAt.elapsed() >= TERM_DETACHED_TIMEOUT * 1000LL)
+        {
+            qInfo() << "终端会话断开超时，结束会话：" << session->id;
+            destroySession(session);
+            continue;
+        }
+        detached = true;
+    }
+    if (!detached)
+    {
+        m_reapTimer.stop();
+    }
+}
+
+bool WebSocketServer::evictOldestDetachedSession()
+{
+    TerminalSession *oldest = nullptr;
+    for (TerminalSession *session : m_sessions)
+    {
+        if (!session->client && session->scrollback.capacity() > 0 &&
+            (!oldest || session->detachedAt.elapsed() > oldest->detachedAt.elapsed()))
+        {
+            oldest = session;
+        }
+    }
+    if (!oldest)
+    {
+        return false;
+    }
+    qInfo() << "终端回滚缓冲达到上限，结束断开最久的会话：" << oldest->id;
+    destroySession(oldest);
+    return true;
+}
+
+// PTY 可读时（主线程）读取已有的输出，按大块读取，写入回滚缓冲，有客户端连接时累积后合并发送
+void WebSocketServer::readPtyOutput(TerminalSession *session)
+{
+    PtyOutput &output = session->output;
+    int        start  = output.pending.size();
+    bool       closed = false;
+    // 读到 EAGAIN 为止；单次最多 PTY_READ_MAX_BYTES，剩余的数据会再次触发可读通知
+    for (int total = 0; total < PTY_READ_MAX_BYTES;)
+    {
+        int offset = output.pending.size();
+        output.pending.resize(offset + PTY_READ_CHUNK_SIZE);
+        ssize_t bytesRead = read(session->ptyFd, output.pending.data() + offset, PTY_READ_CHUNK_SIZE);
+        output.pending.resize(offset + static_cast<int>(qMax<ssize_t>(bytesRead, 0)));
+        if (bytesRead > 0)
+        {
+            total += static_cast<int>(bytesRead);
+            continue;
         }
-        else if (bytesRead == 0)
+        if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
         {
-            qInfo() << "PTY 正常关闭（客户端：" << client->peerAddress().toString() << "）";
-            break;  // 退出循环，清理资源
+            break;
+        }
+        if (bytesRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        // Shell 退出后从端全部关闭，主端 read 返回 0 或 EIO
+        if (bytesRead == 0 || errno == EIO)
+        {
+            qInfo() << "PTY 正常关闭（会话：" << session->id << "）";
         }
         else
         {
-            // 3. 读取失败：判断错误类型
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-            {
-                // 关键修复：EAGAIN 是正常现象（无数据可读），忽略并继续
-                QThread::msleep(10);  // 短暂延时（10ms），避免 CPU 空转
-                continue;             // 跳过后续处理，回到循环继续读取
-            }
-            else
-            {
-                // 其他错误：真失败（如 FD 无效、PTY 断开）
-                qWarning() << "PTY 读取真错误：" << strerror(errno) << "（客户端：" << client->peerAddress().toString()
-                           << "，FD：" << ptyMasterFd << "）";
-                break;  // 退出循环，清理资源
-            }
+            qWarning() << "PTY 读取错误：" << strerror(errno) << "（会话：" << session->id << "，FD：" << session->ptyFd
+                       << "）";
         }
+        closed = true;
+        break;
     }
+    session->scrollback.append(output.pending.constData() + start, output.pending.size() - start);
 
-    // 触发客户端断开和资源清理
-    QMetaObject::invokeMethod(this, "closeClientConnection", Qt::QueuedConnection, Q_ARG(QWebSocket *, client));
+    QWebSocket *client = session->client;
+    if (!client)
+    {
+        // 没有客户端连接：输出只保留在回滚缓冲里；Shell 已退出则没有可以重新连接的内容了
+        output.pending.clear();
+        if (closed)
+        {
+            destroySession(session);
+        }
+        return;
+    }
+    if (closed)
+    {
+        // 停止监听（否则关闭前会不断触发可读），发出剩余输出后关闭连接，断开时结束会话
+        output.closed = true;
+        session->notifier->setEnabled(false);
+        flushPtyOutput(session);
+        // Shell 已退出（如输入 exit）：通知页面会话已结束，不再带着旧会话ID重连
+        if (session->detachable)
+        {
+            client->sendTextMessage(R"({"type":"session_closed"})");
+        }
+        closeClientConnection(client);
+        return;
+    }
+
+    // 空闲后的第一段输出（如按键回显）立即发送；持续输出时在合并窗口内累积，攒够 PTY_FLUSH_BYTES 再发
+    if (output.pending.size() >= PTY_FLUSH_BYTES || !output.lastFlush.isValid() ||
+        output.lastFlush.elapsed() >= PTY_FLUSH_INTERVAL)
+    {
+        flushPtyOutput(session);
+    }
+    else if (!output.pending.isEmpty() && !m_flushTimer.isActive())
+    {
+        m_flushTimer.start();
+    }
+}
+
+void WebSocketServer::flushPtyOutput(TerminalSession *session)
+{
+    PtyOutput  &output = session->output;
+    QWebSocket *client = session->client;
+    if (!client || output.pending.isEmpty())
+    {
+        return;
+    }
+    sendBinaryToClient(client, output.pending);
+    output.pending.clear();
+    output.lastFlush.start();
+
+    // 浏览器接收不过来时停止读取 PTY，Shell 写满 PTY 缓冲后会阻塞，而不是在服务端无限堆积
+    if (!output.paused && !output.closed && client->bytesToWrite() > PTY_HIGH_WATERMARK)
+    {
+        output.paused = true;
+        session->notifier->setEnabled(false);
+    }
+}
+
+void WebSocketServer::flushAllPtyOutput()
+{
+    for (TerminalSession *session : m_clientSessionMap.values())
+    {
+        flushPtyOutput(session);
+    }
+}
+
+void WebSocketServer::resumePtyIfDrained(TerminalSession *session)
+{
+    PtyOutput &output = session->output;
+    if (!output.paused || output.closed || session->client->bytesToWrite() > PTY_LOW_WATERMARK)
+    {
+        return;
+    }
+    output.paused = false;
+    session->notifier->setEnabled(true);
 }
 
 // 新客户端连接（修改：移除 QProcess，直接调用修复后的 createPtyAndStartShell）
@@ -348,10 +566,42 @@ void WebSocketServer::onNewConnection()
     //    connect(clientSocket, &QWebSocket::textMessageReceived, this, &WebSocketServer::onTextMessageReceived);
     connect(clientSocket, &QWebSocket::binaryMessageReceived, this, &WebSocketServer::onBinaryReceived);
     connect(clientSocket, &QWebSocket::disconnected, this, &WebSocketServer::onClientDisconnected);
+    connect(clientSocket, &QWebSocket::bytesWritten, this, [this, clientSocket](qint64) {
+        TerminalSession *session = m_clientSessionMap.value(clientSocket);
+        if (session)
+        {
+            resumePtyIfDrained(session);
+        }
+    });
     clientSocket->setParent(this);
 
+    // 带 session 参数（可以为空）的客户端支持断开后重新连接：?session=<会话ID>&offset=<已收到的输出字节数>
+    QUrlQuery        query(clientSocket->requestUrl());
+    bool             detachable = query.hasQueryItem("session");
+    TerminalSession *session    = m_sessions.value(query.queryItemValue("session"));
+    if (session)
+    {
+        // 同一会话的旧连接可能还没发现断开（半开连接），由新连接接管
+        // 旧页面仍在线时（如复制的标签页带着同一个会话ID）通知它会话已被接管，不再自动重连，否则两个页面会轮流抢占
+        if (session->client)
+        {
+            QWebSocket *oldClient = session->client;
+            m_clientSessionMap.remove(oldClient);
+            oldClient->disconnect(this);
+            oldClient->sendTextMessage(R"({"type":"session_taken"})");
+            oldClient->close();
+            // 等关闭握手完成后释放；半开连接收不到回应，超时后释放
+            connect(oldClient, &QWebSocket::disconnected, oldClient, &QObject::deleteLater);
+            QTimer::singleShot(TERM_CLOSE_TIMEOUT, oldClient, &QObject::deleteLater);
+        }
+        qInfo() << "WebSocketServer: 客户端" << clientAddr << "重新连接终端会话" << session->id;
+        attachSession(clientSocket, session, query.queryItemValue("offset").toULongLong());
+        return;
+    }
+
     // 绑定 PTY 并启动 Shell（无需 QProcess）
-    if (!createPtyAndStartShell(clientSocket))
+    session = createSession(clientSocket, detachable);
+    if (!session)
     {
         const QString errMsg = "[错误] 无法创建伪终端或启动 Shell，连接即将关闭\n";
         clientSocket->sendTextMessage(errMsg);
@@ -361,28 +611,13 @@ void WebSocketServer::onNewConnection()
         qWarning() << "WebSocketServer: 客户端" << clientAddr << "PTY创建失败，已关闭连接";
         return;
     }
-
-    // 启动子线程读取 PTY 输出
-    QThread *ptyReadThread          = new QThread(this);
-    m_clientThreadMap[clientSocket] = ptyReadThread;
-    connect(ptyReadThread, &QThread::started, [=]() {
-        qInfo() << "WebSocketServer: 客户端" << clientAddr << "PTY读取线程启动";
-        readPtyOutput(clientSocket);
-        qInfo() << "WebSocketServer: 客户端" << clientAddr << "PTY读取线程退出循环";
-    });
-    connect(clientSocket, &QWebSocket::disconnected, [=]() {
-        // 客户端断开时退出线程
-        ptyReadThread->quit();
-        ptyReadThread->wait(1000);
-        ptyReadThread->deleteLater();
-    });
-    ptyReadThread->start();
+    attachSession(clientSocket, session, 0);
 
     // 向客户端发送欢迎信息
     clientSocket->sendTextMessage("[WebSocket Bash (PTY模式)] 已连接（exit退出）\n");
 }
 
-// 客户端断开连接（修改：清理 Shell 进程和 PTY）
+// 客户端断开连接：可重新连接的会话保留，否则结束会话（关闭 PTY、终止 Shell）
 void WebSocketServer::onClientDisconnected()
 {
     QWebSocket *clientSocket = qobject_cast<QWebSocket *>(sender());
@@ -391,66 +626,20 @@ void WebSocketServer::onClientDisconnected()
 
     qInfo() << "WebSocketServer: 客户端断开连接：" << clientSocket->peerAddress().toString();
 
-    // ========== 1. 先关闭PTY（唤醒线程的阻塞IO） ==========
-    if (m_clientPtyMap.contains(clientSocket))
+    TerminalSession *session = m_clientSessionMap.value(clientSocket);
+    if (session)
     {
-        int ptyFd = m_clientPtyMap[clientSocket];
-        if (ptyFd >= 0)
+        if (session->detachable && !session->output.closed)
         {
-            if (close(ptyFd) == 0)
-            {
-                qInfo() << "PTY资源已释放（FD：" << ptyFd << "）";
-            }
-            else
-            {
-                qWarning() << "关闭PTY失败（FD：" << ptyFd << "），错误码：" << errno;
-            }
+            detachSession(session);
         }
-        m_clientPtyMap.remove(clientSocket);
-    }
-
-    // ========== 2. 再终止Shell进程（释放子进程资源） ==========
-    if (m_clientShellPidMap.contains(clientSocket))
-    {
-        pid_t shellPid = m_clientShellPidMap[clientSocket];
-        // 先发送SIGTERM优雅终止，失败则发送SIGKILL强制杀死
-        if (kill(shellPid, SIGTERM) != 0)
-        {
-            qWarning() << "优雅终止Shell进程失败，强制杀死（PID：" << shellPid << "）";
-            kill(shellPid, SIGKILL);
-        }
-        // 非阻塞回收子进程（避免waitpid阻塞主线程）
-        int status = 0;
-        waitpid(shellPid, &status, WNOHANG);
-        qInfo() << "已终止Shell进程（PID：" << shellPid << "），退出状态：" << status;
-        m_clientShellPidMap.remove(clientSocket);
-    }
-
-    // ========== 3. 最后停止并回收工作线程（此时线程已从阻塞中唤醒） ==========
-    if (m_clientThreadMap.contains(clientSocket))
-    {
-        QThread *workerThread = m_clientThreadMap[clientSocket];
-        if (workerThread && workerThread->isRunning())
+        else
         {
-            // 向工作线程发送退出信号（需工作线程实现响应逻辑）
-            //            QMetaObject::invokeMethod(workerThread->findChild<ShellWorker *>(), "onQuit", Qt::QueuedConnection);
-
-            // 安全停止线程：先请求退出，再等待结束
-            workerThread->quit();
-            // 延长超时时间至2秒（给线程足够时间处理退出）
-            if (!workerThread->wait(2000))
-            {
-                qWarning() << "线程退出超时，强制终止：" << workerThread;
-                workerThread->terminate();
-                workerThread->wait();
-            }
+            destroySession(session);
         }
-        workerThread->deleteLater();
-        m_clientThreadMap.remove(clientSocket);
-        qInfo() << "客户端关联线程已回收";
     }
 
-    // ========== 4. 延迟释放客户端Socket ==========
+    // 延迟释放客户端Socket
     clientSocket->disconnect();
     clientSocket->deleteLater();
     qInfo() << "客户端Socket已标记为延迟释放";
@@ -459,8 +648,9 @@ void WebSocketServer::onClientDisconnected()
 // 接收客户端输入（原有逻辑不变，保留）
 void WebSocketServer::onTextMessageReceived(const QString &message)
 {
-    QWebSocket *clientSocket = qobject_cast<QWebSocket *>(sender());
-    if (!clientSocket || !m_clientPtyMap.contains(clientSocket))
+    QWebSocket      *clientSocket = qobject_cast<QWebSocket *>(sender());
+    TerminalSession *session      = m_clientSessionMap.value(clientSocket);
+    if (!clientSocket || !session)
         return;
 
     qInfo() << "收到客户端指令：" << message << "（客户端：" << clientSocket->peerAddress().toString() << "）";
@@ -468,20 +658,12 @@ void WebSocketServer::onTextMessageReceived(const QString &message)
     // 处理退出指令
     if (message.trimmed().toLower() == "exit")
     {
-        // 终止 Shell 进程
-        if (m_clientShellPidMap.contains(clientSocket))
-        {
-            pid_t shellPid = m_clientShellPidMap[clientSocket];
-            kill(shellPid, SIGTERM);
-            waitpid(shellPid, nullptr, WNOHANG);
-        }
-        clientSocket->sendTextMessage("[WebSocket Bash] 已退出Shell，连接即将关闭\n");
-        clientSocket->close();
+        exitSession(clientSocket, session);
         return;
     }
 
     // 将输入写入 PTY（触发 Shell 执行命令）
-    int        ptyMasterFd = m_clientPtyMap[clientSocket];
+    int        ptyMasterFd = session->ptyFd;
     QByteArray input       = message.toUtf8() + "\n";  // 加换行符提交命令
     ssize_t    writeLen    = write(ptyMasterFd, input.data(), input.size());
     if (writeLen != input.size())
@@ -494,29 +676,20 @@ void WebSocketServer::onTextMessageReceived(const QString &message)
 
 void WebSocketServer::onBinaryReceived(const QByteArray &binary)
 {
-    QWebSocket *clientSocket = qobject_cast<QWebSocket *>(sender());
-    if (!clientSocket || !m_clientPtyMap.contains(clientSocket))
+    QWebSocket      *clientSocket = qobject_cast<QWebSocket *>(sender());
+    TerminalSession *session      = m_clientSessionMap.value(clientSocket);
+    if (!clientSocket || !session)
         return;
 
-    qInfo() << "收到客户端指令：bin " << binary << "（客户端：" << clientSocket->peerAddress().toString() << "）";
-
     // 处理退出指令
     if (QString(binary).toLower() == "exit")
     {
-        // 终止 Shell 进程
-        if (m_clientShellPidMap.contains(clientSocket))
-        {
-            pid_t shellPid = m_clientShellPidMap[clientSocket];
-            kill(shellPid, SIGTERM);
-            waitpid(shellPid, nullptr, WNOHANG);
-        }
-        clientSocket->sendTextMessage("[WebSocket Bash] 已退出Shell，连接即将关闭\n");
-        clientSocket->close();
+        exitSession(clientSocket, session);
         return;
     }
 
     // 将输入写入 PTY（触发 Shell 执行命令）
-    int ptyMasterFd = m_clientPtyMap[clientSocket];
+    int ptyMasterFd = session->ptyFd;
     //    QByteArray input       = message.toUtf8() + "\n";  // 加换行符提交命令
     QByteArray input    = binary + '\n';
     ssize_t    writeLen = write(ptyMasterFd, input.data(), input.size());
@@ -578,16 +751,13 @@ void WebSocketServer::sendBinaryToClient(QWebSocket *client, const QByteArray &b
     // 主线程中验证连接状态并发送
     if (client->state() == QAbstractSocket::ConnectedState)
     {
+        // 终端输出的热路径，成功时不记录日志（更不输出内容）
         qint64 sentLen = client->sendBinaryMessage(binary);
         if (sentLen <= 0)
         {
             qWarning() << "主线程发送消息失败（客户端：" << client->peerAddress().toString() << "），错误："
                        << client->errorString();
         }
-        else
-        {
-            qDebug().noquote() << "[主线程→客户端] bin（发送长度：" << sentLen << "）\n" << binary;
-        }
     }
     else
     {
@@ -6,8 +6,11 @@
 #include <QWebSocket>
 #include <QMap>
 #include <QProcess>
+#include <QTimer>
 #include <sys/types.h>  // 新增：pid_t 所需头文件
 
+#include "TerminalSession.h"
+
 class WebSocketServer : public QObject
 {
     Q_OBJECT
@@ -30,16 +33,36 @@ private slots:
     void sendBinaryToClient(QWebSocket *client, const QByteArray &binary);
 
 private:
-    bool createPtyAndStartShell(QWebSocket *client);  // 修改：移除 QProcess 参数
-    void readPtyOutput(QWebSocket *client);
+    bool createPtyAndStartShell(QWebSocket *client, TerminalSession *session);  // 修改：移除 QProcess 参数
+
+    // 会话管理：新建会话、客户端连接到会话（补发 offset 之后的输出）、客户端断开后保留会话、结束会话
+    TerminalSession *createSession(QWebSocket *client, bool detachable);
+    void             attachSession(QWebSocket *client, TerminalSession *session, quint64 offset);
+    void             detachSession(TerminalSession *session);
+    void             destroySession(TerminalSession *session);
+    // 客户端输入 exit：结束会话并关闭连接
+    void exitSession(QWebSocket *client, TerminalSession *session);
+    // 结束断开超时的会话；回滚缓冲总量达到上限时结束断开最久的会话
+    void reapDetachedSessions();
+    bool evictOldestDetachedSession();
+
+    void readPtyOutput(TerminalSession *session);
+    // 发送会话累积的输出，发送缓冲超过高水位时暂停读取 PTY
+    void flushPtyOutput(TerminalSession *session);
+    void flushAllPtyOutput();
+    // 发送缓冲降到低水位后恢复读取 PTY
+    void resumePtyIfDrained(TerminalSession *session);
 
     QWebSocketServer *m_wsServer = nullptr;
     QString           m_listenIp;
     quint16           m_listenPort = 0;
 
-    static QMap<QWebSocket *, int> m_clientPtyMap;       // 客户端 → PTY Master FD（已存在）
-    QMap<QWebSocket *, pid_t>      m_clientShellPidMap;  // 新增：客户端 → Shell 进程 PID
-    QMap<QWebSocket *, QThread *>  m_clientThreadMap;  // 客户端-工作线程映射（新增：管理通信线程）
+    // 所有 PTY 由主线程事件循环统一监听（每个会话一个 QSocketNotifier），有输出时才读取，空闲终端不占 CPU
+    QMap<QString, TerminalSession *>      m_sessions;             // 会话ID → 会话
+    QMap<QWebSocket *, TerminalSession *> m_clientSessionMap;     // 客户端 → 连接的会话
+    QTimer                                m_flushTimer;           // 合并窗口结束时发送所有会话累积的输出
+    QTimer                                m_reapTimer;            // 定期结束断开超时的会话
+    int                                   m_scrollbackBytes = 0;  // 所有会话回滚缓冲的总容量
 };
 
 #endif  // WEBSOCKETSERVER_H
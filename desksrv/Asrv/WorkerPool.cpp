@@ -0,0 +1,18 @@
+#include "WorkerPool.h"
+#include <QDebug>
+
+#include "def.h"
+#include "tool.h"
+
+QThreadPool *WorkerPool::instance()
+{
+    // 与 I/O 线程分开，避免耗时任务占满 I/O 线程；程序退出时等待未完成的任务
+    static QThreadPool pool;
+    static bool        configured = []() {
+        pool.setMaxThreadCount(configuredThreadCount("ASRV_WORKER_THREADS", HTTP_WORKER_THREADS));
+        qInfo() << "HTTP 工作线程数：" << pool.maxThreadCount();
+        return true;
+    }();
+    Q_UNUSED(configured)
+    return &pool;
+}
@@ -0,0 +1,33 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+// CPU密集型任务（图片编码、目录页面生成等）的工作线程池
+// I/O线程只负责收发数据，耗时的计算放到这里执行，完成后回到 context 所在线程继续处理
+class WorkerPool
+{
+public:
+    static QThreadPool *instance();
+
+    /**
+     * @brief 在工作线程执行 work，完成后在 context 所在线程调用 done(result)
+     * context 在任务完成前被释放（如客户端断开、socket已删除）时不再调用 done
+     * @param work 只能使用按值捕获的数据，不能访问 context 及其子对象
+     */
+    template <typename T, typename Work, typename Done>
+    static void run(QObject *context, Work work, Done done)
+    {
+        QFutureWatcher<T> *watcher = new QFutureWatcher<T>(context);
+        QObject::connect(watcher, &QFutureWatcherBase::finished, watcher, [watcher, done]() {
+            done(watcher->result());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run(instance(), work));
+    }
+};
+
+#endif  // WORKERPOOL_H
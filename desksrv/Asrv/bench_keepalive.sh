@@ -0,0 +1,78 @@
+#!/bin/bash
+# HTTP 长连接压测：对运行中的 Asrv 比较三种方式发送 N 个 GET 请求的耗时
+#   1. 每个请求新建连接（Connection: close）
+#   2. 同一连接顺序发送（keep-alive，等上一个响应结束再发下一个）
+#   3. 同一连接流水线发送（一次写入所有请求，再读回所有响应）
+# 用法：./bench_keepalive.sh [host] [port] [requests] [path]
+# 依赖 curl；流水线模式使用 bash 的 /dev/tcp
+
+HOST=${1:-127.0.0.1}
+PORT=${2:-8080}
+COUNT=${3:-1000}
+REQ_PATH=${4:-/css/style.css}
+# 与 def.h 中 HTTP_KEEP_ALIVE_MAX 一致：服务端每个连接最多处理的请求数，流水线按此分批
+KEEP_ALIVE_MAX=200
+
+URL="http://$HOST:$PORT$REQ_PATH"
+
+now_ns() {
+    date +%s%N
+}
+
+# 输出：方式 请求数 连接数 耗时 每秒请求数
+report() {
+    local name=$1 requests=$2 connects=$3 start=$4 end=$5
+    local ms=$(( (end - start) / 1000000 ))
+    [ "$ms" -le 0 ] && ms=1
+    printf "%-24s 请求=%-6d 连接=%-6d 耗时=%6dms  %8d req/s\n" \
+        "$name" "$requests" "$connects" "$ms" $(( requests * 1000 / ms ))
+}
+
+# curl 的 URL 通配 [1-N] 在同一进程内依次请求，能复用时复用连接；num_connects 统计实际新建的连接数
+run_curl() {
+    local name=$1
+    shift
+    local start end connects
+    start=$(now_ns)
+    connects=$(curl -s -o /dev/null -w '%{num_connects}\n' "$@" "$URL?n=[1-$COUNT]" | awk '{ s += $1 } END { print s }')
+    end=$(now_ns)
+    report "$name" "$COUNT" "$connects" "$start" "$end"
+}
+
+run_pipelined() {
+    local start end sent=0 connects=0 responses=0
+    start=$(now_ns)
+    while [ "$sent" -lt "$COUNT" ]; do
+        local batch=$(( COUNT - sent ))
+        [ "$batch" -gt "$KEEP_ALIVE_MAX" ] && batch=$KEEP_ALIVE_MAX
+        local request="GET $REQ_PATH HTTP/1.1\r\nHost: $HOST:$PORT\r\n\r\n"
+        local requests=""
+        for ((i = 1; i < batch; ++i)); do
+            requests+=$request
+        done
+        # 最后一个请求要求关闭连接，读到 EOF 即所有响应都已返回
+        requests+="GET $REQ_PATH HTTP/1.1\r\nHost: $HOST:$PORT\r\nConnection: close\r\n\r\n"
+
+        exec 3<>"/dev/tcp/$HOST/$PORT" || exit 1
+        printf "%b" "$requests" >&3
+        responses=$(( responses + $(grep -ac '^HTTP/1.1 200' <&3) ))
+        exec 3<&-
+        sent=$(( sent + batch ))
+        connects=$(( connects + 1 ))
+    done
+    end=$(now_ns)
+    report "pipelined" "$COUNT" "$connects" "$start" "$end"
+    if [ "$responses" -ne "$COUNT" ]; then
+        echo "流水线模式只收到 $responses 个 200 响应（期望 $COUNT）"
+    fi
+}
+
+if ! curl -s -o /dev/null -f "$URL"; then
+    echo "无法访问 $URL，请先启动 Asrv"
+    exit 1
+fi
+
+echo "目标：$URL，每种方式 $COUNT 个请求"
+run_curl "connection per request" -H "Connection: close"
+run_curl "keep-alive sequential"
+run_pipelined
@@ -1,6 +1,7 @@
 #ifndef DEF_H
 #define DEF_H
 #include <QString>
+#include <QMap>
 // 全局常量：MIME 类型映射（静态常量，仅初始化一次）
 static const QMap<QString, QString> MIME_MAP = []() -> QMap<QString, QString> {
     QMap<QString, QString> map;
@@ -38,6 +39,86 @@ static const QMap<QString, QString> MIME_MAP = []() -> QMap<QString, QString> {
 // 1MB = 1024 * 1024 字节，10MB = 10 * 1024 * 1024
 const int MAX_PREVIEW_SIZE = 10 * 1024 * 1024;
 const int MAX_REQUEST_SIZE = 200 * 1024 * 1024;
+// 请求行 + 请求头的最大长度
+const int MAX_HEADER_SIZE = 64 * 1024;
+// 上传表单中普通字段（非文件）的最大长度，字段值缓存在内存中
+const int MAX_FORM_FIELD_SIZE = 64 * 1024;
+// HTTP长连接：空闲超时（秒）和单连接最大请求数
+const int HTTP_KEEP_ALIVE_TIMEOUT = 15;
+const int HTTP_KEEP_ALIVE_MAX     = 200;
+// 文件下载：单次 sendfile/read 的块大小，以及每轮事件循环最多发送的块数
+const int FILE_SEND_CHUNK_SIZE       = 256 * 1024;
+const int FILE_SEND_CHUNKS_PER_ROUND = 16;
+// socket 写满时交给 QTcpSocket 发送的数据量：由 socket 自己的可写通知触发 bytesWritten 后继续 sendfile
+const int FILE_SEND_WAKEUP_SIZE = 4 * 1024;
+// Range 请求最多接受的范围数，超过时忽略 Range 返回完整文件
+const int MAX_RANGE_COUNT = 16;
+// 响应体不超过该大小时和响应头合并为一次写入
+const int HTTP_COALESCE_LIMIT = 64 * 1024;
+// www 资源：不小于该大小的文本资源才预压缩
+const int STATIC_COMPRESS_MIN_SIZE = 1024;
+// 目录列表：缓存排序索引的目录数，JSON 分页默认/最大条数
+const int DIR_INDEX_CACHE_SIZE = 64;
+const int DIR_LIST_PAGE_SIZE   = 200;
+const int DIR_LIST_PAGE_MAX    = 1000;
+// 目录列表：项数超过该值时 HTML 以 chunked 方式分批输出，每批行数，以及socket写缓冲水位
+const int DIR_LIST_STREAM_MIN    = 2000;
+const int DIR_LIST_STREAM_BATCH  = 256;
+const int DIR_LIST_STREAM_BUFFER = 256 * 1024;
+// HTTP I/O线程数和工作线程数（0 表示按CPU核数），可用环境变量 ASRV_IO_THREADS / ASRV_WORKER_THREADS 覆盖
+const int HTTP_IO_THREADS     = 0;
+const int HTTP_WORKER_THREADS = 0;
+// /$$rtc 推流：帧间隔（毫秒），单个客户端写缓冲积压超过该大小时丢帧
+const int RTC_FRAME_INTERVAL    = 40;
+const int RTC_MAX_PENDING_BYTES = 2 * 1024 * 1024;
+// 屏幕推流拥塞控制：目标延迟和帧间隔范围（毫秒），JPG质量范围和步长，最小缩放比例和步长（百分比）
+const int SCREEN_TARGET_LATENCY = 150;
+const int SCREEN_MIN_INTERVAL   = 15;
+const int SCREEN_MAX_INTERVAL   = 500;
+const int SCREEN_MAX_QUALITY    = 90;
+const int SCREEN_MIN_QUALITY    = 30;
+const int SCREEN_QUALITY_STEP   = 10;
+const int SCREEN_MIN_SCALE      = 50;
+const int SCREEN_SCALE_STEP     = 25;
+// 屏幕推流拥塞控制：最多未确认帧数、发送队列积压上限，调整周期和降级后多久才允许恢复（毫秒）
+const int SCREEN_MAX_INFLIGHT      = 4;
+const int SCREEN_MAX_PENDING_BYTES = 2 * 1024 * 1024;
+const int SCREEN_ADJUST_INTERVAL   = 250;
+const int SCREEN_UPGRADE_HOLD      = 1000;
+// 屏幕差分：比较的分块边长（像素），每帧最多发送的矩形数，最多保留的历史帧数
+const int SCREEN_DIFF_TILE     = 64;
+const int SCREEN_MAX_PATCHES   = 8;
+const int SCREEN_FRAME_HISTORY = 16;
+// 屏幕截屏/编码流水线中最多同时处理的帧数
+const int SCREEN_PIPELINE_DEPTH = 3;
+// 光标叠加层：光标位置的轮询间隔（毫秒）
+const int CURSOR_POLL_INTERVAL = 16;
+// 屏幕视频流（ffmpeg libx264）：标称帧率、CRF 质量、关键帧间隔（帧）
+const int VIDEO_STREAM_FPS = 30;
+const int VIDEO_STREAM_CRF = 28;
+const int VIDEO_STREAM_GOP = 120;
+// 远程输入：鼠标移动的合并周期（毫秒，约一个屏幕刷新间隔），注入延迟统计的日志周期（毫秒）
+const int INPUT_MOVE_INTERVAL  = 16;
+const int INPUT_STATS_INTERVAL = 10000;
+// 单个滚轮事件最多注入的步数（与实际滚轮一次连续滚动相当），步数来自客户端消息，不能直接信任
+const int INPUT_WHEEL_MAX_STEPS = 10;
+// 注入队列积压到这个数量后丢弃新的鼠标移动，剩余空间留给按键/滚轮事件
+const int INPUT_QUEUE_MOVE_LIMIT = 768;
+// 终端：PTY 每次 read 的缓冲大小，一次可读通知最多读取的字节数（超过则留到下一次通知，避免一个终端独占主线程）
+const int PTY_READ_CHUNK_SIZE = 64 * 1024;
+const int PTY_READ_MAX_BYTES  = 256 * 1024;
+// 终端输出合并：累计到该大小立即发送，否则距上次发送至少间隔 PTY_FLUSH_INTERVAL 毫秒（空闲后的第一段输出立即发送）
+// 发送缓冲超过高水位时暂停读取 PTY（Shell 写满 PTY 后自然阻塞），降到低水位后恢复
+const int PTY_FLUSH_BYTES    = 32 * 1024;
+const int PTY_FLUSH_INTERVAL = 5;
+const int PTY_HIGH_WATERMARK = 1024 * 1024;
+const int PTY_LOW_WATERMARK  = 256 * 1024;
+// 终端会话：单个会话的回滚缓冲大小，所有会话回滚缓冲的总上限，客户端断开后会话保留的时间（秒）
+const int TERM_SCROLLBACK_SIZE  = 256 * 1024;
+const int TERM_SCROLLBACK_TOTAL = 32 * 1024 * 1024;
+const int TERM_DETACHED_TIMEOUT = 30 * 60;
+// 被接管的旧连接等待关闭握手的时间（毫秒）
+const int TERM_CLOSE_TIMEOUT = 5000;
 
 #define REQ_TEST QS("/$$test")
 #define REQ_SCREEN QS("/$$screen")
@@ -47,6 +128,7 @@ const int MAX_REQUEST_SIZE = 200 * 1024 * 1024;
 #define REQ_CTRL QS("/$$ctrl")
 #define REQ_XTERM QS("/$$xterm")
 #define REQ_SCREEN_CTRL QS("/$$scc")
+#define REQ_METRICS QS("/$$metrics")
 
 
 
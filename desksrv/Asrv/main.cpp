@@ -126,6 +126,8 @@ int main(int argc, char *argv[])
         return 1;
     }
     QApplication a(argc, argv);
+    // 对端关闭后继续 sendfile 会触发 SIGPIPE，忽略该信号，由返回值 EPIPE 处理
+    signal(SIGPIPE, SIG_IGN);
     QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
 
     // 注册日志监听
@@ -24,9 +24,28 @@
 #include <sys/wait.h>
 
 #include "unicode.h"
-
-QByteArray readTemplate(const QString &templateName, const QMap<QString, QString> &variables)
+#include "HttpConnection.h"
+#include "StaticCache.h"
+#include "DirListing.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QThread>
+#include <QLocale>
+#include <cstring>
+#include <zlib.h>
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+HtmlTemplate compiledTemplate(const QString &templateName)
 {
+    // 优先使用www资源缓存中预编译的模板，未缓存时再读磁盘
+    StaticCache::EntryPtr entry = StaticCache::instance()->find("/" + templateName);
+    if (entry && !entry->compiled.isEmpty())
+    {
+        return entry->compiled;
+    }
+
     // 模板文件路径（放在www目录下）
     QString templatePath = QCoreApplication::applicationDirPath() + "/www/" + templateName;
     QFile   templateFile(templatePath);
@@ -35,27 +54,49 @@ QByteArray readTemplate(const QString &templateName, const QMap<QString, QString
     if (!templateFile.open(QIODevice::ReadOnly))
     {
         qWarning() << "模板文件不存在：" << templatePath;
-        return "模板文件加载失败：" + templateName.toUtf8();
+        return HtmlTemplate("模板文件加载失败：" + templateName.toUtf8());
     }
 
     // 读取模板内容
     QByteArray templateContent = templateFile.readAll();
     templateFile.close();
+    return HtmlTemplate(templateContent);
+}
+
+QByteArray readTemplate(const QString &templateName, const QMap<QString, QString> &variables)
+{
+    return compiledTemplate(templateName).render(variables);
+}
 
-    // 替换所有占位符
-    QString contentStr = QString(templateContent);
-    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it)
+// 渲染目录列表页面（fileListHtml 为文件列表部分）
+static QByteArray renderDirListPage(const QString    &dirPath,
+                                    const QString    &rootDir,
+                                    const QString    &requestPath,
+                                    const QByteArray &fileListHtml)
+{
+    // 1. 构建上级目录HTML片段
+    QByteArray parentDirHtml;
+    if (dirPath != rootDir)
     {
-        contentStr.replace("{{" + it.key() + "}}", it.value());
+        parentDirHtml = dirListParentRow(requestPath);
     }
 
-    return contentStr.toUtf8();
+    // 2. 定义模板变量
+    QHash<QByteArray, QByteArray> variables;
+    variables["DIR_PATH"]     = dirPath.toUtf8();      // 服务端实际路径
+    variables["REQUEST_PATH"] = requestPath.toUtf8();  // HTTP请求路径
+    variables["PARENT_DIR"]   = parentDirHtml;         // 上级目录HTML
+    variables["FILE_LIST"]    = fileListHtml;          // 文件列表HTML
+
+    // 3. 渲染模板
+    return compiledTemplate("dir_list.html").render(variables);
 }
 
 QByteArray generateDirListHtml(const QString &dirPath, const QString &rootDir, const QString &requestPath)
 {
-    QDir dir(dirPath);
-    if (!dir.exists())
+    // 读取目录的排序索引（目录未变化时直接使用缓存）
+    DirIndexPtr index = loadDirIndex(dirPath);
+    if (!index)
     {
         // 使用404模板
         QMap<QString, QString> vars;
@@ -63,79 +104,34 @@ QByteArray generateDirListHtml(const QString &dirPath, const QString &rootDir, c
         return readTemplate("404.html", vars);
     }
 
-    // 读取目录文件列表
-    dir.setFilter(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
-    dir.setSorting(QDir::DirsFirst | QDir::Name | QDir::IgnoreCase);
-    QFileInfoList fileList = dir.entryInfoList();
+    // 构建文件列表HTML片段（按字节追加，不经过QString）
+    DirListRowWriter writer(dirPath, rootDir, requestPath);
+    QByteArray       fileListHtml;
+    for (const DirEntry &entry : index->entries)
+    {
+        writer.append(fileListHtml, entry);
+    }
+    return renderDirListPage(dirPath, rootDir, requestPath, fileListHtml);
+}
 
-    // 1. 构建上级目录HTML片段
-    QString parentDirHtml = "";
-    if (dirPath != rootDir)
+void dirListPageParts(const QString &dirPath,
+                      const QString &rootDir,
+                      const QString &requestPath,
+                      QByteArray    &head,
+                      QByteArray    &tail)
+{
+    // 文件列表位置先填入标记（含 \0，不会出现在路径中），再从标记处切开
+    static const QByteArray marker("\0FILE_LIST\0", 11);
+    QByteArray              page = renderDirListPage(dirPath, rootDir, requestPath, marker);
+    int                     pos  = page.indexOf(marker);
+    if (pos < 0)
     {
-        QString parentRequestPath =
-            requestPath.endsWith("/") ? requestPath.left(requestPath.length() - 1) : requestPath;
-        parentRequestPath =
-            parentRequestPath.lastIndexOf("/") > 0 ? parentRequestPath.left(parentRequestPath.lastIndexOf("/")) : "/";
-        QString icon  = DIR_ICON;
-        parentDirHtml = QString(R"(
-                                <li class="file-item" >
-                                <span class="dir-icon">%1</span>
-                                <a href="%2">../ (上级目录)</a>
-                                </li>
-                                )")
-                            .arg(icon)
-                            .arg(parentRequestPath);
-    }
-
-    // 2. 构建文件列表HTML片段
-    QString fileListHtml = "";
-    for (const QFileInfo &fileInfo : fileList)
-    {
-        bool    isDir    = fileInfo.isDir();
-        QString fileName = fileInfo.fileName();
-        QString fileUrl  = requestPath.endsWith("/") ? requestPath + fileName : requestPath + "/" + fileName;
-        QString fileSize = fileInfo.isDir() ? "目录" : QString("%1 KB").arg(fileInfo.size() / 1024);
-        // 新增：获取并格式化修改时间（yyyy-MM-dd HH:mm:ss 格式，可按需调整）
-        QString modifyTime   = fileInfo.lastModified().toString("yyyy-MM-dd HH:mm:ss");
-        QString icon         = isDir ? DIR_ICON : FILE_ICON;
-        QString diritem      = isDir ? "dir-item" : "";
-        QString strFilePath  = "/" + QDir(rootDir).relativeFilePath(fileInfo.absoluteFilePath());
-        QString datafilepath = isDir ? "" : QString("data-file-path=\"%1\"").arg(strFilePath);
-        QString iconclass    = isDir ? "dir" : "file";
-        QString downloadBtn =
-            isDir ? "" : QString(R"(<button class="download-btn" data-file-path="%1">下载</button>)").arg(strFilePath);
-
-        // 修改：在HTML中插入修改时间<span class="file-modify-time">%7</span>，调整占位符顺序
-        fileListHtml += QString(R"(
-                                <li class="file-item %1" %2>
-                                <span class="%3-icon">%4</span>
-                                <a href="%5">%6</a>
-                                <span class="file-modify-time">%7</span>
-                                <span class="file-size">%8</span>
-                                %9
-                                </li>
-                                )")
-                            .arg(diritem)
-                            .arg(datafilepath)
-                            .arg(iconclass)
-                            .arg(icon)
-                            .arg(fileUrl)
-                            .arg(fileName)
-                            .arg(modifyTime)    // 第7个占位符：修改时间
-                            .arg(fileSize)      // 第8个占位符：文件大小
-                            .arg(downloadBtn);  // 第9个占位符：下载按钮
-    }
-
-    // 3. 定义模板变量
-    QMap<QString, QString> variables;
-    variables["DIR_PATH"]     = dirPath;        // 服务端实际路径
-    variables["REQUEST_PATH"] = requestPath;    // HTTP请求路径
-    variables["PARENT_DIR"]   = parentDirHtml;  // 上级目录HTML
-    variables["FILE_LIST"]    = fileListHtml;   // 文件列表HTML
-                                                //    variables["JS_PATH"] = getStaticPath(EM_DIR::JS); // js文件
-
-    // 4. 读取模板并替换变量
-    return readTemplate("dir_list.html", variables);
+        head = page;
+        tail.clear();
+        return;
+    }
+    head = page.left(pos);
+    tail = page.mid(pos + marker.size());
 }
 
 bool isValidPath(const QString &filePath, const QString &rootDir)
@@ -253,6 +249,21 @@ QString formatFileSize(qint64 bytes)
     return QString("%1 GB").arg(bytes / (1024.0 * 1024 * 1024), 0, 'f', 1);
 }
 
+int configuredThreadCount(const char *envName, int defaultCount)
+{
+    bool ok    = false;
+    int  count = qEnvironmentVariableIntValue(envName, &ok);
+    if (!ok || count < 0)
+    {
+        count = defaultCount;
+    }
+    if (count <= 0)
+    {
+        count = QThread::idealThreadCount();
+    }
+    return qMax(count, 1);
+}
+
 QString decodeFilePath(const QString &encodedPath)
 {
     // 1. 将 QString 转换为 QByteArray（UTF-8 格式）
@@ -261,36 +272,29 @@ QString decodeFilePath(const QString &encodedPath)
     return QUrl::fromPercentEncoding(encodedBytes);
 }
 
-QByteArray parseChunkedData(const QByteArray &data)
+QByteArray httpStatusLine(int statusCode)
 {
-    QByteArray body;
-    int        pos = data.indexOf("\r\n\r\n") + 4;  // 跳过请求头
-    if (pos < 4)
-        return body;
-
-    QByteArray chunkData = data.mid(pos);
-    while (!chunkData.isEmpty())
-    {
-        // 提取块大小（十六进制）
-        int chunkSizeEnd = chunkData.indexOf("\r\n");
-        if (chunkSizeEnd == -1)
-            break;
-        QByteArray chunkSizeStr = chunkData.left(chunkSizeEnd).trimmed();
-        bool       ok;
-        int        chunkSize = chunkSizeStr.toInt(&ok, 16);
-        if (!ok || chunkSize == 0)
-            break;  // 块大小为0表示结束
-
-        // 提取块数据
-        int        chunkDataStart = chunkSizeEnd + 2;
-        QByteArray chunk          = chunkData.mid(chunkDataStart, chunkSize);
-        body.append(chunk);
-
-        // 移动到下一个块（跳过当前块的\r\n）
-        chunkData = chunkData.mid(chunkDataStart + chunkSize + 2);
-    }
-
-    return body;
+    // 常用状态码描述（静态常量，仅初始化一次）
+    static const QMap<int, QByteArray> STATUS_TEXT_MAP = {
+        {100, "Continue"},
+        {200, "OK"},
+        {206, "Partial Content"},
+        {304, "Not Modified"},
+        {400, "Bad Request"},
+        {403, "Forbidden"},
+        {404, "Not Found"},
+        {405, "Method Not Allowed"},
+        {408, "Request Timeout"},
+        {413, "Payload Too Large"},
+        {416, "Range Not Satisfiable"},
+        {431, "Request Header Fields Too Large"},
+        {500, "Internal Server Error"},
+        {501, "Not Implemented"},
+        {503, "Service Unavailable"},
+        {505, "HTTP Version Not Supported"},
+    };
+    return "HTTP/1.1 " + QByteArray::number(statusCode) + " " + STATUS_TEXT_MAP.value(statusCode, "Unknown") +
+           "\r\n";
 }
 
 void sendErrorResponse(QTcpSocket *socket, int statusCode, const QString &message)
@@ -302,6 +306,65 @@ void sendErrorResponse(QTcpSocket *socket, int statusCode, const QString &messag
     sendJsonResponse(socket, statusCode, message);
 }
 
+QByteArray httpResponseHeader(QTcpSocket       *socket,
+                              int               statusCode,
+                              const QByteArray &contentType,
+                              qint64            contentLength,
+                              const QByteArray &extraHeaders)
+{
+    HttpConnection *connection = HttpConnection::fromSocket(socket);
+
+    // 构建响应头（关键：Content-Length 为响应体的字节数）
+    QByteArray header = httpStatusLine(statusCode);
+    header += "Content-Type: " + contentType + "\r\n";
+    if (contentLength < 0)
+    {
+        header += "Transfer-Encoding: chunked\r\n";
+    }
+    else
+    {
+        header += "Content-Length: " + QByteArray::number(contentLength) + "\r\n";
+    }
+    header += extraHeaders;
+    header += connection ? connection->connectionHeader() : QByteArray("Connection: close\r\n");
+    header += "\r\n";
+    return header;
+}
+
+void sendHttpResponse(QTcpSocket       *socket,
+                      int               statusCode,
+                      const QByteArray &contentType,
+                      const QByteArray &body,
+                      const QByteArray &extraHeaders)
+{
+    HttpConnection *connection = HttpConnection::fromSocket(socket);
+
+    QByteArray header = httpResponseHeader(socket, statusCode, contentType, body.size(), extraHeaders);
+    if (body.size() <= HTTP_COALESCE_LIMIT)
+    {
+        // 小响应合并为一次写入
+        header.reserve(header.size() + body.size());
+        header += body;
+        socket->write(header);
+    }
+    else
+    {
+        // 响应头和响应体分开写入，避免大响应体再拼接一次
+        socket->write(header);
+        socket->write(body);
+    }
+    socket->flush();
+
+    if (connection)
+    {
+        connection->finishResponse();
+    }
+    else
+    {
+        socket->disconnectFromHost();
+    }
+}
+
 void sendJsonResponse(QTcpSocket *socket, int statusCode, const QString &message)
 {
     // 构建响应体（先构建，再计算长度）
@@ -310,33 +373,234 @@ void sendJsonResponse(QTcpSocket *socket, int statusCode, const QString &message
     responseJson["message"] = message;
     QByteArray responseBody = QJsonDocument(responseJson).toJson(QJsonDocument::Compact);
     qDebug().noquote() << "Response: " << QString::fromUtf8(responseBody);
-    QByteArray response;
-    // 构建状态行
-    if (statusCode == 200)
+
+    sendHttpResponse(socket, statusCode, "application/json; charset=UTF-8", responseBody);
+}
+
+void sendNotModified(QTcpSocket *socket, const QByteArray &extraHeaders)
+{
+    HttpConnection *connection = HttpConnection::fromSocket(socket);
+
+    // 304 不能带响应体，也不带 Content-Length（避免缓存把长度更新为 0）
+    QByteArray header = httpStatusLine(304);
+    header += extraHeaders;
+    header += connection ? connection->connectionHeader() : QByteArray("Connection: close\r\n");
+    header += "\r\n";
+    socket->write(header);
+    socket->flush();
+
+    if (connection)
     {
-        response += "HTTP/1.1 200 OK\r\n";
+        connection->finishResponse();
     }
-    else if (statusCode == 400)
+    else
     {
-        response += "HTTP/1.1 400 Bad Request\r\n";
+        socket->disconnectFromHost();
     }
-    else if (statusCode == 500)
+}
+
+QByteArray httpDate(const QDateTime &dateTime)
+{
+    // 月份、星期必须是英文，使用 C locale
+    return QLocale::c().toString(dateTime.toUTC(), "ddd, dd MMM yyyy hh:mm:ss").toLatin1() + " GMT";
+}
+
+QDateTime parseHttpDate(const QByteArray &value)
+{
+    QDateTime dateTime = QLocale::c().toDateTime(QString::fromLatin1(value.trimmed()), "ddd, dd MMM yyyy hh:mm:ss 'GMT'");
+    dateTime.setTimeSpec(Qt::UTC);
+    return dateTime;
+}
+
+QByteArray fileETag(const QFileInfo &fileInfo)
+{
+    return "\"" + QByteArray::number(fileInfo.size(), 16) + "-" +
+           QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch(), 16) + "\"";
+}
+
+bool etagMatches(const QByteArray &ifNoneMatch, const QByteArray &etag)
+{
+    QByteArray value = ifNoneMatch.trimmed();
+    if (value == "*")
     {
-        response += "HTTP/1.1 500 Internal Server Error\r\n";
+        return true;
     }
+    // 弱比较：忽略 W/ 前缀
+    QByteArray target = etag.startsWith("W/") ? etag.mid(2) : etag;
+    for (QByteArray item : value.split(','))
+    {
+        item = item.trimmed();
+        if (item.startsWith("W/"))
+        {
+            item = item.mid(2);
+        }
+        if (item == target)
+        {
+            return true;
+        }
+    }
+    return false;
+}
 
-    // 构建响应头（关键：Content-Length 为响应体的字节数）
-    response += "Content-Type: application/json; charset=UTF-8\r\n";
-    response += "Connection: close\r\n";
-    response += "Content-Length: " + QByteArray::number(responseBody.size()) + "\r\n\r\n";
+bool acceptsEncoding(const QByteArray &acceptEncoding, const QByteArray &coding)
+{
+    // 明确列出的编码优先于 "*"（如 "*, gzip;q=0" 拒绝 gzip，"*;q=0, gzip" 接受 gzip），所以要扫描全部项
+    double exactQ = -1;
+    double anyQ   = -1;
+    for (const QByteArray &rawItem : acceptEncoding.split(','))
+    {
+        QList<QByteArray> params = rawItem.split(';');
+        QByteArray        item   = params.takeFirst().trimmed().toLower();
+        if (item != coding && item != "*")
+        {
+            continue;
+        }
+        double q = 1;
+        for (const QByteArray &param : params)
+        {
+            QByteArray trimmed = param.trimmed().toLower();
+            if (trimmed.startsWith("q="))
+            {
+                q = trimmed.mid(2).toDouble();
+            }
+        }
+        if (item == coding)
+        {
+            exactQ = qMax(exactQ, q);
+        }
+        else
+        {
+            anyQ = qMax(anyQ, q);
+        }
+    }
+    // q=0 表示明确拒绝；都没有列出时不接受
+    return (exactQ >= 0 ? exactQ : anyQ) > 0;
+}
+
+QByteArray gzipCompress(const QByteArray &data, int level)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // windowBits + 16：输出 gzip 头尾而不是 zlib 格式
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return QByteArray();
+    }
 
-    // 拼接响应体
-    response += responseBody;
+    QByteArray output;
+    output.resize(static_cast<int>(deflateBound(&stream, static_cast<uLong>(data.size()))));
+    stream.next_in   = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in  = static_cast<uInt>(data.size());
+    stream.next_out  = reinterpret_cast<Bytef *>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
 
-    // 发送响应
-    socket->write(response);
-    socket->flush();
-    socket->disconnectFromHost();
+    int ret = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (ret != Z_STREAM_END)
+    {
+        return QByteArray();
+    }
+    output.resize(static_cast<int>(stream.total_out));
+    return output;
+}
+
+QByteArray brotliCompress(const QByteArray &data)
+{
+#ifdef HAVE_BROTLI
+    QByteArray output;
+    size_t     outputSize = BrotliEncoderMaxCompressedSize(static_cast<size_t>(data.size()));
+    if (outputSize == 0)
+    {
+        return QByteArray();
+    }
+    output.resize(static_cast<int>(outputSize));
+    if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               static_cast<size_t>(data.size()), reinterpret_cast<const uint8_t *>(data.constData()),
+                               &outputSize, reinterpret_cast<uint8_t *>(output.data())))
+    {
+        return QByteArray();
+    }
+    output.resize(static_cast<int>(outputSize));
+    return output;
+#else
+    Q_UNUSED(data)
+    return QByteArray();
+#endif
+}
+
+bool parseRangeHeader(const QByteArray &value, qint64 fileSize, QVector<QPair<qint64, qint64>> &ranges)
+{
+    ranges.clear();
+    QByteArray spec = value.trimmed();
+    if (!spec.toLower().startsWith("bytes="))
+    {
+        return false;
+    }
+
+    QList<QByteArray> items = spec.mid(6).split(',');
+    // 范围过多时忽略 Range（防止大量重叠范围放大响应体）
+    if (items.size() > MAX_RANGE_COUNT)
+    {
+        return false;
+    }
+
+    for (const QByteArray &rawItem : items)
+    {
+        QByteArray item = rawItem.trimmed();
+        if (item.isEmpty())
+        {
+            continue;
+        }
+        int dash = item.indexOf('-');
+        if (dash < 0)
+        {
+            return false;
+        }
+        QByteArray firstStr = item.left(dash).trimmed();
+        QByteArray lastStr  = item.mid(dash + 1).trimmed();
+        bool       ok       = false;
+        qint64     first    = 0;
+        qint64     last     = fileSize - 1;
+
+        if (firstStr.isEmpty())
+        {
+            // 后缀范围 "-N"：最后 N 个字节
+            qint64 suffix = lastStr.toLongLong(&ok);
+            if (!ok || suffix < 0)
+            {
+                return false;
+            }
+            if (suffix == 0 || fileSize == 0)
+            {
+                continue;
+            }
+            first = qMax<qint64>(0, fileSize - suffix);
+        }
+        else
+        {
+            first = firstStr.toLongLong(&ok);
+            if (!ok || first < 0)
+            {
+                return false;
+            }
+            if (!lastStr.isEmpty())
+            {
+                last = lastStr.toLongLong(&ok);
+                if (!ok || last < first)
+                {
+                    return false;
+                }
+                last = qMin(last, fileSize - 1);
+            }
+            // 起点超出文件长度：不可满足
+            if (first >= fileSize)
+            {
+                continue;
+            }
+        }
+        ranges.append(qMakePair(first, last));
+    }
+    return true;
 }
 
 // 适配 Qt 5.9：仅获取第一个有效本地 IPv4 地址（排除回环）
@@ -3,20 +3,34 @@
 #include <QByteArray>
 #include <QString>
 #include <QMap>
+#include <QPair>
+#include <QVector>
 
 #include "def.h"
+#include "HtmlTemplate.h"
 
 class QTcpSocket;
+class QDateTime;
+class QFileInfo;
 class QProcess;
 class QWebSocket;
 
 QString getMimeType(const QString &filePath);
 
+// 获取编译后的模板（优先使用www资源缓存中的预编译结果）
+HtmlTemplate compiledTemplate(const QString &templateName);
+
 // 读取模板文件并替换变量（key: 占位符名，value: 替换值）
 QByteArray readTemplate(const QString &templateName, const QMap<QString, QString> &variables = {});
 
 // 生成目录列表的HTML内容（基于模板）
 QByteArray generateDirListHtml(const QString &dirPath, const QString &rootDir, const QString &requestPath);
+// 目录列表页面中文件列表之前/之后的部分（分批输出文件列表时使用）
+void dirListPageParts(const QString &dirPath,
+                      const QString &rootDir,
+                      const QString &requestPath,
+                      QByteArray    &head,
+                      QByteArray    &tail);
 
 // 路径安全校验：判断输入路径是否是映射根目录的子路径（防止路径遍历）
 bool isValidPath(const QString &filePath, const QString &rootDir);
@@ -27,13 +41,61 @@ QByteArray
 // 辅助函数：格式化文件大小（可选）
 QString formatFileSize(qint64 bytes);
 
-// 文件上传
-// 解析分块传输（Chunked）数据
-QByteArray parseChunkedData(const QByteArray &data);
+// 线程数配置：环境变量 envName 优先，其次 defaultCount；结果为 0 时按CPU核数
+int configuredThreadCount(const char *envName, int defaultCount);
+
+// 根据状态码生成HTTP状态行（如 "HTTP/1.1 404 Not Found\r\n"）
+QByteArray httpStatusLine(int statusCode);
+
+// 构建完整的HTTP响应头（含 Content-Length、Connection 和结尾空行）
+// contentLength 小于 0 时使用 Transfer-Encoding: chunked
+QByteArray httpResponseHeader(QTcpSocket       *socket,
+                              int               statusCode,
+                              const QByteArray &contentType,
+                              qint64            contentLength,
+                              const QByteArray &extraHeaders = QByteArray());
+
+/**
+ * @brief 发送完整的HTTP响应
+ * 自动补充 Content-Length 和 Connection 头；长连接时响应后继续处理下一个请求，否则关闭连接
+ * @param extraHeaders 额外响应头（每行以\r\n结尾）
+ */
+void sendHttpResponse(QTcpSocket       *socket,
+                      int               statusCode,
+                      const QByteArray &contentType,
+                      const QByteArray &body,
+                      const QByteArray &extraHeaders = QByteArray());
 
 // 发送通用响应
 void sendJsonResponse(QTcpSocket *socket, int statusCode, const QString &message);
 
+// 发送不带响应体的 304 Not Modified（extraHeaders 中带上 ETag/Last-Modified 等校验头）
+void sendNotModified(QTcpSocket *socket, const QByteArray &extraHeaders);
+
+// HTTP日期格式（如 "Sun, 06 Nov 1994 08:49:37 GMT"）
+QByteArray httpDate(const QDateTime &dateTime);
+// 解析HTTP日期，格式错误时返回无效的 QDateTime
+QDateTime parseHttpDate(const QByteArray &value);
+// 根据文件大小和修改时间生成 ETag（文件内容变化时两者至少有一个改变）
+QByteArray fileETag(const QFileInfo &fileInfo);
+// If-None-Match 是否与 etag 匹配（弱比较，支持 "*" 和逗号分隔的多个值）
+bool etagMatches(const QByteArray &ifNoneMatch, const QByteArray &etag);
+
+// Accept-Encoding 是否接受指定编码（如 gzip、br），q=0 视为不接受
+bool acceptsEncoding(const QByteArray &acceptEncoding, const QByteArray &coding);
+// gzip 格式压缩（失败返回空）
+QByteArray gzipCompress(const QByteArray &data, int level = 9);
+// brotli 压缩（未启用 HAVE_BROTLI 或失败时返回空）
+QByteArray brotliCompress(const QByteArray &data);
+
+/**
+ * @brief 解析 Range 请求头（只支持 bytes 单位）
+ * @param ranges 输出：可满足的字节范围 [first, last]
+ * @return 格式错误或范围过多时返回 false（应忽略 Range 返回完整内容）；
+ *         返回 true 且 ranges 为空表示没有可满足的范围（416）
+ */
+bool parseRangeHeader(const QByteArray &value, qint64 fileSize, QVector<QPair<qint64, qint64>> &ranges);
+
 /**
  * @brief 解码 URL 中的中文路径
  * @param encodedPath 编码后的路径（如 share/%E6%96%B0%E5%BB%BA%E6%96%87%E6%9C%AC%E6%96%87%E6%A1%A3.txt）
@@ -3,16 +3,22 @@ const WS_HOST = "{{WS_HOST}}";
 let ws = null;
 let cmdHistory = []; // 指令历史
 let historyIndex = -1; // 历史记录索引
+// 终端会话：断开后带上会话ID和已收到的输出字节数重新连接，服务端保留 Shell 并只补发缺少的输出
+let sessionId = sessionStorage.getItem('bashSessionId') || '';
+let receivedBytes = 0;
+// 会话已结束（Shell 退出）或已被其他页面接管：不再自动重连
+let sessionEnded = false;
 
 // 初始化WebSocket连接（关键修改：声明接收二进制类型）
 function initWebSocket() {
-    ws = new WebSocket(WS_HOST);
+    ws = new WebSocket(`${WS_HOST}/?session=${encodeURIComponent(sessionId)}&offset=${receivedBytes}`);
     // 核心配置：指定WebSocket接收二进制数据的格式为ArrayBuffer（适配QByteArray）
     ws.binaryType = "arraybuffer";
 
     // 连接成功
     ws.onopen = function() {
         appendOutput("[连接成功] 已连接到WebSocket Bash服务器", "info");
+        document.getElementById("cmd-input").disabled = false;
     };
 
     // 接收后端消息（关键修改：解析QByteArray传递的二进制数据）
@@ -21,8 +27,12 @@ function initWebSocket() {
         // 判断是否为二进制数据（QByteArray传递的是ArrayBuffer类型）
         if (event.data instanceof ArrayBuffer) {
             // 将ArrayBuffer转换为Uint8Array，再解码为UTF-8字符串
+            receivedBytes += event.data.byteLength;
             const uint8Array = new Uint8Array(event.data);
             receivedData = new TextDecoder("utf-8").decode(uint8Array);
+        } else if (event.data.startsWith('{"type":"session"')) {
+            handleSessionMessage(JSON.parse(event.data));
+            return;
         } else {
             // 兼容普通文本格式（可选）
             receivedData = event.data;
@@ -35,8 +45,10 @@ function initWebSocket() {
     ws.onclose = function() {
         appendOutput("[连接关闭] 与服务器的连接已断开", "error");
         document.getElementById("cmd-input").disabled = true;
-        // 尝试重连（可选）
-        setTimeout(initWebSocket, 3000);
+        // 尝试重连（会话已结束或被接管时不重连）
+        if (!sessionEnded) {
+            setTimeout(initWebSocket, 3000);
+        }
     };
 
     // 连接错误
@@ -45,6 +57,27 @@ function initWebSocket() {
     };
 }
 
+// 会话消息：offset 是服务端接下来补发的输出的起点
+function handleSessionMessage(msg) {
+    if (msg.type === "session_closed" || msg.type === "session_taken") {
+        sessionEnded = true;
+        sessionId = '';
+        sessionStorage.removeItem('bashSessionId');
+        appendOutput(msg.type === "session_closed"
+            ? "[会话已结束] Shell 已退出，刷新页面开始新的会话"
+            : "[会话已在其他页面打开] 本页面不再自动重连，刷新页面开始新的会话", "error");
+        return;
+    }
+    if (sessionId && msg.id !== sessionId) {
+        appendOutput("[会话已结束] 已创建新的终端会话", "error");
+    } else if (receivedBytes > 0 && msg.offset > receivedBytes) {
+        appendOutput("[部分输出已丢失] 断开期间的输出超出了服务端的回滚缓冲", "error");
+    }
+    sessionId = msg.id;
+    receivedBytes = msg.offset;
+    sessionStorage.setItem('bashSessionId', sessionId);
+}
+
 // 向终端追加输出（无修改）
 function appendOutput(text, className) {
     const terminal = document.getElementById("terminal");
@@ -13,6 +13,17 @@ let isCanvasActive = false; // 标记鼠标是否在screenCanvas区域内
 // 全局变量新增
 let prevCanvasData = null; // 上一帧Canvas数据，用于绘制差分
 let isFirstFrame = true;   // 是否是第一帧
+// 推流模式：'jpeg'（差分JPG）或 'h264'（视频流，需要浏览器支持 WebCodecs）
+let streamMode = 'jpeg';
+let wantedMode = new URLSearchParams(location.search).get('mode') === 'h264' ? 'h264' : 'jpeg';
+let videoDecoder = null;
+let videoStats = null;     // 最近一个视频帧头附带的统计
+// 光标叠加层（服务端截屏不含光标，图标和位置单独发送）
+const cursorCanvas = document.getElementById('cursorCanvas');
+const cursorCtx = cursorCanvas.getContext('2d');
+let cursorHotX = 0;
+let cursorHotY = 0;
+const streamModeBtn = document.getElementById('streamModeBtn');
 
 // 键盘状态跟踪：记录组合键是否按下
 const keyState = {
@@ -34,43 +45,41 @@ function initWebSocket() {
     isFirstFrame = true;
     prevCanvasData = null;
 
-    // 创建新连接
+    // 创建新连接（屏幕帧为二进制协议，按 ArrayBuffer 接收）
     ws = new WebSocket(WS_HOST);
-
-    // 存储当前帧的元信息（宽高）
-    let currentFrameMeta = null;
+    ws.binaryType = 'arraybuffer';
 
     // 连接成功
     ws.onopen = () => {
         console.log('WebSocket connected');
         statusEl.className = 'status online';
         statusEl.textContent = '已连接';
+        streamMode = 'jpeg';
+        if (wantedMode === 'h264') {
+            requestStreamMode('h264');
+        }
     };
 
     // 接收消息
     ws.onmessage = (event) => {
-        // 判断是否是二进制数据
-        if (event.data instanceof Blob) {
-            // 处理JPEG二进制帧
-            if (currentFrameMeta) {
-                renderJpegFrame(event.data, currentFrameMeta);
-                currentFrameMeta = null; // 重置元信息
+        if (event.data instanceof ArrayBuffer) {
+            // 光标消息不是画面帧，也不需要确认
+            if (isCursorMessage(event.data)) {
+                handleCursorMessage(event.data);
+                return;
             }
-        } else {
-            // 处理文本JSON消息
-            const data = JSON.parse(event.data);
-            if (data.type === 'screen_frame_meta') {
-                // 修复点6：为所有字段设置默认值，避免首帧解析错误
-                currentFrameMeta = {
-                    width: data.width || canvas.width || 1920,
-                    height: data.height || canvas.height || 1080,
-                    diff_x: data.diff_x || 0,
-                    diff_y: data.diff_y || 0,
-                    diff_w: data.diff_w || (data.width || 1920),
-                    diff_h: data.diff_h || (data.height || 1080),
-                    is_full: data.is_full || false
-                };
+            // 一个二进制消息就是完整的一帧：帧头 + 矩形表 + 各矩形的JPEG
+            const frame = parseScreenFrame(event.data);
+            if (!frame) {
+                return;
             }
+            if (frame.is_video) {
+                handleVideoFrame(frame);
+                return;
+            }
+            frame.patches.forEach((patch) => renderJpegFrame(patch.blob, frame, patch.rect));
+        } else {
+            handleTextMessage(event.data);
         }
     };
 
@@ -79,6 +88,7 @@ function initWebSocket() {
         console.log('WebSocket disconnected');
         statusEl.className = 'status offline';
         statusEl.textContent = '已断开，正在重连...';
+        closeVideoDecoder();
         // 自动重连
         setTimeout(initWebSocket, 3000);
     };
@@ -91,6 +101,210 @@ function initWebSocket() {
     };
 }
 
+// 屏幕帧二进制协议（格式见服务端 ScreenProtocol.h，整数均为小端）
+const SCREEN_FRAME_VERSION = 1;
+const SCREEN_FRAME_FLAG_FULL = 0x01;
+const SCREEN_FRAME_FLAG_VIDEO = 0x02;
+const SCREEN_FRAME_FLAG_CONFIG = 0x04;
+const SCREEN_FRAME_FLAG_KEY = 0x08;
+const SCREEN_FRAME_FLAG_CURSOR = 0x10;
+const SCREEN_FRAME_HEADER_SIZE = 24;
+const SCREEN_FRAME_PATCH_SIZE = 12;
+const SCREEN_CURSOR_HEADER_SIZE = 18;
+
+function isCursorMessage(buffer) {
+    if (buffer.byteLength < SCREEN_CURSOR_HEADER_SIZE) {
+        return false;
+    }
+    const view = new DataView(buffer);
+    return view.getUint8(0) === SCREEN_FRAME_VERSION && (view.getUint8(1) & SCREEN_FRAME_FLAG_CURSOR) !== 0;
+}
+
+// 光标消息：带图标时更新叠加层的图标，然后移动到光标位置
+function handleCursorMessage(buffer) {
+    const view = new DataView(buffer);
+    const x = view.getInt16(2, true);
+    const y = view.getInt16(4, true);
+    const width = view.getUint16(10, true);
+    const height = view.getUint16(12, true);
+    if (width && height && buffer.byteLength >= SCREEN_CURSOR_HEADER_SIZE + width * height * 4) {
+        cursorHotX = view.getUint16(6, true);
+        cursorHotY = view.getUint16(8, true);
+        cursorCanvas.width = width;
+        cursorCanvas.height = height;
+        const pixels = new Uint8ClampedArray(buffer, SCREEN_CURSOR_HEADER_SIZE, width * height * 4);
+        cursorCtx.putImageData(new ImageData(pixels, width, height), 0, 0);
+    }
+    moveCursorOverlay(x, y);
+}
+
+// 光标坐标是屏幕坐标，按画布的显示缩放换算到页面位置
+function moveCursorOverlay(x, y) {
+    if (!canvas.width || !canvas.height) {
+        cursorCanvas.style.display = 'none';
+        return;
+    }
+    const scaleX = canvas.clientWidth / canvas.width;
+    const scaleY = canvas.clientHeight / canvas.height;
+    cursorCanvas.style.display = 'block';
+    cursorCanvas.style.width = `${cursorCanvas.width * scaleX}px`;
+    cursorCanvas.style.height = `${cursorCanvas.height * scaleY}px`;
+    cursorCanvas.style.left = `${canvas.offsetLeft + canvas.clientLeft + (x - cursorHotX) * scaleX}px`;
+    cursorCanvas.style.top = `${canvas.offsetTop + canvas.clientTop + (y - cursorHotY) * scaleY}px`;
+}
+
+// 解析一帧，格式错误或版本不支持时返回 null
+function parseScreenFrame(buffer) {
+    if (buffer.byteLength < SCREEN_FRAME_HEADER_SIZE) {
+        return null;
+    }
+    const view = new DataView(buffer);
+    const version = view.getUint8(0);
+    if (version !== SCREEN_FRAME_VERSION) {
+        console.warn('Unsupported screen frame version:', version);
+        return null;
+    }
+    const count = view.getUint16(2, true);
+    const flags = view.getUint8(1);
+    const frame = {
+        is_full: (flags & SCREEN_FRAME_FLAG_FULL) !== 0,
+        is_video: (flags & SCREEN_FRAME_FLAG_VIDEO) !== 0,
+        is_config: (flags & SCREEN_FRAME_FLAG_CONFIG) !== 0,
+        is_key: (flags & SCREEN_FRAME_FLAG_KEY) !== 0,
+        seq: view.getUint32(4, true),
+        width: view.getUint16(8, true),
+        height: view.getUint16(10, true),
+        stats: {
+            fps: view.getUint8(12),
+            quality: view.getUint8(13),
+            scale: view.getUint8(14),
+            inflight: view.getUint8(15),
+            latency_ms: view.getUint16(16, true),
+            rtt_ms: view.getUint16(18, true),
+            queued_bytes: view.getUint32(20, true)
+        },
+        patches: [],
+        pending: count  // 尚未绘制完的矩形数
+    };
+    if (frame.is_video) {
+        // 视频流：帧头之后是 H.264 数据（解码器配置或一帧 AVCC）
+        frame.data = new Uint8Array(buffer, SCREEN_FRAME_HEADER_SIZE);
+        return frame;
+    }
+
+    let entry = SCREEN_FRAME_HEADER_SIZE;
+    let payload = entry + count * SCREEN_FRAME_PATCH_SIZE;
+    for (let i = 0; i < count; i++) {
+        const length = view.getUint32(entry + 8, true);
+        if (payload + length > buffer.byteLength) {
+            console.warn('Truncated screen frame:', frame.seq);
+            return null;
+        }
+        frame.patches.push({
+            rect: [view.getUint16(entry, true), view.getUint16(entry + 2, true),
+                   view.getUint16(entry + 4, true), view.getUint16(entry + 6, true)],
+            blob: new Blob([new Uint8Array(buffer, payload, length)], { type: 'image/jpeg' })
+        });
+        entry += SCREEN_FRAME_PATCH_SIZE;
+        payload += length;
+    }
+    return frame;
+}
+
+// 处理服务端的文本消息（目前只有推流模式切换的结果）
+function handleTextMessage(text) {
+    let msg = null;
+    try {
+        msg = JSON.parse(text);
+    } catch (e) {
+        return;
+    }
+    if (msg.type === 'stream_mode') {
+        if (msg.error) {
+            console.warn('Video stream unavailable:', msg.error);
+        }
+        setStreamModeState(msg.mode);
+    }
+}
+
+// 请求切换推流模式，浏览器不支持 WebCodecs 时只能用差分JPG
+function requestStreamMode(mode) {
+    if (mode === 'h264' && typeof VideoDecoder === 'undefined') {
+        console.warn('WebCodecs VideoDecoder not supported, keep jpeg stream');
+        mode = 'jpeg';
+    }
+    wantedMode = mode;
+    if (ws && ws.readyState === WebSocket.OPEN) {
+        ws.send(JSON.stringify({ type: 'stream_mode', mode: mode }));
+    }
+}
+
+function setStreamModeState(mode) {
+    streamMode = mode;
+    if (mode !== 'h264') {
+        closeVideoDecoder();
+        // 服务端从全屏JPG重新开始
+        isFirstFrame = true;
+    }
+    if (streamModeBtn) {
+        streamModeBtn.textContent = mode === 'h264' ? 'JPG模式' : '视频模式';
+    }
+}
+
+function closeVideoDecoder() {
+    if (videoDecoder && videoDecoder.state !== 'closed') {
+        videoDecoder.close();
+    }
+    videoDecoder = null;
+}
+
+// 视频流帧：解码器配置时（重新）创建 VideoDecoder，否则解码一帧，解码完成后确认
+function handleVideoFrame(frame) {
+    videoStats = frame.stats;
+    if (frame.is_config) {
+        closeVideoDecoder();
+        const config = frame.data;
+        // AVCDecoderConfigurationRecord 第1~3字节：profile、兼容性标志、level
+        const hex = (b) => b.toString(16).padStart(2, '0');
+        const codec = 'avc1.' + hex(config[1]) + hex(config[2]) + hex(config[3]);
+        videoDecoder = new VideoDecoder({
+            output: (videoFrame) => {
+                if (canvas.width !== videoFrame.displayWidth || canvas.height !== videoFrame.displayHeight) {
+                    canvas.width = videoFrame.displayWidth;
+                    canvas.height = videoFrame.displayHeight;
+                }
+                ctx.drawImage(videoFrame, 0, 0);
+                const seq = videoFrame.timestamp;
+                videoFrame.close();
+                sendFrameAck({ seq: seq, stats: videoStats });
+            },
+            error: (err) => {
+                console.error('Video decode error:', err);
+                requestStreamMode('jpeg');
+            }
+        });
+        videoDecoder.configure({
+            codec: codec,
+            description: config.slice(),
+            codedWidth: frame.width,
+            codedHeight: frame.height,
+            optimizeForLatency: true
+        });
+        sendFrameAck(frame);
+        return;
+    }
+    // 配置之前的帧无法解码，直接确认避免服务端停止推送
+    if (!videoDecoder || videoDecoder.state !== 'configured') {
+        sendFrameAck(frame);
+        return;
+    }
+    videoDecoder.decode(new EncodedVideoChunk({
+        type: frame.is_key ? 'key' : 'delta',
+        timestamp: frame.seq,
+        data: frame.data
+    }));
+}
+
 // 渲染屏幕帧 base64
 function renderScreenFrame(frame) {
     // 更新屏幕尺寸
@@ -109,8 +323,8 @@ function renderScreenFrame(frame) {
     img.src = `data:image/png;base64,${frame.base64}`;
 }
 
-// 渲染JPEG二进制帧（修改为支持差分绘制）
-function renderJpegFrame(blob, meta) {
+// 渲染JPEG二进制帧（修改为支持差分绘制，patch 为该分片的 [x, y, w, h]）
+function renderJpegFrame(blob, meta, patch) {
     // 创建图片URL
     const imgUrl = URL.createObjectURL(blob);
     const img = new Image();
@@ -121,23 +335,20 @@ function renderJpegFrame(blob, meta) {
 
         // 修复点1：强化首帧/全屏帧的Canvas尺寸初始化
         if (meta.is_full || isFirstFrame) {
-            // 强制重置Canvas尺寸（避免CSS尺寸和像素尺寸不一致）
-            canvas.width = meta.width;
-            canvas.height = meta.height;
-            // 清空画布（避免残留旧内容）
-            ctx.clearRect(0, 0, canvas.width, canvas.height);
-            // 完整绘制首帧
-            ctx.drawImage(img, 0, 0, meta.width, meta.height);
+            if (canvas.width !== meta.width || canvas.height !== meta.height) {
+                // 强制重置Canvas尺寸（避免CSS尺寸和像素尺寸不一致）
+                canvas.width = meta.width;
+                canvas.height = meta.height;
+            }
+            if (meta.is_full) {
+                // 清空画布（避免残留旧内容）
+                ctx.clearRect(0, 0, canvas.width, canvas.height);
+            }
             isFirstFrame = false;
-        } else {
-            // 差分帧：仅绘制变化区域
-            const diffX = meta.diff_x;
-            const diffY = meta.diff_y;
-            const diffW = meta.diff_w;
-            const diffH = meta.diff_h;
-            // 在指定位置绘制差分图像（不重置整个Canvas）
-            ctx.drawImage(img, diffX, diffY, diffW, diffH);
         }
+        // 在指定位置绘制该矩形（服务端降低分辨率时按矩形尺寸拉伸）
+        ctx.drawImage(img, patch[0], patch[1], patch[2], patch[3]);
+        finishPatch(meta);
     };
 
     img.onerror = (err) => {
@@ -145,11 +356,36 @@ function renderJpegFrame(blob, meta) {
         URL.revokeObjectURL(imgUrl);
         // 修复点3：加载失败时重置首帧标记，重新请求全屏帧
         isFirstFrame = true;
+        // 失败的分片也要计数，否则服务端等待确认会停止推送
+        finishPatch(meta);
     };
 
     img.src = imgUrl;
 }
 
+// 一帧的所有矩形都处理完后确认该帧（服务端据此估计延迟，调整帧率/质量/缩放）
+function finishPatch(meta) {
+    meta.pending--;
+    if (meta.pending === 0) {
+        sendFrameAck(meta);
+    }
+}
+
+// 发送帧确认，并在状态栏显示服务端的拥塞控制统计
+function sendFrameAck(meta) {
+    if (!meta.seq) {
+        return;
+    }
+    if (ws && ws.readyState === WebSocket.OPEN) {
+        ws.send(JSON.stringify({ type: 'frame_ack', seq: meta.seq }));
+    }
+    if (meta.stats) {
+        const s = meta.stats;
+        statusEl.textContent = streamMode === 'h264'
+            ? `已连接 H.264 ${s.fps}fps ${s.latency_ms}ms`
+            : `已连接 ${s.fps}fps Q${s.quality} ${s.scale}% ${s.latency_ms}ms`;
+    }
+}
 
 // 发送鼠标事件
 function sendMouseEvent(eventData) {
@@ -158,6 +394,59 @@ function sendMouseEvent(eventData) {
     }
 }
 
+// 鼠标输入二进制记录（格式见服务端 ScreenProtocol.h，整数均为小端）
+const SCREEN_INPUT_MOVE = 1;
+const SCREEN_INPUT_BUTTON = 2;
+const SCREEN_INPUT_WHEEL = 3;
+const SCREEN_INPUT_PRESSED = 0x80;
+const SCREEN_INPUT_RECORD_SIZE = 12;
+const MOUSE_BUTTONS = { left: 1, middle: 2, right: 3 };
+const WHEEL_DIRECTIONS = { up: 1, down: 2, left: 3, right: 4 };
+let pendingMove = null;          // 本动画帧内最新的鼠标位置（尚未发送）
+let moveFrameScheduled = false;
+
+// records 中每条为 [类型, 参数, 步数, x, y, 画布宽, 画布高]，打包成一个二进制消息
+function sendMouseInputs(records) {
+    if (!ws || ws.readyState !== WebSocket.OPEN) {
+        return;
+    }
+    const buffer = new ArrayBuffer(records.length * SCREEN_INPUT_RECORD_SIZE);
+    const view = new DataView(buffer);
+    records.forEach((r, i) => {
+        const offset = i * SCREEN_INPUT_RECORD_SIZE;
+        view.setUint8(offset, r[0]);
+        view.setUint8(offset + 1, r[1]);
+        view.setUint16(offset + 2, r[2], true);
+        view.setUint16(offset + 4, Math.max(0, r[3]), true);
+        view.setUint16(offset + 6, Math.max(0, r[4]), true);
+        view.setUint16(offset + 8, r[5], true);
+        view.setUint16(offset + 10, r[6], true);
+    });
+    ws.send(buffer);
+}
+
+// 鼠标移动：每个动画帧只发送最新位置
+function queueMouseMove(x, y) {
+    pendingMove = [SCREEN_INPUT_MOVE, 0, 0, x, y, canvas.width, canvas.height];
+    if (!moveFrameScheduled) {
+        moveFrameScheduled = true;
+        requestAnimationFrame(() => {
+            moveFrameScheduled = false;
+            if (pendingMove) {
+                sendMouseInputs([pendingMove]);
+                pendingMove = null;
+            }
+        });
+    }
+}
+
+// 按键/滚轮立即发送，未发送的移动放在同一个消息的前面（保证点击位置）
+function sendMouseInput(record) {
+    const records = pendingMove ? [pendingMove, record] : [record];
+    pendingMove = null;
+    sendMouseInputs(records);
+}
+
 // 发送键盘事件
 function sendKeyEvent(eventData) {
     if (ws && ws.readyState === WebSocket.OPEN) {
@@ -340,6 +629,13 @@ function initKeyButtonEvents() {
            simulateShortcut(shortcut);
        });
    });
+
+   // 推流模式切换按钮
+   if (streamModeBtn) {
+       streamModeBtn.addEventListener('click', () => {
+           requestStreamMode(streamMode === 'h264' ? 'jpeg' : 'h264');
+       });
+   }
 }
 
 // 监听Canvas鼠标事件
@@ -384,13 +680,9 @@ function initMouseEvents() {
        const x = Math.floor((e.clientX - rect.left) * scaleX);
        const y = Math.floor((e.clientY - rect.top) * scaleY);
 
-       sendMouseEvent({
-           type: 'mouse_move',
-           x: x,
-           y: y,
-           screen_width: canvas.width,  // 现在是正确的1920
-           screen_height: canvas.height // 现在是正确的968
-       });
+       if (canvas.width && canvas.height) {
+           queueMouseMove(x, y);
+       }
 //       console.log(`修正后坐标：${x} , ${y}  wh= ${canvas.width} x ${canvas.height}`);
     });
 
@@ -406,11 +698,7 @@ function initMouseEvents() {
             e.preventDefault(); // 阻止默认中键行为（如滚动）
         }
 
-        sendMouseEvent({
-            type: 'mouse_click',
-            button: button,
-            action: 'press'
-        });
+        sendMouseInput([SCREEN_INPUT_BUTTON, MOUSE_BUTTONS[button] | SCREEN_INPUT_PRESSED, 0, 0, 0, 0, 0]);
     });
 
 
@@ -423,11 +711,7 @@ function initMouseEvents() {
             button = 'middle';
         }
 
-        sendMouseEvent({
-            type: 'mouse_click',
-            button: button,
-            action: 'release'
-        });
+        sendMouseInput([SCREEN_INPUT_BUTTON, MOUSE_BUTTONS[button], 0, 0, 0, 0, 0]);
     });
 
     // 新增：鼠标滚轮事件
@@ -452,14 +736,12 @@ function initMouseEvents() {
        const x = Math.floor((e.clientX - rect.left) * scaleX);
        const y = Math.floor((e.clientY - rect.top) * scaleY);
 
-       sendMouseEvent({
-           type: 'mouse_wheel',       // 事件类型：滚轮
-           direction: direction,      // 滚动方向：up/down/left/right
-           steps: Math.abs(Math.floor(e.deltaY / 100) || Math.floor(e.deltaX / 100) || 1), // 滚动步数（标准化）
-           x: x,                      // 滚轮触发时的鼠标X坐标
-           y: y                       // 滚轮触发时的鼠标Y坐标
-       });
-       console.log(`滚轮滚动：${direction}，步数：${Math.abs(Math.floor(e.deltaY / 100) || 1)}，坐标：${x},${y}`);
+       if (!direction) {
+           return;
+       }
+       // 滚动方向、步数（标准化）和滚轮触发时的鼠标坐标
+       const steps = Math.abs(Math.floor(e.deltaY / 100) || Math.floor(e.deltaX / 100) || 1);
+       sendMouseInput([SCREEN_INPUT_WHEEL, WHEEL_DIRECTIONS[direction], steps, x, y, canvas.width, canvas.height]);
     });
 
     // 阻止Canvas右键菜单
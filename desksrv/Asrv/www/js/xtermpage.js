@@ -3,6 +3,11 @@ let cmdHistory = []; // 指令历史
 let historyIndex = -1; // 历史记录索引
 let inputBuffer = ''; // 终端输入缓冲区
 let term = null; // 终端实例
+// 终端会话：断开后带上会话ID和已收到的输出字节数重新连接，服务端保留 Shell 并只补发缺少的输出
+let sessionId = sessionStorage.getItem('termSessionId') || '';
+let receivedBytes = 0;
+// 会话已结束（Shell 退出）或已被其他页面接管：不再自动重连
+let sessionEnded = false;
 
 // 工具函数：字符串转Uint8Array（UTF-8编码）
 function stringToUint8Array(str) {
@@ -18,7 +23,8 @@ function uint8ArrayToString(buffer) {
 function initWs() {
     // WebSocket连接配置（替换为你的后端IP和端口）
     const WS_HOST = "{{WS_HOST}}";
-  wsconn = new WebSocket(WS_HOST);
+  wsconn = new WebSocket(`${WS_HOST}/?session=${encodeURIComponent(sessionId)}&offset=${receivedBytes}`);
+  wsconn.binaryType = 'arraybuffer';
 
   // 连接成功
   wsconn.onopen = function() {
@@ -33,6 +39,7 @@ function initWs() {
       // 读取Blob类型的二进制数据
       const reader = new FileReader();
       reader.onload = function() {
+        receivedBytes += reader.result.byteLength;
         // 转为字符串后输出
         const text = uint8ArrayToString(reader.result);
         appendOutput(text, text.startsWith("[错误]") ? "error" : "output");
@@ -41,9 +48,12 @@ function initWs() {
       reader.readAsArrayBuffer(event.data);
     } else if (event.data instanceof ArrayBuffer) {
       // 直接处理ArrayBuffer类型
+      receivedBytes += event.data.byteLength;
       const text = uint8ArrayToString(event.data);
       appendOutput(text, text.startsWith("[错误]") ? "error" : "output");
       term.prompt();
+    } else if (event.data.startsWith('{"type":"session"')) {
+      handleSessionMessage(JSON.parse(event.data));
     } else {
       // 兼容文本格式（兜底）
       appendOutput(event.data, event.data.startsWith("[错误]") ? "error" : "output");
@@ -54,8 +64,10 @@ function initWs() {
   // 连接关闭
   wsconn.onclose = function() {
     appendOutput("[连接关闭] 与服务器的连接已断开", "error");
-    // 尝试重连（可选）
-    setTimeout(initWebSocket, 3000);
+    // 尝试重连（会话已结束或被接管时不重连）
+    if (!sessionEnded) {
+      setTimeout(initWs, 3000);
+    }
   };
 
   // 连接错误
@@ -64,6 +76,27 @@ function initWs() {
   };
 }
 
+// 会话消息：offset 是服务端接下来补发的输出的起点
+function handleSessionMessage(msg) {
+  if (msg.type === "session_closed" || msg.type === "session_taken") {
+    sessionEnded = true;
+    sessionId = '';
+    sessionStorage.removeItem('termSessionId');
+    appendOutput(msg.type === "session_closed"
+      ? "[会话已结束] Shell 已退出，刷新页面开始新的会话"
+      : "[会话已在其他页面打开] 本页面不再自动重连，刷新页面开始新的会话", "error");
+    return;
+  }
+  if (sessionId && msg.id !== sessionId) {
+    appendOutput("[会话已结束] 已创建新的终端会话", "error");
+  } else if (receivedBytes > 0 && msg.offset > receivedBytes) {
+    appendOutput("[部分输出已丢失] 断开期间的输出超出了服务端的回滚缓冲", "error");
+  }
+  sessionId = msg.id;
+  receivedBytes = msg.offset;
+  sessionStorage.setItem('termSessionId', sessionId);
+}
+
 // 向终端追加输出（适配Xterm）
 function appendOutput(text, className) {
   // 处理换行符，Xterm需要\r\n
@@ -7,6 +7,7 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <thread>  // std::thread
+#include <QElapsedTimer>
 
 // DRM相关头文件
 #include <drm/drm.h>
@@ -43,6 +44,131 @@ uint32_t getCrtcIdFromEncoder(int fd, drmModeRes *res, uint32_t encoderId)
     return 0;
 }
 
+// ========== X11截屏的持久资源 ==========
+// 显示连接和共享内存图像在多次截屏之间复用（每次截屏不再 XOpenDisplay/shmget/shmat），
+// 共享内存图像只在分辨率变化时重建
+struct ScreenShooter::X11Capture
+{
+    Display        *display = nullptr;
+    XImage         *ximage  = nullptr;
+    XShmSegmentInfo shminfo {};
+    // 颜色通道在像素中的偏移（由 Visual 的颜色掩码计算，连接建立时算一次）
+    int redShift   = 0;
+    int greenShift = 0;
+    int blueShift  = 0;
+
+    ~X11Capture()
+    {
+        releaseImage();
+        if (display)
+        {
+            XCloseDisplay(display);
+        }
+    }
+
+    bool open();
+    bool ensureImage(int width, int height);
+    void releaseImage();
+};
+
+static int maskShift(unsigned long mask)
+{
+    int shift = 0;
+    while (mask != 0 && (mask & 1) == 0)
+    {
+        shift++;
+        mask >>= 1;
+    }
+    return shift;
+}
+
+bool ScreenShooter::X11Capture::open()
+{
+    display = XOpenDisplay(nullptr);
+    if (!display)
+    {
+        return false;
+    }
+    // 基于颜色掩码解析通道（适配所有环境，不硬编码通道位置）
+    Visual *visual = DefaultVisual(display, DefaultScreen(display));
+    redShift       = maskShift(visual->red_mask);
+    greenShift     = maskShift(visual->green_mask);
+    blueShift      = maskShift(visual->blue_mask);
+    return true;
+}
+
+bool ScreenShooter::X11Capture::ensureImage(int width, int height)
+{
+    if (ximage && ximage->width == width && ximage->height == height)
+    {
+        return true;
+    }
+    releaseImage();
+
+    // 创建X11共享内存图像
+    int screen = DefaultScreen(display);
+    ximage = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen), ZPixmap, nullptr,
+                             &shminfo, width, height);
+    if (!ximage)
+    {
+        qWarning() << "Failed to create XShm image";
+        return false;
+    }
+
+    // 分配共享内存
+    shminfo.shmid = shmget(IPC_PRIVATE, ximage->bytes_per_line * ximage->height, IPC_CREAT | 0777);
+    if (shminfo.shmid < 0)
+    {
+        qWarning() << "Failed to allocate XShm memory: " << strerror(errno);
+        XDestroyImage(ximage);
+        ximage = nullptr;
+        return false;
+    }
+
+    // 附加共享内存
+    shminfo.shmaddr = ximage->data = static_cast<char *>(shmat(shminfo.shmid, 0, 0));
+    if (shminfo.shmaddr == reinterpret_cast<char *>(-1))
+    {
+        qWarning() << "Failed to attach XShm memory: " << strerror(errno);
+        shmctl(shminfo.shmid, IPC_RMID, 0);
+        XDestroyImage(ximage);
+        ximage = nullptr;
+        return false;
+    }
+
+    shminfo.readOnly = False;
+    XShmAttach(display, &shminfo);
+    // X服务器附加后即可标记删除，进程异常退出时共享内存段也会被回收（长期持有，不能泄漏）
+    XSync(display, False);
+    shmctl(shminfo.shmid, IPC_RMID, 0);
+    qInfo() << "XShm image created:" << width << "x" << height;
+    return true;
+}
+
+void ScreenShooter::X11Capture::releaseImage()
+{
+    if (!ximage)
+    {
+        return;
+    }
+    XShmDetach(display, &shminfo);
+    XSync(display, False);
+    shmdt(shminfo.shmaddr);
+    XDestroyImage(ximage);
+    ximage  = nullptr;
+    shminfo = XShmSegmentInfo {};
+}
+
+// 复用 image 的像素缓冲：尺寸、格式相同且没有被其他 QImage 共享时直接覆盖写入，否则重新分配
+static void prepareImage(QImage &image, int width, int height)
+{
+    if (image.width() != width || image.height() != height || image.format() != QImage::Format_RGB32 ||
+        !image.isDetached())
+    {
+        image = QImage(width, height, QImage::Format_RGB32);
+    }
+}
+
 // ========== 单例静态成员初始化 ==========
 ScreenShooter *ScreenShooter::m_instance = nullptr;
 QMutex         ScreenShooter::m_instanceMutex;
@@ -75,14 +201,13 @@ ScreenShooter::ScreenShooter(QObject *parent): QObject(parent)
     else
     {
         qWarning() << "DRM init failed, will use X11 fallback";
-        // 预获取X11屏幕分辨率
-        Display *display = XOpenDisplay(nullptr);
-        if (display)
+        // 预获取X11屏幕分辨率（连接保留给之后的截屏使用）
+        m_x11.reset(new X11Capture);
+        if (m_x11->open())
         {
-            int screen     = DefaultScreen(display);
-            m_screenWidth  = DisplayWidth(display, screen);
-            m_screenHeight = DisplayHeight(display, screen);
-            XCloseDisplay(display);
+            int screen     = DefaultScreen(m_x11->display);
+            m_screenWidth  = DisplayWidth(m_x11->display, screen);
+            m_screenHeight = DisplayHeight(m_x11->display, screen);
         }
     }
 }
@@ -90,8 +215,20 @@ ScreenShooter::ScreenShooter(QObject *parent): QObject(parent)
 // ========== 析构函数 ==========
 ScreenShooter::~ScreenShooter()
 {
-    // 清理DRM资源
+    // 停止截屏线程
+    {
+        QMutexLocker locker(&m_frameMutex);
+        m_stopCapture = true;
+        m_captureWakeup.wakeAll();
+    }
+    if (m_captureThread.joinable())
+    {
+        m_captureThread.join();
+    }
+
+    // 清理DRM和X11资源
     cleanupDrmDevice();
+    m_x11.reset();
     qInfo() << "ScreenShooter instance destroyed";
 }
 
@@ -398,117 +535,79 @@ void ScreenShooter::cleanupDrmDevice()
 
 // ========== DRM截屏实现 ==========
 QPixmap ScreenShooter::captureScreenDrm()
+{
+    QImage image;
+    return grabDrm(image) ? QPixmap::fromImage(image) : QPixmap();
+}
+
+bool ScreenShooter::grabDrm(QImage &image)
 {
     if (!m_drmInited || !m_drmInfo.fbMap)
     {
         qWarning() << "DRM not initialized or framebuffer not mapped";
-        return QPixmap();
+        return false;
     }
 
-    // 关键：确认像素格式匹配（DRM默认是XRGB32，对应QImage的Format_RGB32）
-    QImage::Format format = QImage::Format_RGB32;
-    if (m_drmInfo.bpp == 32 && (m_drmInfo.stride / m_drmInfo.width) == 4)
+    // DRM默认是XRGB32，对应QImage的Format_RGB32，逐行从GPU映射内存拷贝（避免内存悬空）
+    prepareImage(image, m_drmInfo.width, m_drmInfo.height);
+    const uchar *src = static_cast<const uchar *>(m_drmInfo.fbMap);
+    for (int y = 0; y < m_drmInfo.height; ++y)
     {
-        format = QImage::Format_RGB32;  // XRGB32 (DRM) <-> RGB32 (QImage)
+        memcpy(image.scanLine(y), src + static_cast<size_t>(y) * m_drmInfo.stride,
+               static_cast<size_t>(m_drmInfo.width) * 4);
     }
-
-    // 从GPU映射内存创建QImage
-    QImage image(static_cast<uchar *>(m_drmInfo.fbMap), m_drmInfo.width, m_drmInfo.height, m_drmInfo.stride, format);
-
-    // 拷贝数据避免内存悬空，转换为QPixmap
-    return QPixmap::fromImage(image.copy());
+    return true;
 }
 
 // ========== X11截屏实现 ==========
 QPixmap ScreenShooter::captureScreenX11()
 {
-    Display *display = XOpenDisplay(nullptr);
-    if (!display)
+    QImage image;
+    return grabX11(image) ? QPixmap::fromImage(image) : QPixmap();
+}
+
+bool ScreenShooter::grabX11(QImage &image)
+{
+    if (!m_x11)
+    {
+        m_x11.reset(new X11Capture);
+    }
+    if (!m_x11->display && !m_x11->open())
     {
         qWarning() << "Failed to open X11 display";
-        return QPixmap();
+        return false;
     }
 
-    int               screen = DefaultScreen(display);
-    Window            root   = RootWindow(display, screen);
+    Display          *display = m_x11->display;
+    int               screen  = DefaultScreen(display);
+    Window            root    = RootWindow(display, screen);
     XWindowAttributes attrs {};
     if (!XGetWindowAttributes(display, root, &attrs))
     {
         qWarning() << "Failed to get X11 window attributes";
-        XCloseDisplay(display);
-        return QPixmap();
+        return false;
     }
 
     int width  = attrs.width;
     int height = attrs.height;
-
-    // 创建X11共享内存图像
-    XShmSegmentInfo shminfo {};
-    XImage *ximage = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen), ZPixmap,
-                                     nullptr, &shminfo, width, height);
-
-    if (!ximage)
+    // 分辨率不变时复用上一次的共享内存图像
+    if (!m_x11->ensureImage(width, height))
     {
-        qWarning() << "Failed to create XShm image";
-        XCloseDisplay(display);
-        return QPixmap();
-    }
-
-    // 分配共享内存
-    shminfo.shmid = shmget(IPC_PRIVATE, ximage->bytes_per_line * ximage->height, IPC_CREAT | 0777);
-    if (shminfo.shmid < 0)
-    {
-        qWarning() << "Failed to allocate XShm memory: " << strerror(errno);
-        XDestroyImage(ximage);
-        XCloseDisplay(display);
-        return QPixmap();
-    }
-
-    // 附加共享内存
-    shminfo.shmaddr = ximage->data = static_cast<char *>(shmat(shminfo.shmid, 0, 0));
-    if (shminfo.shmaddr == reinterpret_cast<char *>(-1))
-    {
-        qWarning() << "Failed to attach XShm memory: " << strerror(errno);
-        shmctl(shminfo.shmid, IPC_RMID, 0);
-        XDestroyImage(ximage);
-        XCloseDisplay(display);
-        return QPixmap();
+        return false;
     }
 
-    shminfo.readOnly = False;
-    XShmAttach(display, &shminfo);
-
     // 捕获屏幕图像（共享内存方式，快速）
-    XShmGetImage(display, root, ximage, 0, 0, AllPlanes);
-
-    // ========== 核心修复：基于颜色掩码解析通道（彻底解决色彩问题） ==========
-    // ========== 关键新增：获取X11的颜色掩码（适配所有环境） ==========
-    Visual       *visual     = DefaultVisual(display, screen);
-    unsigned long red_mask   = visual->red_mask;
-    unsigned long green_mask = visual->green_mask;
-    unsigned long blue_mask  = visual->blue_mask;
-
-    // 计算每个颜色通道的偏移位（核心：不再硬编码通道位置）
-    int red_shift = 0, green_shift = 0, blue_shift = 0;
-    // 计算Red通道偏移
-    while ((red_mask & 1) == 0)
-    {
-        red_shift++;
-        red_mask >>= 1;
-    }
-    // 计算Green通道偏移
-    while ((green_mask & 1) == 0)
+    XImage *ximage = m_x11->ximage;
+    if (!XShmGetImage(display, root, ximage, 0, 0, AllPlanes))
     {
-        green_shift++;
-        green_mask >>= 1;
-    }
-    // 计算Blue通道偏移
-    while ((blue_mask & 1) == 0)
-    {
-        blue_shift++;
-        blue_mask >>= 1;
+        qWarning() << "XShmGetImage failed";
+        return false;
     }
-    QImage          image(width, height, QImage::Format_RGB32);
+
+    int             red_shift   = m_x11->redShift;
+    int             green_shift = m_x11->greenShift;
+    int             blue_shift  = m_x11->blueShift;
+    prepareImage(image, width, height);
     uchar          *dst       = image.bits();
     const uint32_t *src       = reinterpret_cast<const uint32_t *>(ximage->data);  // 按32位像素读取
     int             srcStride = ximage->bytes_per_line / 4;  // 每行像素数（而非字节数）
@@ -533,20 +632,12 @@ QPixmap ScreenShooter::captureScreenX11()
             dstRow[x] = 0xFF000000 | (r << 16) | (g << 8) | b;
         }
     }
-    QPixmap pixmap = QPixmap::fromImage(image);
-
-    // 清理X11资源
-    XShmDetach(display, &shminfo);
-    shmdt(shminfo.shmaddr);
-    shmctl(shminfo.shmid, IPC_RMID, 0);
-    XDestroyImage(ximage);
-    XCloseDisplay(display);
 
     // 更新屏幕分辨率
     m_screenWidth  = width;
     m_screenHeight = height;
 
-    return pixmap;
+    return true;
 }
 
 // ========== 内部同步截屏实现（加锁保护） ==========
@@ -561,26 +652,39 @@ QPixmap ScreenShooter::captureScreenInternal()
         return m_lastFrame;
     }
 
-    // 优先使用DRM截屏
-    QPixmap pixmap;
+    // 截屏线程在运行时直接使用它的最新帧
+    QImage image = latestFrame();
+    if (image.isNull() && !grabFrame(image))
+    {
+        image = QImage();
+    }
+    QPixmap pixmap    = QPixmap::fromImage(image);
+    m_lastFrame       = pixmap;
+    m_lastCaptureTime = QDateTime::currentDateTime();
+
+    return pixmap;
+}
+
+// 优先使用DRM截屏，失败则回退到X11
+bool ScreenShooter::grabFrame(QImage &image)
+{
     if (m_drmInited)
     {
-        pixmap = captureScreenDrm();
-        if (!pixmap.isNull())
+        if (grabDrm(image))
         {
-            m_lastFrame       = pixmap;
-            m_lastCaptureTime = QDateTime::currentDateTime();
-            return pixmap;
+            return true;
         }
         qWarning() << "DRM capture failed, fallback to X11";
     }
+    return grabX11(image);
+}
 
-    // 回退到X11截屏
-    pixmap            = captureScreenX11();
-    m_lastFrame       = pixmap;
-    m_lastCaptureTime = QDateTime::currentDateTime();
-
-    return pixmap;
+// ========== 同步截屏接口（不使用缓存） ==========
+QImage ScreenShooter::captureImage()
+{
+    QMutexLocker locker(&m_captureMutex);
+    QImage       image;
+    return grabFrame(image) ? image : QImage();
 }
 
 // ========== 同步截屏接口（对外兼容） ==========
@@ -590,13 +694,117 @@ QPixmap ScreenShooter::captureScreen()
     return captureScreenInternal();
 }
 
-// ========== 异步截屏接口（核心新增） ==========
+// ========== 异步截屏接口 ==========
 std::future<QPixmap> ScreenShooter::captureScreenAsync()
 {
-    // 使用std::async启动异步任务，返回std::future
-    // std::launch::async：强制在新线程执行
-    return std::async(std::launch::async, [this]() -> QPixmap {
-        // 调用加锁的内部截屏函数，保证线程安全
+    // std::launch::deferred：在调用 get() 的线程执行，不再每次截屏创建新线程
+    // （连续截屏请订阅截屏线程，见 subscribe）
+    return std::async(std::launch::deferred, [this]() -> QPixmap {
         return this->captureScreenInternal();
     });
 }
+
+// ========== 持续截屏（截屏线程 + 三缓冲） ==========
+int ScreenShooter::subscribe(int fps)
+{
+    QMutexLocker locker(&m_frameMutex);
+    int          id = m_nextSubscriber++;
+    m_subscribers[id] = qMax(1, fps);
+    if (!m_captureThread.joinable())
+    {
+        m_captureThread = std::thread(&ScreenShooter::captureLoop, this);
+    }
+    m_captureWakeup.wakeAll();
+    return id;
+}
+
+void ScreenShooter::unsubscribe(int id)
+{
+    QMutexLocker locker(&m_frameMutex);
+    m_subscribers.remove(id);
+    m_captureWakeup.wakeAll();
+}
+
+QImage ScreenShooter::latestFrame(quint64 *seq)
+{
+    QMutexLocker locker(&m_frameMutex);
+    if (m_subscribers.isEmpty() || m_latestIndex < 0)
+    {
+        return QImage();
+    }
+    if (seq)
+    {
+        *seq = m_frameSeq;
+    }
+    return m_frames[m_latestIndex];
+}
+
+QImage ScreenShooter::waitFrame(quint64 afterSeq, int timeoutMs, quint64 *seq)
+{
+    QMutexLocker  locker(&m_frameMutex);
+    QElapsedTimer timer;
+    timer.start();
+    while (m_frameSeq <= afterSeq)
+    {
+        qint64 remaining = timeoutMs - timer.elapsed();
+        if (m_stopCapture || remaining <= 0 || !m_frameReady.wait(&m_frameMutex, static_cast<unsigned long>(remaining)))
+        {
+            return QImage();
+        }
+    }
+    if (seq)
+    {
+        *seq = m_frameSeq;
+    }
+    return m_frames[m_latestIndex];
+}
+
+void ScreenShooter::captureLoop()
+{
+    QElapsedTimer timer;
+    while (true)
+    {
+        int interval = 0;
+        {
+            QMutexLocker locker(&m_frameMutex);
+            while (!m_stopCapture && m_subscribers.isEmpty())
+            {
+                m_captureWakeup.wait(&m_frameMutex);
+            }
+            if (m_stopCapture)
+            {
+                return;
+            }
+            int fps = 1;
+            for (int rate : m_subscribers)
+            {
+                fps = qMax(fps, rate);
+            }
+            interval = 1000 / fps;
+        }
+        timer.start();
+
+        // 写入的缓冲既不是最新帧也不会被订阅者读取（订阅者只取最新帧），写的时候不用持有 m_frameMutex
+        QImage &frame = m_frames[m_writeIndex];
+        bool    ok    = false;
+        {
+            QMutexLocker locker(&m_captureMutex);
+            ok = grabFrame(frame);
+        }
+
+        QMutexLocker locker(&m_frameMutex);
+        if (ok)
+        {
+            m_latestIndex = m_writeIndex;
+            m_writeIndex  = (m_writeIndex + 1) % 3;
+            ++m_frameSeq;
+            m_frameReady.wakeAll();
+        }
+        // 等到下一帧的时间，订阅变化或退出时提前醒来
+        qint64 remaining = interval - timer.elapsed();
+        if (remaining > 0 && !m_stopCapture)
+        {
+            m_captureWakeup.wait(&m_frameMutex, static_cast<unsigned long>(remaining));
+        }
+    }
+}
@@ -7,11 +7,16 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QDateTime>
+#include <QMap>
+#include <QWaitCondition>
 #include <future>  // 引入std::future/std::async
 #include <memory>  // 智能指针
+#include <thread>
 
-// Linux DRM/X11截屏工具类（单例 + 异步截屏 + 多线程安全）
+// Linux DRM/X11截屏工具类（单例 + 持续截屏线程 + 多线程安全）
 // 优先使用DRM（GPU帧缓冲区）截屏，失败则回退到X11共享内存方案
+// 需要连续画面的调用方订阅持续截屏：一个常驻的截屏线程按请求的帧率截屏写入三缓冲，
+// 订阅者直接共享最新一帧的像素（QImage 隐式共享），不再每帧创建线程或复制图像
 class ScreenShooter : public QObject
 {
     Q_OBJECT
@@ -27,12 +32,23 @@ public:
     // 线程安全的单例获取接口（双重检查锁）
     static ScreenShooter *instance();
 
-    // 异步截屏接口：返回std::future<QPixmap>，非阻塞
+    // 异步截屏接口：返回std::future<QPixmap>，在调用 get() 的线程截屏（不创建线程）
     std::future<QPixmap> captureScreenAsync();
 
     // 同步截屏接口（兼容原有逻辑，加锁保护）
     QPixmap captureScreen();
 
+    // 同步截屏，不使用截图缓存，返回 Format_RGB32 图像（可在非GUI线程调用）
+    QImage captureImage();
+
+    // 订阅持续截屏（fps 为需要的帧率），返回订阅ID；截屏线程按所有订阅者中最高的帧率截屏，没有订阅者时休眠
+    int  subscribe(int fps);
+    void unsubscribe(int id);
+    // 最新的一帧（不阻塞，与截屏线程共享像素），没有订阅者或还没截到时返回空；seq 返回帧序号
+    QImage latestFrame(quint64 *seq = nullptr);
+    // 等待序号大于 afterSeq 的帧（已经有则立即返回），超时返回空
+    QImage waitFrame(quint64 afterSeq, int timeoutMs, quint64 *seq = nullptr);
+
     // 获取屏幕分辨率（截屏前调用有效）
     int screenWidth() const
     {
@@ -76,6 +92,16 @@ private:
     // 底层截屏实现
     QPixmap captureScreenDrm();
     QPixmap captureScreenX11();
+    // 截屏写入 image（Format_RGB32）：尺寸相同且像素没有被共享时直接覆盖，不重新分配
+    bool grabFrame(QImage &image);
+    bool grabDrm(QImage &image);
+    bool grabX11(QImage &image);
+
+    // 截屏线程：按订阅的帧率截屏，轮流写入三缓冲
+    void captureLoop();
+
+    // X11截屏的持久资源（显示连接和共享内存图像），定义见 screenshooter.cpp
+    struct X11Capture;
 
 private:
     // ======== 单例相关静态成员 ========
@@ -93,6 +119,23 @@ private:
     bool    m_drmInited    = false;  // DRM初始化状态
     int     m_screenWidth  = 0;      // 屏幕宽度
     int     m_screenHeight = 0;      // 屏幕高度
+
+    std::unique_ptr<X11Capture> m_x11;  // 第一次X11截屏时创建，之后一直复用
+
+    // ======== 持续截屏 ========
+    std::thread    m_captureThread;       // 第一次订阅时启动
+    QMutex         m_frameMutex;          // 保护订阅者和三缓冲的索引
+    QWaitCondition m_frameReady;          // 有新帧
+    QWaitCondition m_captureWakeup;       // 订阅变化或退出
+    QMap<int, int> m_subscribers;         // 订阅ID → 帧率
+    int            m_nextSubscriber = 1;
+    bool           m_stopCapture    = false;
+    // 三缓冲：截屏线程依次写入，写完的一帧成为最新帧；订阅者拿走的帧要再过两帧才会被覆盖，
+    // 那时仍被持有的缓冲不会被改写（截屏线程改为分配新的缓冲）
+    QImage  m_frames[3];
+    int     m_writeIndex  = 0;
+    int     m_latestIndex = -1;
+    quint64 m_frameSeq    = 0;
 };
 
 #endif  // SCREENSHOOTER_H
@@ -1,6 +1,13 @@
 #include <QString>
 #include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
 #include <QApplication>
+#include <QPainter>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
 #include <cassert>
 #include <chrono>
 #include <iostream>
@@ -13,6 +20,14 @@
 #include "MyWidget.h"
 #include "ClassN.h"
 #include "commontool/mousesimulator.h"
+#include "Asrv/DirListing.h"
+#include "Asrv/HttpParser.h"
+#include "Asrv/IoThreadPool.h"
+#include "Asrv/TileDiff.h"
+#include "Asrv/ScreenProtocol.h"
+#include "Asrv/TerminalSession.h"
+#include "Asrv/JpegEncoder.h"
+#include "commontool/screenshooter.h"
 
 USING_NAMESAPCE(unify)
 
@@ -31,6 +46,33 @@ private:
     void test_TryLock();
 private Q_SLOTS:
     void test_mouseSimulator();
+    // Asrv 请求解析：整块/任意位置切成两段/逐字节喂入时结果一致（chunked、流水线、续行、错误码）
+    void test_httpParser_data();
+    void test_httpParser();
+    // Asrv 终端回滚缓冲：环形回绕、读取已被覆盖的偏移、单次写入超过容量、容量为 0
+    void test_scrollbackBuffer();
+    // Asrv 请求解析：增量解析器 与 旧的每次 readyRead 对整个缓存跑正则 的耗时（1KB GET / 大文件上传）
+    void bench_httpParser_data();
+    void bench_httpParser();
+    // Asrv 目录列表：5万个文件的行渲染耗时
+    void bench_dirListRows();
+    // Asrv I/O线程池：只测连接分发到多个线程的效果（对比不同线程数）
+    // 处理函数是固定 sleep 5ms 的桩，不经过 TcpServer 的 HTTP 解析和路由
+    void bench_ioThreadPoolDispatch_data();
+    void bench_ioThreadPoolDispatch();
+    // Asrv 屏幕差分：4K帧分块比较和脏矩形合并的耗时（无变化/光标+时钟/整屏变化）
+    void bench_tileDiff_data();
+    void bench_tileDiff();
+    // Asrv 屏幕帧封装：JSON元信息+逐个JPG消息 与 二进制帧头单消息 的打包耗时和消息数/字节数
+    void bench_screenFraming_data();
+    void bench_screenFraming();
+
+    void bench_jpegEncode_data();
+    void bench_jpegEncode();
+    // commontool 截屏：连续截屏的帧率（复用显示连接和共享内存图像）
+    // 需要X服务器，如 Xvfb :99 -screen 0 3840x2160x24 & DISPLAY=:99，与屏幕分辨率不符的行跳过
+    void bench_screenCapture_data();
+    void bench_screenCapture();
 };
 
 UintTest::UintTest()
@@ -520,6 +562,646 @@ void UintTest::test_mouseSimulator()
 //    app.exec();
 }
 
+// 按顺序把 pieces 喂给解析器（与 TcpServer::processRequests 相同的循环），返回已完成请求的摘要：
+// "方法 目标 [headerName 的值] 请求体"，多个请求以 "|" 分隔；解析出错时 errorCode 为解析器给出的状态码
+static QByteArray parseRequests(const QList<QByteArray> &pieces, const QByteArray &headerName, int &errorCode)
+{
+    HttpParser parser;
+    parser.setMaxBodySize(64);
+    QByteArray summary;
+    errorCode = 0;
+    for (const QByteArray &piece : pieces)
+    {
+        int offset = 0;
+        while (true)
+        {
+            HttpParser::Result result = HttpParser::NeedMore;
+            offset += parser.feed(piece, offset, result);
+            if (result == HttpParser::NeedMore)
+            {
+                break;
+            }
+            if (result == HttpParser::ParseError)
+            {
+                errorCode = parser.errorCode();
+                return summary;
+            }
+            if (result == HttpParser::HeadersComplete)
+            {
+                continue;
+            }
+            if (!summary.isEmpty())
+            {
+                summary += '|';
+            }
+            summary +=
+                parser.method() + ' ' + parser.target() + " [" + parser.header(headerName) + "] " + parser.body();
+            parser.reset();
+        }
+    }
+    return summary;
+}
+
+void UintTest::test_httpParser_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<QByteArray>("headerName");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addColumn<int>("errorCode");
+
+    QTest::newRow("GET with query") << QByteArray("GET /a/b?x=1 HTTP/1.1\r\nHost: h\r\n\r\n") << QByteArray("host")
+                                    << QByteArray("GET /a/b?x=1 [h] ") << 0;
+    QTest::newRow("leading empty lines")
+        << QByteArray("\r\n\r\nGET / HTTP/1.1\r\nHost: h\r\n\r\n") << QByteArray("host") << QByteArray("GET / [h] ")
+        << 0;
+    QTest::newRow("Content-Length body")
+        << QByteArray("POST /upload HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello") << QByteArray("content-length")
+        << QByteArray("POST /upload [5] hello") << 0;
+    QTest::newRow("chunked with extensions and trailer")
+        << QByteArray("POST /c HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                      "4;name=value\r\nWiki\r\n5\r\npedia\r\n0\r\nX-Trailer: t\r\n\r\n")
+        << QByteArray("transfer-encoding") << QByteArray("POST /c [chunked] Wikipedia") << 0;
+    QTest::newRow("two pipelined requests")
+        << QByteArray("GET /1 HTTP/1.1\r\nHost: a\r\n\r\nPOST /2 HTTP/1.1\r\nHost: b\r\nContent-Length: 3\r\n\r\nabc")
+        << QByteArray("host") << QByteArray("GET /1 [a] |POST /2 [b] abc") << 0;
+    QTest::newRow("obs-fold continuation")
+        << QByteArray("GET / HTTP/1.1\r\nX-Long: first\r\n  second\r\n\tthird\r\n\r\n") << QByteArray("x-long")
+        << QByteArray("GET / [first second third] ") << 0;
+    QTest::newRow("repeated header merged")
+        << QByteArray("GET / HTTP/1.1\r\nAccept: a\r\naccept: b\r\n\r\n") << QByteArray("accept")
+        << QByteArray("GET / [a, b] ") << 0;
+    QTest::newRow("LF only line endings") << QByteArray("GET / HTTP/1.1\nHost: h\n\n") << QByteArray("host")
+                                          << QByteArray("GET / [h] ") << 0;
+
+    QTest::newRow("400 bad request line") << QByteArray("GARBAGE\r\n\r\n") << QByteArray() << QByteArray() << 400;
+    QTest::newRow("400 bad version") << QByteArray("GET / HTTX/1.1\r\n\r\n") << QByteArray() << QByteArray() << 400;
+    QTest::newRow("400 header without colon")
+        << QByteArray("GET / HTTP/1.1\r\nNoColon\r\n\r\n") << QByteArray() << QByteArray() << 400;
+    QTest::newRow("400 continuation without header")
+        << QByteArray("GET / HTTP/1.1\r\n folded\r\n\r\n") << QByteArray() << QByteArray() << 400;
+    QTest::newRow("400 bad Content-Length")
+        << QByteArray("POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n") << QByteArray() << QByteArray() << 400;
+    QTest::newRow("400 bad chunk size")
+        << QByteArray("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n") << QByteArray() << QByteArray()
+        << 400;
+    QTest::newRow("400 missing CRLF after chunk")
+        << QByteArray("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcX\r\n0\r\n\r\n") << QByteArray()
+        << QByteArray() << 400;
+    QTest::newRow("400 after a good pipelined request")
+        << QByteArray("GET /ok HTTP/1.1\r\nHost: a\r\n\r\nBAD\r\n\r\n") << QByteArray("host")
+        << QByteArray("GET /ok [a] ") << 400;
+    // 请求体上限在 parseRequests 中设为 64 字节
+    QTest::newRow("413 body too large")
+        << QByteArray("POST / HTTP/1.1\r\nContent-Length: 65\r\n\r\n" + QByteArray(65, 'x')) << QByteArray()
+        << QByteArray() << 413;
+    // 请求行 + 请求头超过 MAX_HEADER_SIZE（64KB）
+    QTest::newRow("431 headers too large")
+        << QByteArray("GET / HTTP/1.1\r\nX-Big: " + QByteArray(65 * 1024, 'a') + "\r\n\r\n") << QByteArray()
+        << QByteArray() << 431;
+    QTest::newRow("501 unsupported transfer coding")
+        << QByteArray("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n") << QByteArray() << QByteArray() << 501;
+    QTest::newRow("505 HTTP/2.0") << QByteArray("GET / HTTP/2.0\r\n\r\n") << QByteArray() << QByteArray() << 505;
+}
+
+void UintTest::test_httpParser()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(QByteArray, headerName);
+    QFETCH(QByteArray, expected);
+    QFETCH(int, errorCode);
+
+    // 1. 整块
+    int code = 0;
+    QCOMPARE(parseRequests(QList<QByteArray>() << request, headerName, code), expected);
+    QCOMPARE(code, errorCode);
+
+    // 2. 在每个位置切成两段（大请求只取部分切点，避免平方级耗时）
+    int step = request.size() > 4096 ? request.size() / 64 : 1;
+    for (int split = 1; split < request.size(); split += step)
+    {
+        QList<QByteArray> pieces;
+        pieces << request.left(split) << request.mid(split);
+        QCOMPARE(parseRequests(pieces, headerName, code), expected);
+        QCOMPARE(code, errorCode);
+    }
+
+    // 3. 逐字节
+    QList<QByteArray> bytes;
+    for (int i = 0; i < request.size(); ++i)
+    {
+        bytes << request.mid(i, 1);
+    }
+    QCOMPARE(parseRequests(bytes, headerName, code), expected);
+    QCOMPARE(code, errorCode);
+}
+
+void UintTest::test_scrollbackBuffer()
+{
+    // 写入和读取都跨过缓冲末尾
+    ScrollbackBuffer buffer(8);
+    buffer.append("abcdef", 6);
+    QCOMPARE(buffer.readFrom(0), QByteArray("abcdef"));
+    buffer.append("ghij", 4);
+    QCOMPARE(buffer.startOffset(), quint64(2));
+    QCOMPARE(buffer.endOffset(), quint64(10));
+    QCOMPARE(buffer.readFrom(2), QByteArray("cdefghij"));
+    QCOMPARE(buffer.readFrom(7), QByteArray("hij"));
+    QCOMPARE(buffer.readFrom(10), QByteArray());
+    QCOMPARE(buffer.readFrom(100), QByteArray());
+
+    // 早于 startOffset() 的偏移已被覆盖，从 startOffset() 开始
+    QCOMPARE(buffer.readFrom(0), QByteArray("cdefghij"));
+
+    // 单次写入超过容量：只保留最后 capacity 个字节，偏移仍按总字节数累计
+    buffer.append("0123456789ABC", 13);
+    QCOMPARE(buffer.endOffset(), quint64(23));
+    QCOMPARE(buffer.startOffset(), quint64(15));
+    QCOMPARE(buffer.readFrom(0), QByteArray("56789ABC"));
+    buffer.append("xy", 2);
+    QCOMPARE(buffer.readFrom(20), QByteArray("ABCxy"));
+
+    // 容量为 0：不保存输出，只记录偏移
+    ScrollbackBuffer empty(0);
+    empty.append("abc", 3);
+    QCOMPARE(empty.capacity(), 0);
+    QCOMPARE(empty.startOffset(), quint64(3));
+    QCOMPARE(empty.endOffset(), quint64(3));
+    QCOMPARE(empty.readFrom(0), QByteArray());
+}
+
+// 旧的请求处理路径（增量解析器之前）：每次 readyRead 把数据追加到缓存，再对整个缓存跑正则判断请求是否完整
+// 返回 true 表示请求完整，可以处理
+static bool legacyRegexFeed(QByteArray &requestData, const QByteArray &data)
+{
+    requestData += data;
+    QRegularExpression postUploadRe("^POST /upload HTTP/[0-9.]+");
+    if (postUploadRe.match(requestData).hasMatch())
+    {
+        QRegularExpression      contentLengthRe(R"(Content-Length:\s*(\d+))",
+                                                QRegularExpression::CaseInsensitiveOption);
+        QRegularExpressionMatch clMatch = contentLengthRe.match(requestData);
+        if (clMatch.hasMatch())
+        {
+            qint64 expectedLength = clMatch.captured(1).toLongLong();
+            int    headerEndPos   = requestData.indexOf("\r\n\r\n");
+            if (headerEndPos == -1)
+            {
+                return false;
+            }
+            qint64 receivedBodyLength = requestData.size() - (headerEndPos + 4);
+            if (receivedBodyLength >= expectedLength)
+            {
+                return true;
+            }
+        }
+        QRegularExpression      boundaryRe(R"(Content-Type:\s*multipart/form-data;\s*boundary=([^\r\n;]+))",
+                                           QRegularExpression::CaseInsensitiveOption);
+        QRegularExpressionMatch boundaryMatch = boundaryRe.match(requestData);
+        if (boundaryMatch.hasMatch())
+        {
+            QByteArray endMarker = QString("--%1--").arg(boundaryMatch.captured(1)).toUtf8();
+            return requestData.contains(endMarker);
+        }
+        return false;
+    }
+
+    QRegularExpression      re("^GET (/[^ ]*) HTTP/[0-9.]+");
+    QRegularExpressionMatch match = re.match(requestData);
+    bool preview = requestData.contains("X-File-Action: preview") || requestData.contains("x-file-action: preview");
+    Q_UNUSED(preview);
+    return match.hasMatch();
+}
+
+void UintTest::bench_httpParser_data()
+{
+    QTest::addColumn<qint64>("uploadSize");  // 上传请求体的 Content-Length，0 表示 GET 请求
+    QTest::addColumn<bool>("useParser");
+    QTest::newRow("GET 1KB / regex") << qint64(0) << false;
+    QTest::newRow("GET 1KB / parser") << qint64(0) << true;
+    QTest::newRow("upload 8MB / regex") << qint64(8 * 1024 * 1024) << false;
+    QTest::newRow("upload 8MB / parser") << qint64(8 * 1024 * 1024) << true;
+    // 旧路径每次 readyRead 都在整个缓存里查找结束标记，200MB 时耗时按平方增长，这一行会运行较长时间
+    QTest::newRow("upload 200MB / regex") << qint64(200 * 1024 * 1024) << false;
+    QTest::newRow("upload 200MB / parser") << qint64(200 * 1024 * 1024) << true;
+}
+
+void UintTest::bench_httpParser()
+{
+    QFETCH(qint64, uploadSize);
+    QFETCH(bool, useParser);
+
+    // 按 socket 每次 readyRead 约 64KB 切分请求，文件内容的分块共享同一块数据
+    const int           readSize = 64 * 1024;
+    QVector<QByteArray> reads;
+    if (uploadSize == 0)
+    {
+        QByteArray request = "GET /home/user/docs/report.txt HTTP/1.1\r\n"
+                             "Host: 127.0.0.1:8080\r\n"
+                             "User-Agent: Mozilla/5.0 (X11; Linux x86_64) Chrome/120.0 Safari/537.36\r\n"
+                             "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+                             "Accept-Encoding: gzip, deflate, br\r\n"
+                             "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+                             "Connection: keep-alive\r\n"
+                             "X-File-Action: preview\r\n";
+        request += "Cookie: session=" + QByteArray(1024 - request.size() - 20, 'c') + "\r\n\r\n";
+        reads.append(request);
+    }
+    else
+    {
+        const QByteArray boundary = "----BenchBoundary7MA4YWxkTrZu0gW";
+        QByteArray       partHead = "--" + boundary
+                              + "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"bench.bin\"\r\n"
+                                "Content-Type: application/octet-stream\r\n\r\n";
+        QByteArray       partTail = "\r\n--" + boundary + "--\r\n";
+        // 200MB 是 MAX_REQUEST_SIZE 允许的最大请求体，文件内容占去分段头尾之外的部分
+        qint64 fileSize = uploadSize - partHead.size() - partTail.size();
+        reads.append("POST /upload HTTP/1.1\r\nHost: 127.0.0.1:8080\r\nContent-Type: multipart/form-data; boundary="
+                     + boundary + "\r\nContent-Length: " + QByteArray::number(uploadSize) + "\r\n\r\n" + partHead);
+        QByteArray fileChunk(readSize, 'x');
+        for (qint64 left = fileSize; left > 0; left -= readSize)
+        {
+            reads.append(left >= readSize ? fileChunk : fileChunk.left(static_cast<int>(left)));
+        }
+        reads.append(partTail);
+    }
+
+    QBENCHMARK
+    {
+        bool complete = false;
+        if (useParser)
+        {
+            // 与 TcpServer::processRequests 相同：请求头完成后接管请求体（上传时边收边写，这里只计数）
+            HttpParser parser;
+            qint64     received = 0;
+            for (const QByteArray &data : reads)
+            {
+                HttpParser::Result result = HttpParser::NeedMore;
+                int                offset = 0;
+                do
+                {
+                    offset += parser.feed(data, offset, result);
+                    if (result == HttpParser::HeadersComplete)
+                    {
+                        parser.setBodyHandler([&received](const char *, int size) {
+                            received += size;
+                            return true;
+                        });
+                    }
+                } while (result == HttpParser::HeadersComplete);
+                complete = (result == HttpParser::MessageComplete);
+            }
+            QCOMPARE(received, parser.contentLength() > 0 ? parser.contentLength() : qint64(0));
+        }
+        else
+        {
+            QByteArray requestData;
+            for (const QByteArray &data : reads)
+            {
+                complete = legacyRegexFeed(requestData, data);
+            }
+        }
+        QVERIFY(complete);
+    }
+}
+
+void UintTest::bench_dirListRows()
+{
+    const int     fileCount = 50000;
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    for (int i = 0; i < fileCount; ++i)
+    {
+        QFile file(tempDir.path() + QString("/file_%1.txt").arg(i, 5, 10, QChar('0')));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    // 与 generateDirListHtml 相同：排序索引（首次读取后缓存）+ 逐行输出
+    QByteArray html;
+    QBENCHMARK
+    {
+        html.clear();
+        DirIndexPtr index = loadDirIndex(tempDir.path());
+        QVERIFY(index);
+        DirListRowWriter writer(tempDir.path(), tempDir.path(), "/bench");
+        for (const DirEntry &entry : index->entries)
+        {
+            writer.append(html, entry);
+        }
+    }
+    QCOMPARE(loadDirIndex(tempDir.path())->entries.size(), fileCount);
+    QVERIFY(html.contains("file_49999.txt"));
+}
+
+// 把新连接交给 IoThreadPool 的监听服务器
+class BenchHttpServer : public QTcpServer
+{
+public:
+    explicit BenchHttpServer(IoThreadPool *pool): m_pool(pool)
+    {
+    }
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override
+    {
+        m_pool->dispatch(socketDescriptor);
+    }
+
+private:
+    IoThreadPool *m_pool;
+};
+
+void UintTest::bench_ioThreadPoolDispatch_data()
+{
+    QTest::addColumn<int>("ioThreads");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+}
+
+void UintTest::bench_ioThreadPoolDispatch()
+{
+    QFETCH(int, ioThreads);
+    // QTEST_APPLESS_MAIN 没有创建应用对象，I/O线程的事件循环需要
+    static char                      arg0[] = "tst_uinttest";
+    static char                     *argv[] = {arg0, nullptr};
+    static int                       argc   = 1;
+    QScopedPointer<QCoreApplication> app(QCoreApplication::instance() ? nullptr : new QCoreApplication(argc, argv));
+
+    const int clientCount       = 64;
+    const int requestsPerClient = 4;
+    // 桩处理函数：每个请求固定 sleep 5ms 模拟磁盘读取/编码，单线程时所有客户端串行等待
+    // 结果只反映线程数对并发慢请求的影响，不包含真实请求处理的开销
+    IoThreadPool pool(ioThreads, [](QTcpSocket *socket) {
+        QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+            QByteArray request = socket->readAll();
+            for (int i = request.count("\r\n\r\n"); i > 0; --i)
+            {
+                QThread::msleep(5);
+                socket->write("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+            }
+        });
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
+    });
+    BenchHttpServer server(&pool);
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QBENCHMARK
+    {
+        QVector<QTcpSocket *> clients;
+        int                   finished = 0;
+        QEventLoop            loop;
+        for (int i = 0; i < clientCount; ++i)
+        {
+            QTcpSocket *client    = new QTcpSocket;
+            int        *responses = new int(0);
+            QObject::connect(client, &QTcpSocket::connected, client, [client]() {
+                client->write("GET / HTTP/1.1\r\nHost: bench\r\n\r\n");
+            });
+            QObject::connect(client, &QTcpSocket::readyRead, client, [&, client, responses]() {
+                *responses += client->readAll().count("HTTP/1.1 200");
+                if (*responses >= requestsPerClient)
+                {
+                    delete responses;
+                    client->disconnect();
+                    if (++finished == clientCount)
+                    {
+                        loop.quit();
+                    }
+                    return;
+                }
+                client->write("GET / HTTP/1.1\r\nHost: bench\r\n\r\n");
+            });
+            client->connectToHost(QHostAddress::LocalHost, server.serverPort());
+            clients.append(client);
+        }
+        QTimer::singleShot(60000, &loop, &QEventLoop::quit);
+        loop.exec();
+        QCOMPARE(finished, clientCount);
+        qDeleteAll(clients);
+    }
+}
+
+void UintTest::bench_tileDiff_data()
+{
+    QTest::addColumn<QString>("change");
+    QTest::addColumn<int>("expectedPatches");
+    QTest::newRow("4K unchanged") << "none" << 0;
+    QTest::newRow("4K cursor+clock") << "corners" << 2;
+    QTest::newRow("4K full screen") << "full" << 1;
+}
+
+void UintTest::bench_tileDiff()
+{
+    QFETCH(QString, change);
+    QFETCH(int, expectedPatches);
+
+    QImage prev(3840, 2160, QImage::Format_RGB32);
+    for (int y = 0; y < prev.height(); ++y)
+    {
+        QRgb *line = reinterpret_cast<QRgb *>(prev.scanLine(y));
+        for (int x = 0; x < prev.width(); ++x)
+        {
+            line[x] = qRgb(x & 0xff, y & 0xff, (x + y) & 0xff);
+        }
+    }
+    QImage curr = prev.copy();
+    if (change == "corners")
+    {
+        // 左上角闪烁的光标和右下角的时钟
+        QPainter painter(&curr);
+        painter.fillRect(100, 100, 2, 24, Qt::black);
+        painter.fillRect(3700, 2130, 80, 20, Qt::white);
+    }
+    else if (change == "full")
+    {
+        curr.fill(Qt::gray);
+    }
+
+    QVector<QRect> patches;
+    QBENCHMARK
+    {
+        patches = diffTiles(prev, curr, 0, 8);
+    }
+    qInfo() << "tile diff backend:" << tileDiffBackend() << "patches:" << patches;
+    QCOMPARE(patches.size(), expectedPatches);
+}
+
+// 原格式：JSON文本元信息，之后每个矩形一个二进制消息
+static QVector<QByteArray> legacyScreenFrame(const ScreenFrameInfo &info, const FramePatches &patches)
+{
+    QVector<QByteArray> messages;
+
+    QJsonArray patchArray;
+    for (const QRect &rect : patches.rects)
+    {
+        patchArray.append(QJsonArray{rect.x(), rect.y(), rect.width(), rect.height()});
+    }
+    QJsonObject stats;
+    stats["fps"]          = info.stats.fps;
+    stats["quality"]      = info.stats.quality;
+    stats["scale"]        = info.stats.scale;
+    stats["latency_ms"]   = info.stats.latencyMs;
+    stats["rtt_ms"]       = info.stats.rttMs;
+    stats["inflight"]     = info.stats.inflight;
+    stats["queued_bytes"] = static_cast<double>(info.stats.queuedBytes);
+    QJsonObject frameInfo;
+    frameInfo["type"]    = "screen_frame_meta";
+    frameInfo["seq"]     = static_cast<double>(info.seq);
+    frameInfo["width"]   = info.width;
+    frameInfo["height"]  = info.height;
+    frameInfo["patches"] = patchArray;
+    frameInfo["is_full"] = false;
+    frameInfo["stats"]   = stats;
+    messages.append(QJsonDocument(frameInfo).toJson(QJsonDocument::Compact));
+    for (const QByteArray &jpegData : patches.jpegs)
+    {
+        messages.append(jpegData);
+    }
+    return messages;
+}
+
+void UintTest::bench_screenFraming_data()
+{
+    QTest::addColumn<bool>("binaryHeader");
+    QTest::newRow("json meta + binary per patch") << false;
+    QTest::newRow("binary header, one message") << true;
+}
+
+void UintTest::bench_screenFraming()
+{
+    QFETCH(bool, binaryHeader);
+
+    // 8 个变化矩形，每个约 6KB 的JPG
+    FramePatches patches;
+    for (int i = 0; i < 8; ++i)
+    {
+        patches.rects.append(QRect(i * 256, i * 128, 256, 128));
+        patches.jpegs.append(QByteArray(6 * 1024 + i * 100, char(i)));
+        patches.totalBytes += patches.jpegs.last().size();
+    }
+    ScreenFrameInfo info;
+    info.seq               = 12345;
+    info.width             = 3840;
+    info.height            = 2160;
+    info.stats.fps         = 30;
+    info.stats.quality     = 70;
+    info.stats.scale       = 100;
+    info.stats.latencyMs   = 80;
+    info.stats.rttMs       = 60;
+    info.stats.inflight    = 2;
+    info.stats.queuedBytes = 40000;
+
+    QVector<QByteArray> messages;
+    QBENCHMARK
+    {
+        messages.clear();
+        if (binaryHeader)
+        {
+            messages.append(encodeScreenFrame(info, patches));
+        }
+        else
+        {
+            messages = legacyScreenFrame(info, patches);
+        }
+    }
+
+    // WebSocket 服务端帧头：负载小于 126 字节时 2 字节，不超过 65535 字节时 4 字节，否则 10 字节
+    qint64 wireBytes = 0;
+    for (const QByteArray &message : messages)
+    {
+        wireBytes += message.size() + (message.size() < 126 ? 2 : (message.size() <= 65535 ? 4 : 10));
+    }
+    qInfo() << "messages per frame:" << messages.size() << "bytes on wire:" << wireBytes
+            << "overhead:" << wireBytes - patches.totalBytes;
+    QCOMPARE(messages.size(), binaryHeader ? 1 : patches.rects.size() + 1);
+}
+
+void UintTest::bench_jpegEncode_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<bool>("reuseEncoder");
+    QTest::newRow("1080p QImage::save") << QSize(1920, 1080) << false;
+    QTest::newRow("1080p JpegEncoder") << QSize(1920, 1080) << true;
+    QTest::newRow("4K QImage::save") << QSize(3840, 2160) << false;
+    QTest::newRow("4K JpegEncoder") << QSize(3840, 2160) << true;
+}
+
+void UintTest::bench_jpegEncode()
+{
+    QFETCH(QSize, size);
+    QFETCH(bool, reuseEncoder);
+
+    // 渐变背景加文字，接近桌面截屏的内容
+    QImage image(size, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y)
+    {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+        {
+            line[x] = qRgb(x * 255 / image.width(), y * 255 / image.height(), 200);
+        }
+    }
+    QPainter painter(&image);
+    for (int y = 20; y < image.height(); y += 40)
+    {
+        painter.drawText(10, y, QString("desksrv screen benchmark line %1").repeated(4).arg(y));
+    }
+    painter.end();
+
+    QByteArray jpeg;
+    QBENCHMARK
+    {
+        if (reuseEncoder)
+        {
+            jpeg = JpegEncoder::forCurrentThread()->encode(image, 80);
+        }
+        else
+        {
+            jpeg.clear();
+            QBuffer buffer(&jpeg);
+            buffer.open(QIODevice::WriteOnly);
+            image.save(&buffer, "JPEG", 80);
+        }
+    }
+    qInfo() << "jpeg backend:" << (reuseEncoder ? JpegEncoder::backend() : "qimage") << "bytes:" << jpeg.size();
+    QVERIFY(jpeg.startsWith("\xFF\xD8"));
+}
+
+void UintTest::bench_screenCapture_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::newRow("1080p") << QSize(1920, 1080);
+    QTest::newRow("4K") << QSize(3840, 2160);
+}
+
+void UintTest::bench_screenCapture()
+{
+    QFETCH(QSize, size);
+
+    ScreenShooter *shooter = ScreenShooter::instance();
+    QImage         image   = shooter->captureImage();
+    if (image.isNull())
+    {
+        QSKIP("no X display, run under Xvfb");
+    }
+    if (image.size() != size)
+    {
+        QSKIP("screen size does not match this row");
+    }
+
+    QElapsedTimer timer;
+    int           frames = 0;
+    timer.start();
+    QBENCHMARK
+    {
+        image = shooter->captureImage();
+        ++frames;
+    }
+    qInfo() << "capture backend:" << (shooter->isDrmAvailable() ? "drm" : "x11 shm") << "frames:" << frames
+            << "fps:" << frames * 1000.0 / qMax<qint64>(1, timer.elapsed());
+    QCOMPARE(image.size(), size);
+}
+
 QTEST_APPLESS_MAIN(UintTest)
 
 #include "tst_uinttest.moc"
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += widgets testlib
+QT       += widgets testlib network
 
 TARGET = tst_uinttest
 CONFIG   += console
@@ -28,14 +28,34 @@ DEFINES += QT_DEPRECATED_WARNINGS
 INCLUDEPATH += $$PWD/../commontool
 
 SOURCES += \
-        tst_uinttest.cpp 
+        tst_uinttest.cpp \
+        ../Asrv/HtmlTemplate.cpp \
+        ../Asrv/DirListing.cpp \
+        ../Asrv/HttpParser.cpp \
+        ../Asrv/TerminalSession.cpp \
+        ../Asrv/IoThreadPool.cpp \
+        ../Asrv/TileDiff.cpp \
+        ../Asrv/ScreenProtocol.cpp \
+        ../Asrv/JpegEncoder.cpp
 
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
 HEADERS += \
     calc_interface.h \
     MyWidget.h \
-    ClassN.h
+    ClassN.h \
+    ../Asrv/HttpParser.h \
+    ../Asrv/TerminalSession.h \
+    ../Asrv/IoThreadPool.h \
+    ../Asrv/TileDiff.h \
+    ../Asrv/ScreenProtocol.h \
+    ../Asrv/JpegEncoder.h
 
 LIBS +=-ldl
+
+packagesExist(libturbojpeg) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libturbojpeg
+    DEFINES += HAVE_TURBOJPEG
+}
 LIBS +=-L$$PWD/../commontool -lcommontool
@@ -14,30 +14,11 @@ template<typename T, std::size_t Size = 1024>
 class CLockFreeQueue
 {
 private:
-    // 计算大于等于N的最小2的幂，并检查溢出
-    static constexpr const std::size_t getPowerOf2(std::size_t n)
+    // 计算大于等于N的最小2的幂，溢出时返回0（触发下面的断言）
+    // 写成单条 return 的递归形式，C++11 的 constexpr 函数只允许一条 return 语句
+    static constexpr const std::size_t getPowerOf2(std::size_t n, std::size_t result = 1)
     {
-       // 基础检查：如果n已经超过最大值，直接触发编译错误
-       if (n > MAX_UINT64 && n == 0)
-       {
-           return 0; // 会导致后续断言失败
-       }
-       if ((n & (n - 1)) == 0)
-       {
-           return n; // 已为2的幂
-       }
-       std::size_t result = 1;
-       // 循环计算下一个2的幂，同时检查溢出
-       while (result < n)
-       {
-           // 检查是否即将溢出（下一次左移会超过最大值）
-           if (result > MAX_UINT64 / 2)
-           {
-               return 0; // 溢出，返回0触发断言
-           }
-           result <<= 1;
-       }
-       return result;
+        return result >= n ? result : (result > MAX_UINT64 / 2 ? 0 : getPowerOf2(n, result << 1));
     }
     // 64位无符号数的最大值
     static constexpr std::uint64_t MAX_UINT64 = std::numeric_limits<std::uint64_t>::max();